@@ -0,0 +1,143 @@
+#include "VKBufferAllocator.h"
+#include <algorithm>
+#include <cstring>
+
+VKBufferAllocator::VKBufferAllocator(const std::shared_ptr<VKDevice> &device, VkBufferUsageFlags usage,
+									 VkDeviceSize blockSize, VkMemoryPropertyFlags properties)
+	: device(device), usage(usage), properties(properties), blockSize(blockSize), currentBlock(0) {
+
+	const VkPhysicalDeviceLimits &limits = device->getPhysicalDevice(0)->getDeviceLimits();
+	this->alignment = computeAlignment(limits, usage, properties);
+	this->nonCoherentAtomSize =
+		(properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) ? 0 : std::max<VkDeviceSize>(1, limits.nonCoherentAtomSize);
+
+	/*	Largest range that can be bound by a single descriptor.	*/
+	this->maxRange = VK_WHOLE_SIZE;
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+		this->maxRange = std::min<VkDeviceSize>(this->maxRange, limits.maxUniformBufferRange);
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		this->maxRange = std::min<VkDeviceSize>(this->maxRange, limits.maxStorageBufferRange);
+}
+
+VKBufferAllocator::~VKBufferAllocator() {
+	for (Block &block : this->blocks) {
+		if (block.mapped)
+			vkUnmapMemory(this->device->getHandle(), block.memory);
+		VKHelper::destroyBuffer(this->device->getHandle(), block.buffer, block.memory);
+	}
+}
+
+VkDeviceSize VKBufferAllocator::computeAlignment(const VkPhysicalDeviceLimits &limits, VkBufferUsageFlags usage,
+												 VkMemoryPropertyFlags properties) noexcept {
+	/*	All the limits are powers of two, thus the largest satisfies all of them.	*/
+	VkDeviceSize alignment = 1;
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+		alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+		alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+	if (usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+		alignment = std::max(alignment, limits.minTexelBufferOffsetAlignment);
+	/*	Allows flushing a slice without touching its neighbours.	*/
+	if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		alignment = std::max(alignment, limits.nonCoherentAtomSize);
+	return alignment;
+}
+
+VKBufferAllocator::Block &VKBufferAllocator::createBlock(VkDeviceSize size) {
+	Block block = {};
+	block.size = size;
+	VKHelper::createBuffer(this->device->getHandle(), size, this->device->getPhysicalDevice(0)->getMemoryProperties(),
+						   this->usage, this->properties, block.buffer, block.memory);
+
+	if (this->properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		void *mapped;
+		VKS_VALIDATE(vkMapMemory(this->device->getHandle(), block.memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+		block.mapped = static_cast<uint8_t *>(mapped);
+	}
+
+	this->blocks.push_back(block);
+	return this->blocks.back();
+}
+
+VKBufferSlice VKBufferAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+	if (size == 0)
+		throw cxxexcept::RuntimeException("Can not allocate a slice of size 0");
+	if (size > this->maxRange)
+		throw cxxexcept::RuntimeException("Slice size {} exceeds the max descriptor range {}", size, this->maxRange);
+
+	/*	Alignments are powers of two, thus the largest satisfies both.	*/
+	if ((alignment & (alignment - 1)) != 0)
+		throw cxxexcept::RuntimeException("Slice alignment {} is not a power of two", alignment);
+	alignment = std::max(alignment, this->alignment);
+
+	/*	Blocks are filled in order, the following blocks are empty since the last reset.	*/
+	for (; this->currentBlock < this->blocks.size(); this->currentBlock++) {
+		Block &block = this->blocks[this->currentBlock];
+		const VkDeviceSize offset = (block.offset + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= block.size) {
+			block.offset = offset + size;
+			return {block.buffer, offset, size, block.mapped ? block.mapped + offset : nullptr};
+		}
+	}
+
+	/*	Oversized allocations get a block of their own.	*/
+	Block &block = this->createBlock(std::max(size, this->blockSize));
+	block.offset = size;
+	return {block.buffer, 0, size, block.mapped};
+}
+
+VKBufferSlice VKBufferAllocator::upload(const void *data, VkDeviceSize size) {
+	if (!(this->properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+		throw cxxexcept::RuntimeException("Upload requires host visible memory");
+
+	VKBufferSlice slice = this->allocate(size);
+	std::memcpy(slice.mapped, data, size);
+	this->flush(slice);
+	return slice;
+}
+
+void VKBufferAllocator::flush(const VKBufferSlice &slice) {
+	if (this->nonCoherentAtomSize == 0)
+		return;
+
+	auto it = std::find_if(this->blocks.begin(), this->blocks.end(),
+						   [&slice](const Block &block) { return block.buffer == slice.buffer; });
+	if (it == this->blocks.end() || it->mapped == nullptr)
+		throw cxxexcept::RuntimeException("Slice was not allocated from host visible memory of the allocator");
+
+	/*	The range has to be rounded out to the atom size, or reach the end of the memory.	*/
+	const VkDeviceSize atomSize = this->nonCoherentAtomSize;
+	VkMappedMemoryRange range = {};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = it->memory;
+	range.offset = slice.offset / atomSize * atomSize;
+	const VkDeviceSize end = (slice.offset + slice.size + atomSize - 1) / atomSize * atomSize;
+	range.size = end < it->size ? end - range.offset : VK_WHOLE_SIZE;
+	VKS_VALIDATE(this->device->getDispatch().vkFlushMappedMemoryRanges(this->device->getHandle(), 1, &range));
+}
+
+void VKBufferAllocator::reset() noexcept {
+	for (Block &block : this->blocks)
+		block.offset = 0;
+	this->currentBlock = 0;
+}
+
+VkDeviceSize VKBufferAllocator::getAllocatedSize() const noexcept {
+	VkDeviceSize size = 0;
+	for (const Block &block : this->blocks)
+		size += block.size;
+	return size;
+}
+
+VKBufferRing::VKBufferRing(const std::shared_ptr<VKDevice> &device, VkBufferUsageFlags usage,
+						   unsigned int nrFramesInFlight, VkDeviceSize blockSize, VkMemoryPropertyFlags properties)
+	: frameIndex(0) {
+	this->frames.resize(std::max(1u, nrFramesInFlight));
+	for (auto &frame : this->frames)
+		frame = std::make_unique<VKBufferAllocator>(device, usage, blockSize, properties);
+}
+
+void VKBufferRing::nextFrame() noexcept {
+	this->frameIndex = (this->frameIndex + 1) % this->frames.size();
+	this->frames[this->frameIndex]->reset();
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_BUFFER_ALLOCATOR_H_
+#define _FVK_VK_BUFFER_ALLOCATOR_H_ 1
+#include "VKDevice.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Range of a buffer handed out by a sub-allocator.
+ */
+struct VKBufferSlice {
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	/*	Host pointer to the start of the slice, null if not host visible.	*/
+	void *mapped;
+
+	/**
+	 * @brief Descriptor info for a static descriptor of the slice.
+	 */
+	VkDescriptorBufferInfo getDescriptorInfo() const noexcept { return {buffer, offset, size}; }
+
+	/**
+	 * @brief Offset to pass to vkCmdBindDescriptorSets, for a dynamic descriptor written with
+	 * offset 0 and the buffer of the slice.
+	 */
+	uint32_t getDynamicOffset() const noexcept { return static_cast<uint32_t>(offset); }
+};
+
+/**
+ * @brief Linear sub-allocator of small buffers on top of a few large VkBuffers.
+ * Slices are aligned to the device min offset alignment of the buffer usage, thus can be used
+ * with dynamic uniform and storage descriptors. Memory is only released by reset, which keeps the
+ * blocks, so steady-state allocation does not create any Vulkan objects.
+ *
+ * Not thread safe.
+ */
+class FVK_DECL_EXTERN VKBufferAllocator {
+  public:
+	/**
+	 * @brief Construct a new VKBufferAllocator object
+	 *
+	 * @param device
+	 * @param usage
+	 * @param blockSize size of each VkBuffer.
+	 * @param properties host visible memory is persistently mapped.
+	 */
+	VKBufferAllocator(const std::shared_ptr<VKDevice> &device, VkBufferUsageFlags usage,
+					  VkDeviceSize blockSize = 4 * 1024 * 1024,
+					  VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+														 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	VKBufferAllocator(const VKBufferAllocator &) = delete;
+	VKBufferAllocator(VKBufferAllocator &&) = delete;
+	~VKBufferAllocator();
+
+	/**
+	 * @brief Allocate a slice, aligned to at least getAlignment.
+	 *
+	 * @param size
+	 * @param alignment additional alignment requirement, a power of two or 0 for none.
+	 * @return VKBufferSlice
+	 */
+	VKBufferSlice allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+	/**
+	 * @brief Make host writes to the slice visible to the device. Only required for memory that
+	 * is not host coherent, otherwise does nothing.
+	 *
+	 * @param slice allocated from this allocator since the last reset.
+	 */
+	void flush(const VKBufferSlice &slice);
+
+	/**
+	 * @brief Allocate a slice and copy the data into it, requires host visible memory.
+	 * The slice is flushed if the memory is not host coherent.
+	 *
+	 * @param data
+	 * @param size
+	 * @return VKBufferSlice
+	 */
+	VKBufferSlice upload(const void *data, VkDeviceSize size);
+
+	template <typename T> VKBufferSlice upload(const T &value) { return this->upload(&value, sizeof(T)); }
+
+	/**
+	 * @brief Release all slices, the blocks are kept for reuse.
+	 */
+	void reset() noexcept;
+
+	/**
+	 * @brief Get the slice alignment derived from the device limits of the buffer usage.
+	 *
+	 * @return VkDeviceSize
+	 */
+	VkDeviceSize getAlignment() const noexcept { return this->alignment; }
+	VkDeviceSize getBlockSize() const noexcept { return this->blockSize; }
+	size_t getNrBlocks() const noexcept { return this->blocks.size(); }
+	VkDeviceSize getAllocatedSize() const noexcept;
+
+	/**
+	 * @brief Compute the offset alignment required for the usage.
+	 *
+	 * @param limits
+	 * @param usage
+	 * @param properties
+	 * @return VkDeviceSize
+	 */
+	static VkDeviceSize computeAlignment(const VkPhysicalDeviceLimits &limits, VkBufferUsageFlags usage,
+										 VkMemoryPropertyFlags properties) noexcept;
+
+  private:
+	struct Block {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		VkDeviceSize offset;
+		uint8_t *mapped;
+	};
+
+	Block &createBlock(VkDeviceSize size);
+
+	std::shared_ptr<VKDevice> device;
+	VkBufferUsageFlags usage;
+	VkMemoryPropertyFlags properties;
+	VkDeviceSize blockSize;
+	VkDeviceSize alignment;
+	VkDeviceSize maxRange;
+	/*	Flush granularity, 0 if the memory is host coherent.	*/
+	VkDeviceSize nonCoherentAtomSize;
+	std::vector<Block> blocks;
+	size_t currentBlock;
+};
+
+/**
+ * @brief Per frame ring of linear sub-allocators, for transient data such as per draw constants.
+ * Advancing the frame resets the allocator used nrFramesInFlight frames ago, which must no
+ * longer be in use by the device.
+ */
+class FVK_DECL_EXTERN VKBufferRing {
+  public:
+	VKBufferRing(const std::shared_ptr<VKDevice> &device, VkBufferUsageFlags usage, unsigned int nrFramesInFlight = 2,
+				 VkDeviceSize blockSize = 4 * 1024 * 1024,
+				 VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+													VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	VKBufferRing(const VKBufferRing &) = delete;
+	VKBufferRing(VKBufferRing &&) = delete;
+
+	/**
+	 * @brief Advance to the next frame and reset its allocator.
+	 */
+	void nextFrame() noexcept;
+
+	VKBufferSlice allocate(VkDeviceSize size, VkDeviceSize alignment = 0) {
+		return this->frames[this->frameIndex]->allocate(size, alignment);
+	}
+	VKBufferSlice upload(const void *data, VkDeviceSize size) {
+		return this->frames[this->frameIndex]->upload(data, size);
+	}
+	template <typename T> VKBufferSlice upload(const T &value) { return this->upload(&value, sizeof(T)); }
+
+	VKBufferAllocator &getCurrent() noexcept { return *this->frames[this->frameIndex]; }
+	unsigned int getFrameIndex() const noexcept { return this->frameIndex; }
+
+  private:
+	std::vector<std::unique_ptr<VKBufferAllocator>> frames;
+	unsigned int frameIndex;
+};
+
+#endif
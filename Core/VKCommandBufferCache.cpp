@@ -0,0 +1,108 @@
+#include "VKCommandBufferCache.h"
+#include <algorithm>
+
+VKCommandBufferCache::VKCommandBufferCache(const std::shared_ptr<VKDevice> &device, uint32_t queueFamilyIndex,
+										   unsigned int nrFramesInFlight)
+	: device(device), nrFramesInFlight(nrFramesInFlight), frameCounter(0), nrHits(0), nrMisses(0) {
+	this->commandPool = device->createCommandPool(queueFamilyIndex, 0);
+}
+
+VKCommandBufferCache::~VKCommandBufferCache() {
+	/*	Destroying the pool frees all the command buffers.	*/
+	vkDestroyCommandPool(this->device->getHandle(), this->commandPool, nullptr);
+}
+
+VkCommandBuffer VKCommandBufferCache::getCommandBuffer(uint64_t key, const RecordCallback &record,
+													   const std::vector<uint64_t> &dependencies) {
+	auto it = this->entries.find(key);
+	if (it != this->entries.end()) {
+		this->nrHits++;
+		return it->second.cmd;
+	}
+	this->nrMisses++;
+
+	FVK_EXTERNAL_SYNC_SCOPE(this->commandPool);
+	VkCommandBuffer cmd = this->device->allocateCommandBuffer(this->commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+	try {
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+		VKS_VALIDATE(vkBeginCommandBuffer(cmd, &beginInfo));
+
+		record(cmd);
+
+		VKS_VALIDATE(vkEndCommandBuffer(cmd));
+	} catch (...) {
+		vkFreeCommandBuffers(this->device->getHandle(), this->commandPool, 1, &cmd);
+		throw;
+	}
+
+	Entry &entry = this->entries[key];
+	entry.cmd = cmd;
+	entry.dependencies = dependencies;
+	for (uint64_t resourceKey : dependencies)
+		this->dependents.emplace(resourceKey, key);
+
+	return cmd;
+}
+
+void VKCommandBufferCache::invalidate(uint64_t key) {
+	auto it = this->entries.find(key);
+	if (it != this->entries.end())
+		this->retire(it);
+}
+
+void VKCommandBufferCache::invalidateResource(uint64_t resourceKey) {
+	auto range = this->dependents.equal_range(resourceKey);
+	std::vector<uint64_t> keys;
+	for (auto it = range.first; it != range.second; it++)
+		keys.push_back(it->second);
+
+	for (uint64_t key : keys)
+		this->invalidate(key);
+}
+
+void VKCommandBufferCache::clear() {
+	while (!this->entries.empty())
+		this->retire(this->entries.begin());
+}
+
+void VKCommandBufferCache::retire(std::unordered_map<uint64_t, Entry>::iterator it) {
+	const uint64_t key = it->first;
+
+	/*	Remove the reverse mapping of each dependency.	*/
+	for (uint64_t resourceKey : it->second.dependencies) {
+		auto range = this->dependents.equal_range(resourceKey);
+		for (auto dep = range.first; dep != range.second; dep++) {
+			if (dep->second == key) {
+				this->dependents.erase(dep);
+				break;
+			}
+		}
+	}
+
+	this->retired.push_back({it->second.cmd, this->frameCounter});
+	this->entries.erase(it);
+}
+
+void VKCommandBufferCache::nextFrame() {
+	this->frameCounter++;
+
+	auto end = std::partition(this->retired.begin(), this->retired.end(), [this](const Retired &retired) {
+		return this->frameCounter < retired.retireFrame + this->nrFramesInFlight;
+	});
+	for (auto it = end; it != this->retired.end(); it++)
+		vkFreeCommandBuffers(this->device->getHandle(), this->commandPool, 1, &it->cmd);
+	this->retired.erase(end, this->retired.end());
+}
+
+uint64_t VKCommandBufferCache::hashBytes(const void *data, size_t size, uint64_t seed) noexcept {
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	uint64_t value = seed;
+	for (size_t i = 0; i < size; i++) {
+		value ^= bytes[i];
+		value *= 0x100000001b3ull;
+	}
+	return value;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_COMMAND_BUFFER_CACHE_H_
+#define _FVK_VK_COMMAND_BUFFER_CACHE_H_ 1
+#include "VKDevice.h"
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Cache of pre-recorded command buffers for passes that are identical between frames.
+ * Command buffers are recorded once with VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT and are
+ * re-submitted without re-recording until invalidated, either explicitly or when one of the
+ * resources the pass depends on is recreated.
+ *
+ * Invalidated command buffers may still be in flight, they are released once nrFramesInFlight
+ * calls to nextFrame have passed. Not thread safe.
+ */
+class FVK_DECL_EXTERN VKCommandBufferCache {
+  public:
+	using RecordCallback = std::function<void(VkCommandBuffer cmd)>;
+
+	/**
+	 * @brief Construct a new VKCommandBufferCache object
+	 *
+	 * @param device
+	 * @param queueFamilyIndex queue family the command buffers are submitted to.
+	 * @param nrFramesInFlight
+	 */
+	VKCommandBufferCache(const std::shared_ptr<VKDevice> &device, uint32_t queueFamilyIndex,
+						 unsigned int nrFramesInFlight = 2);
+	VKCommandBufferCache(const VKCommandBufferCache &) = delete;
+	VKCommandBufferCache(VKCommandBufferCache &&) = delete;
+	~VKCommandBufferCache();
+
+	/**
+	 * @brief Get the command buffer for the pass, recorded on the first request.
+	 *
+	 * @param key hash of the pass description, see hash.
+	 * @param record callback recording the pass, only invoked on a cache miss.
+	 * @param dependencies keys of the resources bound by the pass, see getObjectKey.
+	 * @return VkCommandBuffer executable command buffer.
+	 */
+	VkCommandBuffer getCommandBuffer(uint64_t key, const RecordCallback &record,
+									 const std::vector<uint64_t> &dependencies = {});
+
+	/**
+	 * @brief Invalidate the command buffer of the pass, if cached.
+	 *
+	 * @param key
+	 */
+	void invalidate(uint64_t key);
+
+	/**
+	 * @brief Invalidate all passes depending on the resource, must be called when the resource is
+	 * destroyed or recreated.
+	 *
+	 * @param resourceKey
+	 */
+	void invalidateResource(uint64_t resourceKey);
+
+	template <typename T> void invalidateResource(T handle) { this->invalidateResource(getObjectKey(handle)); }
+
+	/**
+	 * @brief Invalidate all passes.
+	 */
+	void clear();
+
+	/**
+	 * @brief Advance the frame, releasing the command buffers invalidated nrFramesInFlight frames ago.
+	 */
+	void nextFrame();
+
+	/**
+	 * @brief Key of a Vulkan handle, for both dispatchable and non-dispatchable handles.
+	 */
+	template <typename T> static uint64_t getObjectKey(T handle) noexcept {
+		if constexpr (std::is_pointer<T>::value)
+			return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+		else
+			return static_cast<uint64_t>(handle);
+	}
+
+	/**
+	 * @brief FNV-1a hash of the bytes, chained through seed for combining multiple fields.
+	 */
+	static uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ull) noexcept;
+
+	/**
+	 * @brief FNV-1a hash of the value representation, pointers are rejected since only the
+	 * address would be hashed, use hashBytes for the pointed to data. Types with padding are
+	 * rejected as well, equal values could differ in their padding bytes; use hashMembers.
+	 */
+	template <typename T> static uint64_t hash(const T &value, uint64_t seed = 0xcbf29ce484222325ull) noexcept {
+		static_assert(std::is_trivially_copyable<T>::value, "Requires a trivially copyable type");
+		static_assert(!std::is_pointer<T>::value, "Hashes the address, use hashBytes for the pointed to data");
+		constexpr bool isFloat = std::is_same<T, float>::value || std::is_same<T, double>::value;
+		static_assert(std::has_unique_object_representations<T>::value || isFloat,
+					  "Equal values may differ in padding bytes, use hashMembers");
+		if constexpr (isFloat) {
+			/*	-0 and +0 compare equal.	*/
+			const T normalized = value == T(0) ? T(0) : value;
+			return hashBytes(&normalized, sizeof(T), seed);
+		} else {
+			return hashBytes(&value, sizeof(T), seed);
+		}
+	}
+
+	/**
+	 * @brief Hash of the values chained in order, for keys whose members are hashed one by one.
+	 */
+	template <typename... Ts> static uint64_t hashMembers(const Ts &...values) noexcept {
+		uint64_t seed = 0xcbf29ce484222325ull;
+		((seed = hash(values, seed)), ...);
+		return seed;
+	}
+
+	size_t getNrCached() const noexcept { return this->entries.size(); }
+	uint64_t getNrHits() const noexcept { return this->nrHits; }
+	uint64_t getNrMisses() const noexcept { return this->nrMisses; }
+
+  private:
+	struct Entry {
+		VkCommandBuffer cmd;
+		std::vector<uint64_t> dependencies;
+	};
+	struct Retired {
+		VkCommandBuffer cmd;
+		uint64_t retireFrame;
+	};
+
+	void retire(std::unordered_map<uint64_t, Entry>::iterator it);
+
+	std::shared_ptr<VKDevice> device;
+	VkCommandPool commandPool;
+	unsigned int nrFramesInFlight;
+	std::unordered_map<uint64_t, Entry> entries;
+	/*	Resource key to the keys of the passes depending on it.	*/
+	std::unordered_multimap<uint64_t, uint64_t> dependents;
+	std::vector<Retired> retired;
+	uint64_t frameCounter;
+	uint64_t nrHits;
+	uint64_t nrMisses;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "VKCompletionQueue.h"
+
+VKCompletionQueue::VKCompletionQueue(const std::shared_ptr<VKDevice> &device,
+									 const std::shared_ptr<VKThreadPool> &threadPool, uint64_t pollInterval)
+	: device(device), threadPool(threadPool), pollInterval(pollInterval),
+	  timelineWaits(device->getSyncPool().getNrTimelines()), nrTimelineWaits(0), quit(false) {
+	if (!this->threadPool)
+		this->threadPool = std::make_shared<VKThreadPool>(1);
+	this->waiter = std::thread(&VKCompletionQueue::run, this);
+}
+
+VKCompletionQueue::~VKCompletionQueue() {
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->quit = true;
+	}
+	this->condition.notify_all();
+	this->waiter.join();
+	/*	Continuations still referencing the pool have to finish.	*/
+	this->threadPool->wait();
+}
+
+void VKCompletionQueue::onFence(VkFence fence, Callback callback, bool recycle) {
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->fences.push_back({fence, std::move(callback), recycle});
+	}
+	this->condition.notify_one();
+}
+
+void VKCompletionQueue::onTimeline(const VKSyncPool::TimelinePoint &point, Callback callback) {
+	if (!this->device->getSyncPool().isTimelineSupported())
+		throw cxxexcept::RuntimeException("Timeline semaphore not supported");
+	if (point.timeline >= this->timelineWaits.size())
+		throw cxxexcept::RuntimeException("Timeline {} out of range", point.timeline);
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->timelineWaits[point.timeline].emplace(point.value, std::move(callback));
+		this->nrTimelineWaits++;
+	}
+	this->condition.notify_one();
+}
+
+VKCompletionQueue::Callback VKCompletionQueue::createPromiseCallback(const std::shared_ptr<std::promise<void>> &promise) {
+	return [promise](VkResult result) {
+		if (result == VK_SUCCESS)
+			promise->set_value();
+		else
+			promise->set_exception(std::make_exception_ptr(
+				cxxexcept::RuntimeException("Failed waiting for completion: {}", getVKResultSymbol(result))));
+	};
+}
+
+std::future<void> VKCompletionQueue::whenFence(VkFence fence, bool recycle) {
+	std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+	std::future<void> future = promise->get_future();
+	this->onFence(fence, createPromiseCallback(promise), recycle);
+	return future;
+}
+
+std::future<void> VKCompletionQueue::whenTimeline(const VKSyncPool::TimelinePoint &point) {
+	std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+	std::future<void> future = promise->get_future();
+	this->onTimeline(point, createPromiseCallback(promise));
+	return future;
+}
+
+void VKCompletionQueue::submit(VkQueue queue, VKArrayView<VkCommandBuffer> cmds, Callback callback) {
+	VKSyncPool &syncPool = this->device->getSyncPool();
+	if (syncPool.isTimelineSupported()) {
+		const VKSyncPool::TimelinePoint point = syncPool.submitTimeline(queue, cmds);
+		this->onTimeline(point, std::move(callback));
+	} else {
+		VkFence fence = syncPool.acquireFence();
+		try {
+			this->device->submitCommands(queue, cmds, {}, {}, fence);
+		} catch (...) {
+			syncPool.releaseFence(fence);
+			throw;
+		}
+		this->onFence(fence, std::move(callback), true);
+	}
+}
+
+std::future<void> VKCompletionQueue::submit(VkQueue queue, VKArrayView<VkCommandBuffer> cmds) {
+	std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+	std::future<void> future = promise->get_future();
+	this->submit(queue, cmds, createPromiseCallback(promise));
+	return future;
+}
+
+size_t VKCompletionQueue::getNrPending() const {
+	std::unique_lock<std::mutex> guard(this->lock);
+	return this->fences.size() + this->nrTimelineWaits;
+}
+
+void VKCompletionQueue::dispatch(Callback &&callback, VkResult result) {
+	this->threadPool->submit([callback = std::move(callback), result](unsigned int) { callback(result); });
+}
+
+void VKCompletionQueue::run() {
+	VkDevice handle = this->device->getHandle();
+	VKSyncPool &syncPool = this->device->getSyncPool();
+	std::vector<VkFence> waitFences;
+	std::vector<VKSyncPool::TimelinePoint> waitPoints;
+	std::vector<uint64_t> completedValues(this->timelineWaits.size());
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->condition.wait(guard, [this] {
+				return this->quit || !this->fences.empty() || this->nrTimelineWaits > 0;
+			});
+			/*	Drain all outstanding work before exiting.	*/
+			if (this->fences.empty() && this->nrTimelineWaits == 0)
+				return;
+
+			waitFences.clear();
+			for (const FenceWait &wait : this->fences)
+				waitFences.push_back(wait.fence);
+			waitPoints.clear();
+			for (uint32_t i = 0; i < this->timelineWaits.size(); i++) {
+				if (!this->timelineWaits[i].empty())
+					waitPoints.push_back({i, this->timelineWaits[i].begin()->first});
+			}
+		}
+
+		/*	Block on any of the fences, or on the earliest value of any timeline.	*/
+		VkResult waitResult = VK_SUCCESS;
+		if (!waitFences.empty()) {
+			waitResult = vkWaitForFences(handle, waitFences.size(), waitFences.data(), VK_FALSE, this->pollInterval);
+		} else {
+			try {
+				syncPool.waitTimeline(waitPoints, false, this->pollInterval);
+			} catch (...) {
+				waitResult = VK_ERROR_DEVICE_LOST;
+			}
+		}
+
+		VkResult timelineResult = waitResult == VK_TIMEOUT ? VK_SUCCESS : waitResult;
+		if (timelineResult == VK_SUCCESS) {
+			try {
+				for (const VKSyncPool::TimelinePoint &point : waitPoints)
+					completedValues[point.timeline] = syncPool.getCompletedTimelineValue(point.timeline);
+			} catch (...) {
+				timelineResult = VK_ERROR_DEVICE_LOST;
+			}
+		}
+
+		std::vector<FenceWait> completedFences;
+		std::vector<VkResult> fenceResults;
+		std::vector<Callback> completedTimeline;
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+
+			for (size_t i = 0; i < this->fences.size();) {
+				const VkResult status = vkGetFenceStatus(handle, this->fences[i].fence);
+				if (status == VK_NOT_READY) {
+					i++;
+					continue;
+				}
+				completedFences.push_back(std::move(this->fences[i]));
+				fenceResults.push_back(status);
+				this->fences[i] = std::move(this->fences.back());
+				this->fences.pop_back();
+			}
+
+			/*	On error all timeline waits are failed, since the timelines will not advance.	*/
+			for (const VKSyncPool::TimelinePoint &point : waitPoints) {
+				std::multimap<uint64_t, Callback> &waits = this->timelineWaits[point.timeline];
+				auto end = timelineResult == VK_SUCCESS ? waits.upper_bound(completedValues[point.timeline])
+														: waits.end();
+				for (auto it = waits.begin(); it != end; it++)
+					completedTimeline.push_back(std::move(it->second));
+				this->nrTimelineWaits -= std::distance(waits.begin(), end);
+				waits.erase(waits.begin(), end);
+			}
+		}
+
+		for (size_t i = 0; i < completedFences.size(); i++) {
+			FenceWait &wait = completedFences[i];
+			if (wait.recycle) {
+				VkFence fence = wait.fence;
+				Callback callback = std::move(wait.callback);
+				this->dispatch(
+					[callback = std::move(callback), fence, &syncPool](VkResult result) {
+						callback(result);
+						syncPool.releaseFence(fence);
+					},
+					fenceResults[i]);
+			} else {
+				this->dispatch(std::move(wait.callback), fenceResults[i]);
+			}
+		}
+		for (Callback &callback : completedTimeline)
+			this->dispatch(std::move(callback), timelineResult);
+	}
+}
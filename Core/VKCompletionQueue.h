@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_COMPLETION_QUEUE_H_
+#define _FVK_VK_COMPLETION_QUEUE_H_ 1
+#include "VKDevice.h"
+#include "VKThreadPool.h"
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Track completion of GPU work without blocking a thread per submission.
+ * A single waiter thread multiplexes all outstanding fences with vkWaitForFences in any mode,
+ * and the queue timelines with vkWaitSemaphores, and runs the continuations on a thread pool.
+ *
+ * The waiter wakes up at least every poll interval to pick up new registrations. Destroying
+ * the queue waits for all outstanding work to complete.
+ */
+class FVK_DECL_EXTERN VKCompletionQueue {
+  public:
+	/**
+	 * @brief Continuation, invoked with VK_SUCCESS or the error the wait failed with.
+	 * Must not throw.
+	 */
+	using Callback = std::function<void(VkResult result)>;
+
+	/**
+	 * @brief Construct a new VKCompletionQueue object
+	 *
+	 * @param device
+	 * @param threadPool pool the continuations are run on, creates a single threaded pool if null.
+	 * @param pollInterval max time in nanoseconds before new registrations are picked up.
+	 */
+	VKCompletionQueue(const std::shared_ptr<VKDevice> &device,
+					  const std::shared_ptr<VKThreadPool> &threadPool = nullptr, uint64_t pollInterval = 1000000);
+	VKCompletionQueue(const VKCompletionQueue &) = delete;
+	VKCompletionQueue(VKCompletionQueue &&) = delete;
+	~VKCompletionQueue();
+
+	/**
+	 * @brief Invoke the callback once the fence is signaled.
+	 * The fence must not be reset or destroyed before the callback.
+	 *
+	 * @param fence
+	 * @param callback
+	 * @param recycle return the fence to the device sync pool after the callback.
+	 */
+	void onFence(VkFence fence, Callback callback, bool recycle = false);
+
+	/**
+	 * @brief Invoke the callback once the queue timeline has reached the point.
+	 *
+	 * @param point returned by VKSyncPool::submitTimeline.
+	 * @param callback
+	 */
+	void onTimeline(const VKSyncPool::TimelinePoint &point, Callback callback);
+
+	std::future<void> whenFence(VkFence fence, bool recycle = false);
+	std::future<void> whenTimeline(const VKSyncPool::TimelinePoint &point);
+
+	/**
+	 * @brief Submit the command buffers and invoke the callback on completion.
+	 * Uses the queue's timeline if supported, otherwise a pooled fence.
+	 *
+	 * @param queue
+	 * @param cmds
+	 * @param callback
+	 */
+	void submit(VkQueue queue, VKArrayView<VkCommandBuffer> cmds, Callback callback);
+
+	/**
+	 * @brief Submit the command buffers, the future is ready once they have completed.
+	 * An error is reported as a cxxexcept::RuntimeException from the future.
+	 *
+	 * @param queue
+	 * @param cmds
+	 * @return std::future<void>
+	 */
+	std::future<void> submit(VkQueue queue, VKArrayView<VkCommandBuffer> cmds);
+
+	/**
+	 * @brief Get the number of outstanding fences and timeline values.
+	 */
+	size_t getNrPending() const;
+
+  private:
+	struct FenceWait {
+		VkFence fence;
+		Callback callback;
+		bool recycle;
+	};
+
+	static Callback createPromiseCallback(const std::shared_ptr<std::promise<void>> &promise);
+
+	void run();
+	void dispatch(Callback &&callback, VkResult result);
+
+	std::shared_ptr<VKDevice> device;
+	std::shared_ptr<VKThreadPool> threadPool;
+	uint64_t pollInterval;
+
+	std::vector<FenceWait> fences;
+	/*	Waits of each queue timeline, ordered by value.	*/
+	std::vector<std::multimap<uint64_t, Callback>> timelineWaits;
+	size_t nrTimelineWaits;
+	mutable std::mutex lock;
+	std::condition_variable condition;
+	bool quit;
+	std::thread waiter;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "VKComputeKernel.h"
+#include <algorithm>
+#include <cstring>
+
+VKComputeKernel::VKComputeKernel(const std::shared_ptr<VKDevice> &device, VkShaderModule shaderModule,
+								 const std::vector<VkDescriptorSetLayout> &descLayouts, uint32_t pushConstantSize,
+								 const char *entryPoint, const VkSpecializationInfo *pSpecializationInfo)
+	: device(device), pushConstantSize(pushConstantSize), ownsHandles(true) {
+
+	std::vector<VkPushConstantRange> pushConstants;
+	if (pushConstantSize > 0)
+		pushConstants.push_back({VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize});
+	VKHelper::createPipelineLayout(device->getHandle(), this->layout, descLayouts, pushConstants);
+
+	VkPipelineShaderStageCreateInfo stageInfo = {};
+	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageInfo.module = shaderModule;
+	stageInfo.pName = entryPoint;
+	stageInfo.pSpecializationInfo = pSpecializationInfo;
+
+	this->pipeline = VKHelper::createComputePipeline(device->getHandle(), this->layout, stageInfo);
+}
+
+VKComputeKernel::VKComputeKernel(const std::shared_ptr<VKDevice> &device, VkPipeline pipeline,
+								 VkPipelineLayout layout, uint32_t pushConstantSize)
+	: device(device), pipeline(pipeline), layout(layout), pushConstantSize(pushConstantSize), ownsHandles(false) {}
+
+VKComputeKernel::~VKComputeKernel() {
+	if (this->ownsHandles) {
+		VKHelper::destroyPipeline(this->device->getHandle(), this->pipeline);
+		VKHelper::destroyPipelineLayout(this->device->getHandle(), this->layout);
+	}
+}
+
+void VKComputeRecorder::reset(VkCommandBuffer cmd) {
+	this->cmd = cmd;
+	this->boundPipeline = VK_NULL_HANDLE;
+	this->boundLayout = VK_NULL_HANDLE;
+	this->boundSets.fill(VK_NULL_HANDLE);
+	this->pushConstantOffset = 0;
+	this->pushConstantSize = 0;
+	this->nrDispatches = 0;
+	this->nrSkipped = 0;
+}
+
+void VKComputeRecorder::bind(const VKComputeKernel &kernel) {
+	if (this->boundPipeline == kernel.getPipeline()) {
+		this->nrSkipped++;
+		return;
+	}
+	this->table->vkCmdBindPipeline(this->cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.getPipeline());
+	this->boundPipeline = kernel.getPipeline();
+
+	/*	Descriptor sets and push constants are only kept between compatible layouts,
+		conservatively invalidate them if the layout changes.	*/
+	if (this->boundLayout != kernel.getLayout()) {
+		this->boundLayout = kernel.getLayout();
+		this->boundSets.fill(VK_NULL_HANDLE);
+		this->pushConstantSize = 0;
+	}
+}
+
+void VKComputeRecorder::bindDescriptorSets(const VKComputeKernel &kernel, uint32_t firstSet,
+										   const VkDescriptorSet *sets, uint32_t nrSets,
+										   const uint32_t *dynamicOffsets, uint32_t nrDynamicOffsets) {
+	/*	Sets with dynamic offsets are always rebound, since the offsets are not tracked.	*/
+	if (nrDynamicOffsets == 0 && kernel.getLayout() == this->boundLayout && firstSet + nrSets <= MaxTrackedSets &&
+		std::equal(sets, sets + nrSets, this->boundSets.begin() + firstSet)) {
+		this->nrSkipped++;
+		return;
+	}
+
+	this->table->vkCmdBindDescriptorSets(this->cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.getLayout(), firstSet,
+											nrSets, sets, nrDynamicOffsets, dynamicOffsets);
+
+	for (uint32_t i = 0; i < nrSets && firstSet + i < MaxTrackedSets; i++)
+		this->boundSets[firstSet + i] = nrDynamicOffsets == 0 ? sets[i] : VK_NULL_HANDLE;
+}
+
+void VKComputeRecorder::pushConstants(const VKComputeKernel &kernel, const void *data, uint32_t size,
+									  uint32_t offset) {
+	if (kernel.getLayout() == this->boundLayout && size == this->pushConstantSize &&
+		offset == this->pushConstantOffset && std::memcmp(this->pushConstantData.data(), data, size) == 0) {
+		this->nrSkipped++;
+		return;
+	}
+
+	this->table->vkCmdPushConstants(this->cmd, kernel.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
+
+	if (size <= MaxTrackedPushConstantSize && kernel.getLayout() == this->boundLayout) {
+		std::memcpy(this->pushConstantData.data(), data, size);
+		this->pushConstantOffset = offset;
+		this->pushConstantSize = size;
+	} else {
+		this->pushConstantSize = 0;
+	}
+}
+
+void VKComputeRecorder::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	this->table->vkCmdDispatch(this->cmd, groupCountX, groupCountY, groupCountZ);
+	this->nrDispatches++;
+}
+
+void VKComputeRecorder::dispatchIndirect(VkBuffer buffer, VkDeviceSize offset) {
+	this->table->vkCmdDispatchIndirect(this->cmd, buffer, offset);
+	this->nrDispatches++;
+}
+
+void VKComputeRecorder::barrier() {
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	this->table->vkCmdPipelineBarrier(this->cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+										 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+										 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+VKComputeBatch::VKComputeBatch(const std::shared_ptr<VKDevice> &device)
+	: device(device), pending(false), recorder(VK_NULL_HANDLE, &device->getDispatch()) {
+	uint32_t queueFamilyIndex;
+	if (device->getDefaultCompute() != VK_NULL_HANDLE) {
+		this->queue = device->getDefaultCompute();
+		queueFamilyIndex = device->getDefaultComputeQueueIndex();
+	} else {
+		this->queue = device->getDefaultGraphicQueue();
+		queueFamilyIndex = device->getDefaultGraphicQueueIndex();
+	}
+
+	this->commandPool = device->createCommandPool(queueFamilyIndex);
+	this->cmd = device->allocateCommandBuffer(this->commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	VKS_VALIDATE(vkCreateFence(device->getHandle(), &fenceInfo, nullptr, &this->fence));
+}
+
+VKComputeBatch::~VKComputeBatch() {
+	this->wait();
+	vkDestroyFence(this->device->getHandle(), this->fence, nullptr);
+	vkFreeCommandBuffers(this->device->getHandle(), this->commandPool, 1, &this->cmd);
+	vkDestroyCommandPool(this->device->getHandle(), this->commandPool, nullptr);
+}
+
+VKComputeRecorder &VKComputeBatch::begin() {
+	this->wait();
+	FVK_EXTERNAL_SYNC_SCOPE(this->commandPool);
+	VKS_VALIDATE(this->device->getDispatch().vkResetCommandBuffer(this->cmd, 0));
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VKS_VALIDATE(this->device->getDispatch().vkBeginCommandBuffer(this->cmd, &beginInfo));
+
+	this->recorder.reset(this->cmd);
+	return this->recorder;
+}
+
+void VKComputeBatch::submit() {
+	FVK_EXTERNAL_SYNC_SCOPE(this->commandPool);
+	VKS_VALIDATE(this->device->getDispatch().vkEndCommandBuffer(this->cmd));
+	VKS_VALIDATE(this->device->getDispatch().vkResetFences(this->device->getHandle(), 1, &this->fence));
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &this->cmd;
+	std::unique_lock<std::mutex> guard = this->device->lockQueue(this->queue);
+	VKS_VALIDATE(this->device->getDispatch().vkQueueSubmit(this->queue, 1, &submitInfo, this->fence));
+	this->pending = true;
+}
+
+void VKComputeBatch::wait() {
+	if (this->pending) {
+		VKS_VALIDATE(
+			this->device->getDispatch().vkWaitForFences(this->device->getHandle(), 1, &this->fence, VK_TRUE, UINT64_MAX));
+		this->pending = false;
+	}
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_COMPUTE_KERNEL_H_
+#define _FVK_VK_COMPUTE_KERNEL_H_ 1
+#include "VKDevice.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Compute pipeline together with its pipeline layout.
+ */
+class FVK_DECL_EXTERN VKComputeKernel {
+  public:
+	/**
+	 * @brief Create the pipeline layout and the pipeline, owned by the kernel.
+	 *
+	 * @param device
+	 * @param shaderModule
+	 * @param descLayouts
+	 * @param pushConstantSize size in bytes of the push constant block, 0 if none.
+	 * @param entryPoint
+	 * @param pSpecializationInfo
+	 */
+	VKComputeKernel(const std::shared_ptr<VKDevice> &device, VkShaderModule shaderModule,
+					const std::vector<VkDescriptorSetLayout> &descLayouts = {}, uint32_t pushConstantSize = 0,
+					const char *entryPoint = "main", const VkSpecializationInfo *pSpecializationInfo = nullptr);
+
+	/**
+	 * @brief Wrap an existing pipeline and layout, not owned by the kernel.
+	 *
+	 * @param device
+	 * @param pipeline
+	 * @param layout
+	 * @param pushConstantSize
+	 */
+	VKComputeKernel(const std::shared_ptr<VKDevice> &device, VkPipeline pipeline, VkPipelineLayout layout,
+					uint32_t pushConstantSize = 0);
+	VKComputeKernel(const VKComputeKernel &) = delete;
+	VKComputeKernel(VKComputeKernel &&) = delete;
+	~VKComputeKernel();
+
+	VkPipeline getPipeline() const noexcept { return this->pipeline; }
+	VkPipelineLayout getLayout() const noexcept { return this->layout; }
+	uint32_t getPushConstantSize() const noexcept { return this->pushConstantSize; }
+
+  private:
+	std::shared_ptr<VKDevice> device;
+	VkPipeline pipeline;
+	VkPipelineLayout layout;
+	uint32_t pushConstantSize;
+	bool ownsHandles;
+};
+
+/**
+ * @brief Records compute dispatches into a command buffer, skipping redundant state changes.
+ * Pipeline, descriptor sets and push constants are only recorded when they differ
+ * from the state already recorded in the command buffer.
+ */
+class FVK_DECL_EXTERN VKComputeRecorder {
+  public:
+	static constexpr uint32_t MaxTrackedSets = 8;
+	static constexpr uint32_t MaxTrackedPushConstantSize = 256;
+
+	/**
+	 * @param cmd
+	 * @param table function table used for recording, the linked loader exports if nullptr.
+	 */
+	VKComputeRecorder(VkCommandBuffer cmd = VK_NULL_HANDLE, const VKDeviceDispatch *table = nullptr)
+		: table(table != nullptr ? table : &VKDeviceDispatch::getGlobal()) {
+		this->reset(cmd);
+	}
+
+	/**
+	 * @brief Forget the tracked state, must be called when the command buffer is begun again.
+	 *
+	 * @param cmd
+	 */
+	void reset(VkCommandBuffer cmd);
+
+	void bind(const VKComputeKernel &kernel);
+
+	void bindDescriptorSets(const VKComputeKernel &kernel, uint32_t firstSet, const VkDescriptorSet *sets,
+							uint32_t nrSets, const uint32_t *dynamicOffsets = nullptr, uint32_t nrDynamicOffsets = 0);
+
+	void pushConstants(const VKComputeKernel &kernel, const void *data, uint32_t size, uint32_t offset = 0);
+
+	void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+	/**
+	 * @brief Dispatch with the group count read from a VkDispatchIndirectCommand in the buffer,
+	 * e.g. written by a previous dispatch.
+	 *
+	 * @param buffer
+	 * @param offset
+	 */
+	void dispatchIndirect(VkBuffer buffer, VkDeviceSize offset = 0);
+
+	/**
+	 * @brief Shader write to shader and indirect read barrier, between dependent dispatches.
+	 */
+	void barrier();
+
+	/**
+	 * @brief Convenience for a complete dispatch.
+	 */
+	template <typename T>
+	void dispatch(const VKComputeKernel &kernel, const std::vector<VkDescriptorSet> &sets, const T &pushConstant,
+				  uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) {
+		this->bind(kernel);
+		if (!sets.empty())
+			this->bindDescriptorSets(kernel, 0, sets.data(), sets.size());
+		this->pushConstants(kernel, &pushConstant, sizeof(T));
+		this->dispatch(groupCountX, groupCountY, groupCountZ);
+	}
+
+	VkCommandBuffer getCommandBuffer() const noexcept { return this->cmd; }
+	uint32_t getNrDispatches() const noexcept { return this->nrDispatches; }
+	/*	Number of state changes that were skipped since already bound.	*/
+	uint32_t getNrSkippedStateChanges() const noexcept { return this->nrSkipped; }
+
+  private:
+	const VKDeviceDispatch *table;
+	VkCommandBuffer cmd;
+	VkPipeline boundPipeline;
+	VkPipelineLayout boundLayout;
+	std::array<VkDescriptorSet, MaxTrackedSets> boundSets;
+	std::array<uint8_t, MaxTrackedPushConstantSize> pushConstantData;
+	uint32_t pushConstantOffset;
+	uint32_t pushConstantSize;
+	uint32_t nrDispatches;
+	uint32_t nrSkipped;
+};
+
+/**
+ * @brief Command buffer and fence for recording many small dispatches in a single submission.
+ */
+class FVK_DECL_EXTERN VKComputeBatch {
+  public:
+	VKComputeBatch(const std::shared_ptr<VKDevice> &device);
+	VKComputeBatch(const VKComputeBatch &) = delete;
+	VKComputeBatch(VKComputeBatch &&) = delete;
+	~VKComputeBatch();
+
+	/**
+	 * @brief Begin recording, waits for the previous submission of the batch.
+	 *
+	 * @return VKComputeRecorder&
+	 */
+	VKComputeRecorder &begin();
+
+	/**
+	 * @brief End recording and submit on the compute queue.
+	 */
+	void submit();
+
+	/**
+	 * @brief Wait for the submission to finish.
+	 */
+	void wait();
+
+  private:
+	std::shared_ptr<VKDevice> device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkCommandBuffer cmd;
+	VkFence fence;
+	bool pending;
+	VKComputeRecorder recorder;
+};
+
+#endif
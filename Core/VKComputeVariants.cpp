@@ -0,0 +1,221 @@
+#include "VKComputeVariants.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+VKComputeVariants::VKComputeVariants(const std::shared_ptr<VKDevice> &device, VkShaderModule shaderModule,
+									 VkPipelineLayout layout, const std::vector<SpecializationConstant> &constants,
+									 const char *entryPoint, VkPipelineCache pipelineCache)
+	: device(device), shaderModule(shaderModule), layout(layout), entryPoint(entryPoint),
+	  pipelineCache(pipelineCache), constants(constants), workGroupSizeConstant(-1), commandPool(VK_NULL_HANDLE),
+	  queryPool(VK_NULL_HANDLE) {
+
+	/*	Constants are packed tightly in the declared order.	*/
+	uint32_t offset = 0;
+	this->mapEntries.resize(constants.size());
+	for (size_t i = 0; i < constants.size(); i++) {
+		this->mapEntries[i].constantID = constants[i].constantID;
+		this->mapEntries[i].offset = offset;
+		this->mapEntries[i].size = getConstantSize(constants[i].type);
+		offset += this->mapEntries[i].size;
+	}
+}
+
+VKComputeVariants::~VKComputeVariants() {
+	VkDevice handle = this->device->getHandle();
+	for (const std::pair<const std::string, VkPipeline> &pipeline : this->pipelines)
+		VKHelper::destroyPipeline(handle, pipeline.second);
+	if (this->queryPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(handle, this->queryPool, nullptr);
+	if (this->commandPool != VK_NULL_HANDLE)
+		vkDestroyCommandPool(handle, this->commandPool, nullptr);
+}
+
+size_t VKComputeVariants::getConstantSize(ConstantType type) noexcept {
+	switch (type) {
+	case ConstantType::Int64:
+	case ConstantType::UInt64:
+	case ConstantType::Float64:
+		return 8;
+	default:
+		return 4;
+	}
+}
+
+void VKComputeVariants::setWorkGroupSizeConstant(uint32_t constantID) {
+	for (size_t i = 0; i < this->constants.size(); i++) {
+		if (this->constants[i].constantID == constantID) {
+			if (this->constants[i].type != ConstantType::UInt32 && this->constants[i].type != ConstantType::Int32)
+				throw cxxexcept::RuntimeException("Workgroup size constant {} must be a 32-bit integer", constantID);
+			this->workGroupSizeConstant = static_cast<int>(i);
+			return;
+		}
+	}
+	throw cxxexcept::RuntimeException("Specialization constant {} is not declared", constantID);
+}
+
+std::string VKComputeVariants::packValues(const std::vector<SpecializationValue> &values) const {
+	if (values.size() != this->constants.size())
+		throw cxxexcept::RuntimeException("Expected {} specialization values, got {}", this->constants.size(),
+										  values.size());
+
+	/*	The packed data is also used as the cache key.	*/
+	std::string data;
+	for (size_t i = 0; i < values.size(); i++)
+		data.append(reinterpret_cast<const char *>(&values[i]), this->mapEntries[i].size);
+	return data;
+}
+
+VkPipeline VKComputeVariants::getPipeline(const std::vector<SpecializationValue> &values) {
+	return this->getPipeline(this->packValues(values));
+}
+
+VkPipeline VKComputeVariants::getPipeline(const std::string &packedValues) {
+	auto it = this->pipelines.find(packedValues);
+	if (it != this->pipelines.end())
+		return it->second;
+
+	VkSpecializationInfo specializationInfo = {};
+	specializationInfo.mapEntryCount = this->mapEntries.size();
+	specializationInfo.pMapEntries = this->mapEntries.data();
+	specializationInfo.dataSize = packedValues.size();
+	specializationInfo.pData = packedValues.data();
+
+	VkPipelineShaderStageCreateInfo stageInfo = {};
+	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageInfo.module = this->shaderModule;
+	stageInfo.pName = this->entryPoint.c_str();
+	stageInfo.pSpecializationInfo = &specializationInfo;
+
+	VkPipeline pipeline = VKHelper::createComputePipeline(this->device->getHandle(), this->layout, stageInfo,
+														  this->pipelineCache);
+	this->pipelines.emplace(packedValues, pipeline);
+	return pipeline;
+}
+
+std::vector<uint32_t> VKComputeVariants::getWorkGroupSizeCandidates() const {
+	const std::shared_ptr<PhysicalDevice> &physicalDevice = this->device->getPhysicalDevice(0);
+	const VkPhysicalDeviceLimits &limits = physicalDevice->getDeviceLimits();
+	const uint32_t maxSize = std::min(limits.maxComputeWorkGroupSize[0], limits.maxComputeWorkGroupInvocations);
+
+	uint32_t subgroupSize = 1;
+	if (physicalDevice->getProperties().apiVersion >= VK_API_VERSION_1_1)
+		subgroupSize = std::max(1u, physicalDevice->getDeviceSubGroupProperties().subgroupSize);
+
+	std::vector<uint32_t> candidates;
+	for (uint32_t size = subgroupSize; size <= maxSize && size <= 1024; size *= 2)
+		candidates.push_back(size);
+	if (candidates.empty())
+		candidates.push_back(maxSize);
+	return candidates;
+}
+
+VkPipeline VKComputeVariants::getTunedPipeline(const std::vector<SpecializationValue> &values,
+											   const DispatchCallback &dispatch, uint32_t &workGroupSizeX) {
+	if (this->workGroupSizeConstant < 0)
+		throw cxxexcept::RuntimeException("No workgroup size specialization constant declared");
+
+	if (values.size() + 1 != this->constants.size())
+		throw cxxexcept::RuntimeException("Expected {} specialization values without the workgroup size, got {}",
+										  this->constants.size() - 1, values.size());
+
+	/*	The workgroup size slot is filled per candidate, the key is the other constants only.	*/
+	std::vector<SpecializationValue> variantValues = values;
+	variantValues.insert(variantValues.begin() + this->workGroupSizeConstant, SpecializationValue(0u));
+	std::string key = this->packValues(variantValues);
+	key.erase(this->mapEntries[this->workGroupSizeConstant].offset,
+			  this->mapEntries[this->workGroupSizeConstant].size);
+
+	auto it = this->tunedWorkGroupSizes.find(key);
+	if (it != this->tunedWorkGroupSizes.end()) {
+		workGroupSizeX = it->second;
+		variantValues[this->workGroupSizeConstant] = SpecializationValue(workGroupSizeX);
+		return this->getPipeline(variantValues);
+	}
+
+	/*	Time each candidate, keep the fastest.	*/
+	double bestTime = std::numeric_limits<double>::max();
+	uint32_t bestSize = 0;
+	for (const uint32_t candidate : this->getWorkGroupSizeCandidates()) {
+		variantValues[this->workGroupSizeConstant] = SpecializationValue(candidate);
+		VkPipeline pipeline = this->getPipeline(variantValues);
+
+		const double elapsed = this->timeDispatch(pipeline, candidate, dispatch);
+		if (elapsed < bestTime) {
+			bestTime = elapsed;
+			bestSize = candidate;
+		}
+	}
+
+	this->tunedWorkGroupSizes[key] = bestSize;
+	workGroupSizeX = bestSize;
+	variantValues[this->workGroupSizeConstant] = SpecializationValue(bestSize);
+	return this->getPipeline(variantValues);
+}
+
+double VKComputeVariants::timeDispatch(VkPipeline pipeline, uint32_t workGroupSizeX,
+									   const DispatchCallback &dispatch) {
+	VkDevice handle = this->device->getHandle();
+	VkQueue queue = this->device->getDefaultCompute();
+	uint32_t queueFamilyIndex = this->device->getDefaultComputeQueueIndex();
+	if (queue == VK_NULL_HANDLE) {
+		queue = this->device->getDefaultGraphicQueue();
+		queueFamilyIndex = this->device->getDefaultGraphicQueueIndex();
+	}
+
+	const std::shared_ptr<PhysicalDevice> &physicalDevice = this->device->getPhysicalDevice(0);
+	const uint32_t timestampValidBits = physicalDevice->getQueueFamilyProperties()[queueFamilyIndex].timestampValidBits;
+	if (timestampValidBits == 0)
+		throw cxxexcept::RuntimeException("Queue does not support timestamp queries");
+
+	/*	Lazily created, only needed when tuning.	*/
+	if (this->commandPool == VK_NULL_HANDLE)
+		this->commandPool = this->device->createCommandPool(queueFamilyIndex);
+	if (this->queryPool == VK_NULL_HANDLE) {
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = 2;
+		VKS_VALIDATE(vkCreateQueryPool(handle, &queryPoolInfo, nullptr, &this->queryPool));
+	}
+
+	/*	Serialize the dispatches, they may write the same resources.	*/
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	/*	The first timestamp is written once the warm-up dispatch has completed, it is not part of the average.	*/
+	VkCommandBuffer cmd = this->device->beginSingleTimeCommand(this->commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+	vkCmdResetQueryPool(cmd, this->queryPool, 0, 2);
+	dispatch(cmd, pipeline, workGroupSizeX);
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->queryPool, 0);
+	for (uint32_t i = 0; i < NrTimedDispatches; i++) {
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+							 &memoryBarrier, 0, nullptr, 0, nullptr);
+		dispatch(cmd, pipeline, workGroupSizeX);
+	}
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->queryPool, 1);
+	VKS_VALIDATE(vkEndCommandBuffer(cmd));
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	VkFence fence;
+	VKS_VALIDATE(vkCreateFence(handle, &fenceInfo, nullptr, &fence));
+
+	this->device->submitCommands(queue, {cmd}, {}, {}, fence, {});
+	VKS_VALIDATE(vkWaitForFences(handle, 1, &fence, VK_TRUE, UINT64_MAX));
+	vkDestroyFence(handle, fence, nullptr);
+	vkFreeCommandBuffers(handle, this->commandPool, 1, &cmd);
+
+	uint64_t timestamps[2];
+	VKS_VALIDATE(vkGetQueryPoolResults(handle, this->queryPool, 0, 2, sizeof(timestamps), timestamps,
+									   sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+	/*	Only the valid bits are written, the difference is masked to handle a wrap around.	*/
+	const uint64_t timestampMask = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+	const uint64_t elapsed = (timestamps[1] - timestamps[0]) & timestampMask;
+	return static_cast<double>(elapsed) * static_cast<double>(physicalDevice->getDeviceLimits().timestampPeriod) /
+		   NrTimedDispatches;
+}
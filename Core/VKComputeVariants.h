@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_COMPUTE_VARIANTS_H_
+#define _FVK_VK_COMPUTE_VARIANTS_H_ 1
+#include "VKDevice.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Compute pipeline variants of a single SPIR-V module, built from specialization constants.
+ * Pipelines are created on demand and cached per tuple of constant values. If the
+ * workgroup size is driven by specialization constants, the size can be tuned by
+ * timing each candidate on first use.
+ */
+class FVK_DECL_EXTERN VKComputeVariants {
+  public:
+	enum class ConstantType { Bool32, Int32, UInt32, Float32, Int64, UInt64, Float64 };
+
+	struct SpecializationConstant {
+		uint32_t constantID;
+		ConstantType type;
+	};
+
+	/**
+	 * @brief Value of a specialization constant, interpreted by the constant type.
+	 */
+	struct SpecializationValue {
+		union {
+			int32_t i32;
+			uint32_t u32;
+			float f32;
+			int64_t i64;
+			uint64_t u64;
+			double f64;
+		};
+		SpecializationValue() : u64(0) {}
+		SpecializationValue(bool value) : u64(0) { u32 = value ? VK_TRUE : VK_FALSE; }
+		SpecializationValue(int32_t value) : u64(0) { i32 = value; }
+		SpecializationValue(uint32_t value) : u64(0) { u32 = value; }
+		SpecializationValue(float value) : u64(0) { f32 = value; }
+		SpecializationValue(int64_t value) : i64(value) {}
+		SpecializationValue(uint64_t value) : u64(value) {}
+		SpecializationValue(double value) : f64(value) {}
+	};
+
+	/**
+	 * @brief Records a dispatch of the pipeline, the workgroup size is the
+	 * local size in x of the variant.
+	 */
+	using DispatchCallback = std::function<void(VkCommandBuffer cmd, VkPipeline pipeline, uint32_t workGroupSizeX)>;
+
+	/**
+	 * @brief Construct a new VKComputeVariants object
+	 *
+	 * @param device
+	 * @param shaderModule
+	 * @param layout
+	 * @param constants the constants that are specialized, the values are given in the same order.
+	 * @param entryPoint
+	 * @param pipelineCache
+	 */
+	VKComputeVariants(const std::shared_ptr<VKDevice> &device, VkShaderModule shaderModule, VkPipelineLayout layout,
+					  const std::vector<SpecializationConstant> &constants, const char *entryPoint = "main",
+					  VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+	VKComputeVariants(const VKComputeVariants &) = delete;
+	VKComputeVariants(VKComputeVariants &&) = delete;
+	~VKComputeVariants();
+
+	/**
+	 * @brief Declare the constant that drives local_size_x, enables workgroup tuning.
+	 *
+	 * @param constantID
+	 */
+	void setWorkGroupSizeConstant(uint32_t constantID);
+
+	/**
+	 * @brief Get the pipeline for the constant values, created on first request.
+	 *
+	 * @param values
+	 * @return VkPipeline
+	 */
+	VkPipeline getPipeline(const std::vector<SpecializationValue> &values);
+
+	/**
+	 * @brief Get the fastest pipeline for the constant values.
+	 * On first use, each workgroup size candidate is timed with timestamp queries
+	 * on the compute queue, using the dispatch callback. A warm-up dispatch is discarded
+	 * and the time is averaged over NrTimedDispatches. The result is cached per values.
+	 *
+	 * @param values values of all constants except the workgroup size constant, in declared order.
+	 * @param dispatch
+	 * @param workGroupSizeX the selected workgroup size.
+	 * @return VkPipeline
+	 */
+	VkPipeline getTunedPipeline(const std::vector<SpecializationValue> &values, const DispatchCallback &dispatch,
+								uint32_t &workGroupSizeX);
+
+	/**
+	 * @brief Workgroup size candidates, multiples of the subgroup size up to the device limits.
+	 *
+	 * @return std::vector<uint32_t>
+	 */
+	std::vector<uint32_t> getWorkGroupSizeCandidates() const;
+
+	size_t getNrPipelines() const noexcept { return this->pipelines.size(); }
+
+	static constexpr uint32_t NrTimedDispatches = 8;
+
+  private:
+	static size_t getConstantSize(ConstantType type) noexcept;
+	std::string packValues(const std::vector<SpecializationValue> &values) const;
+	VkPipeline getPipeline(const std::string &packedValues);
+	double timeDispatch(VkPipeline pipeline, uint32_t workGroupSizeX, const DispatchCallback &dispatch);
+
+	std::shared_ptr<VKDevice> device;
+	VkShaderModule shaderModule;
+	VkPipelineLayout layout;
+	std::string entryPoint;
+	VkPipelineCache pipelineCache;
+
+	std::vector<SpecializationConstant> constants;
+	std::vector<VkSpecializationMapEntry> mapEntries;
+	int workGroupSizeConstant;
+
+	std::unordered_map<std::string, VkPipeline> pipelines;
+	std::unordered_map<std::string, uint32_t> tunedWorkGroupSizes;
+
+	VkCommandPool commandPool;
+	VkQueryPool queryPool;
+};
+
+#endif
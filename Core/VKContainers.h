@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_CONTAINERS_H_
+#define _FVK_VK_CONTAINERS_H_ 1
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Non-owning view of a contiguous array, constructible from a vector, std::array, C array,
+ * initializer list or a single element without any allocation. The viewed memory must outlive the view.
+ *
+ * @tparam T
+ */
+template <typename T> class VKArrayView {
+  public:
+	constexpr VKArrayView() noexcept : ptr(nullptr), count(0) {}
+	constexpr VKArrayView(const T *data, size_t size) noexcept : ptr(data), count(size) {}
+	constexpr VKArrayView(const T &value) noexcept : ptr(&value), count(1) {}
+/*	The view is only valid for the full expression holding the initializer list, which covers a call argument.	*/
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winit-list-lifetime"
+#endif
+	constexpr VKArrayView(std::initializer_list<T> list) noexcept : ptr(list.begin()), count(list.size()) {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+	template <size_t N> constexpr VKArrayView(const T (&array)[N]) noexcept : ptr(array), count(N) {}
+	template <size_t N> constexpr VKArrayView(const std::array<T, N> &array) noexcept : ptr(array.data()), count(N) {}
+	template <typename Allocator>
+	VKArrayView(const std::vector<T, Allocator> &vector) noexcept : ptr(vector.data()), count(vector.size()) {}
+
+	constexpr const T *data() const noexcept { return this->ptr; }
+	constexpr size_t size() const noexcept { return this->count; }
+	constexpr bool empty() const noexcept { return this->count == 0; }
+	constexpr const T *begin() const noexcept { return this->ptr; }
+	constexpr const T *end() const noexcept { return this->ptr + this->count; }
+	constexpr const T &operator[](size_t index) const noexcept { return this->ptr[index]; }
+
+  private:
+	const T *ptr;
+	size_t count;
+};
+
+/**
+ * @brief Vector with inline storage for the first N elements, only allocating beyond that.
+ * Restricted to trivially copyable types, such as Vulkan handles and structures.
+ *
+ * @tparam T
+ * @tparam N number of inline elements.
+ */
+template <typename T, size_t N> class VKSmallVector {
+	static_assert(std::is_trivially_copyable<T>::value, "VKSmallVector requires a trivially copyable type");
+
+  public:
+	VKSmallVector() noexcept : ptr(this->inlineData()), count(0), capacityCount(N) {}
+	explicit VKSmallVector(size_t size) : VKSmallVector() { this->resize(size); }
+	VKSmallVector(std::initializer_list<T> list) : VKSmallVector() {
+		this->reserve(list.size());
+		std::memcpy(this->ptr, list.begin(), list.size() * sizeof(T));
+		this->count = list.size();
+	}
+	VKSmallVector(const VKSmallVector &other) : VKSmallVector() { *this = other; }
+	VKSmallVector(VKSmallVector &&other) noexcept : VKSmallVector() { *this = std::move(other); }
+	~VKSmallVector() { this->release(); }
+
+	VKSmallVector &operator=(const VKSmallVector &other) {
+		if (this != &other) {
+			this->count = 0;
+			this->reserve(other.count);
+			std::memcpy(this->ptr, other.ptr, other.count * sizeof(T));
+			this->count = other.count;
+		}
+		return *this;
+	}
+
+	VKSmallVector &operator=(VKSmallVector &&other) noexcept {
+		if (this == &other)
+			return *this;
+		if (other.isInline()) {
+			this->count = 0;
+			/*	Fits, since the inline capacity is the same.	*/
+			if (this->capacityCount < other.count)
+				this->reserve(other.count);
+			std::memcpy(this->ptr, other.ptr, other.count * sizeof(T));
+		} else {
+			/*	Steal the heap storage.	*/
+			this->release();
+			this->ptr = other.ptr;
+			this->capacityCount = other.capacityCount;
+			other.ptr = other.inlineData();
+			other.capacityCount = N;
+		}
+		this->count = other.count;
+		other.count = 0;
+		return *this;
+	}
+
+	void reserve(size_t capacity) {
+		if (capacity <= this->capacityCount)
+			return;
+		T *data = static_cast<T *>(std::malloc(capacity * sizeof(T)));
+		if (data == nullptr)
+			throw std::bad_alloc();
+		std::memcpy(data, this->ptr, this->count * sizeof(T));
+		this->release();
+		this->ptr = data;
+		this->capacityCount = capacity;
+	}
+
+	void resize(size_t size) {
+		this->reserve(size);
+		if (size > this->count)
+			std::memset(static_cast<void *>(this->ptr + this->count), 0, (size - this->count) * sizeof(T));
+		this->count = size;
+	}
+
+	void push_back(const T &value) {
+		if (this->count == this->capacityCount) {
+			/*	value may refer to an element of this vector.	*/
+			const T copy = value;
+			this->reserve(this->capacityCount * 2);
+			this->ptr[this->count++] = copy;
+			return;
+		}
+		this->ptr[this->count++] = value;
+	}
+
+	void clear() noexcept { this->count = 0; }
+
+	T *data() noexcept { return this->ptr; }
+	const T *data() const noexcept { return this->ptr; }
+	size_t size() const noexcept { return this->count; }
+	size_t capacity() const noexcept { return this->capacityCount; }
+	bool empty() const noexcept { return this->count == 0; }
+	T *begin() noexcept { return this->ptr; }
+	T *end() noexcept { return this->ptr + this->count; }
+	const T *begin() const noexcept { return this->ptr; }
+	const T *end() const noexcept { return this->ptr + this->count; }
+	T &operator[](size_t index) noexcept { return this->ptr[index]; }
+	const T &operator[](size_t index) const noexcept { return this->ptr[index]; }
+
+	operator VKArrayView<T>() const noexcept { return VKArrayView<T>(this->ptr, this->count); }
+
+  private:
+	T *inlineData() noexcept { return reinterpret_cast<T *>(this->storage); }
+	bool isInline() const noexcept { return this->ptr == reinterpret_cast<const T *>(this->storage); }
+	void release() noexcept {
+		if (!this->isInline())
+			std::free(this->ptr);
+		this->ptr = this->inlineData();
+		this->capacityCount = N;
+	}
+
+	alignas(T) unsigned char storage[N * sizeof(T)];
+	T *ptr;
+	size_t count;
+	size_t capacityCount;
+};
+
+#endif
@@ -0,0 +1,450 @@
+#include "VKConvert.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FVK_CONVERT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FVK_TARGET(x)
+#else
+#define FVK_TARGET(x) __attribute__((target(x)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define FVK_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*	Scalar reference implementations, also used for the tail of the vectorized loops.	*/
+
+static inline uint16_t floatToHalf(float value) noexcept {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+	const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+	/*	Inf and NaN, NaN stays quiet.	*/
+	if (absBits >= 0x7F800000u)
+		return sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u | ((absBits >> 13) & 0x3FFu) : 0u);
+	/*	65520 and above rounds to infinity.	*/
+	if (absBits >= 0x477FF000u)
+		return sign | 0x7C00u;
+	/*	Subnormal, let the FPU round by adding 0.5, which has the same ulp as a half subnormal.	*/
+	if (absBits < 0x38800000u) {
+		float absValue;
+		std::memcpy(&absValue, &absBits, sizeof(absValue));
+		absValue += 0.5f;
+		uint32_t rounded;
+		std::memcpy(&rounded, &absValue, sizeof(rounded));
+		return sign | static_cast<uint16_t>(rounded - 0x3F000000u);
+	}
+	/*	Normal, rebias the exponent and round to nearest even.	*/
+	const uint32_t odd = (absBits >> 13) & 1u;
+	return sign | static_cast<uint16_t>((absBits + 0xC8000FFFu + odd) >> 13);
+}
+
+static void float32ToFloat16Scalar(const float *src, uint16_t *dst, size_t count) noexcept {
+	for (size_t i = 0; i < count; i++)
+		dst[i] = floatToHalf(src[i]);
+}
+
+static void rgbToRGBAScalar(const uint8_t *src, uint8_t *dst, size_t nrPixels, uint8_t alpha) noexcept {
+	for (size_t i = 0; i < nrPixels; i++) {
+		dst[i * 4 + 0] = src[i * 3 + 0];
+		dst[i * 4 + 1] = src[i * 3 + 1];
+		dst[i * 4 + 2] = src[i * 3 + 2];
+		dst[i * 4 + 3] = alpha;
+	}
+}
+
+template <typename S, typename D> static void widenScalar(const S *src, D *dst, size_t count) noexcept {
+	for (size_t i = 0; i < count; i++)
+		dst[i] = src[i];
+}
+
+#ifdef FVK_CONVERT_X86
+FVK_TARGET("avx,f16c")
+static void float32ToFloat16F16C(const float *src, uint16_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), half);
+	}
+	float32ToFloat16Scalar(src + i, dst + i, count - i);
+}
+
+FVK_TARGET("ssse3")
+static void rgbToRGBASSSE3(const uint8_t *src, uint8_t *dst, size_t nrPixels, uint8_t alpha) noexcept {
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(alpha) << 24));
+	size_t i = 0;
+	/*	Each load reads 16 bytes of which 12 are used, stay within the source.	*/
+	for (; i + 6 <= nrPixels; i += 4) {
+		const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+		const __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alphaMask);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), rgba);
+	}
+	rgbToRGBAScalar(src + i * 3, dst + i * 4, nrPixels - i, alpha);
+}
+
+FVK_TARGET("ssse3")
+static void widen8To16SSSE3(const uint8_t *src, uint16_t *dst, size_t count) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi8(value, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 8), _mm_unpackhi_epi8(value, zero));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+
+FVK_TARGET("ssse3")
+static void widen16To32SSSE3(const uint16_t *src, uint32_t *dst, size_t count) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi16(value, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), _mm_unpackhi_epi16(value, zero));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+
+FVK_TARGET("avx2")
+static void widen8To16AVX2(const uint8_t *src, uint16_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_cvtepu8_epi16(value));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+
+FVK_TARGET("avx2")
+static void widen16To32AVX2(const uint16_t *src, uint32_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_cvtepu16_epi32(value));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+#endif
+
+#ifdef FVK_CONVERT_NEON
+static void float32ToFloat16NEON(const float *src, uint16_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+	float32ToFloat16Scalar(src + i, dst + i, count - i);
+}
+
+static void rgbToRGBANEON(const uint8_t *src, uint8_t *dst, size_t nrPixels, uint8_t alpha) noexcept {
+	size_t i = 0;
+	for (; i + 16 <= nrPixels; i += 16) {
+		const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+		uint8x16x4_t rgba;
+		rgba.val[0] = rgb.val[0];
+		rgba.val[1] = rgb.val[1];
+		rgba.val[2] = rgb.val[2];
+		rgba.val[3] = vdupq_n_u8(alpha);
+		vst4q_u8(dst + i * 4, rgba);
+	}
+	rgbToRGBAScalar(src + i * 3, dst + i * 4, nrPixels - i, alpha);
+}
+
+static void widen8To16NEON(const uint8_t *src, uint16_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const uint8x16_t value = vld1q_u8(src + i);
+		vst1q_u16(dst + i, vmovl_u8(vget_low_u8(value)));
+		vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(value)));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+
+static void widen16To32NEON(const uint16_t *src, uint32_t *dst, size_t count) noexcept {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const uint16x8_t value = vld1q_u16(src + i);
+		vst1q_u32(dst + i, vmovl_u16(vget_low_u16(value)));
+		vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(value)));
+	}
+	widenScalar(src + i, dst + i, count - i);
+}
+#endif
+
+static bool isISASupported(VKConvert::ISA isa) noexcept {
+	switch (isa) {
+	case VKConvert::ISA::Scalar:
+		return true;
+#ifdef FVK_CONVERT_X86
+#ifdef _MSC_VER
+	case VKConvert::ISA::SSSE3: {
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+	}
+	case VKConvert::ISA::AVX2: {
+		int info[4];
+		__cpuid(info, 1);
+		const bool f16c = (info[2] & (1 << 29)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (!f16c || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}
+#else
+	case VKConvert::ISA::SSSE3:
+		return __builtin_cpu_supports("ssse3");
+	case VKConvert::ISA::AVX2:
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+#endif
+#ifdef FVK_CONVERT_NEON
+	case VKConvert::ISA::NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+static std::atomic<VKConvert::ISA> &currentISA() noexcept {
+	static std::atomic<VKConvert::ISA> isa(VKConvert::getBestSupportedISA());
+	return isa;
+}
+
+VKConvert::ISA VKConvert::getBestSupportedISA() noexcept {
+	for (const ISA isa : {ISA::AVX2, ISA::NEON, ISA::SSSE3}) {
+		if (isISASupported(isa))
+			return isa;
+	}
+	return ISA::Scalar;
+}
+
+VKConvert::ISA VKConvert::getISA() noexcept { return currentISA().load(std::memory_order_relaxed); }
+
+void VKConvert::setISA(ISA isa) noexcept {
+	currentISA().store(isISASupported(isa) ? isa : ISA::Scalar, std::memory_order_relaxed);
+}
+
+const char *VKConvert::getISAName(ISA isa) noexcept {
+	switch (isa) {
+	case ISA::SSSE3:
+		return "SSSE3";
+	case ISA::AVX2:
+		return "AVX2";
+	case ISA::NEON:
+		return "NEON";
+	case ISA::Scalar:
+	default:
+		return "Scalar";
+	}
+}
+
+void VKConvert::float32ToFloat16(const float *src, uint16_t *dst, size_t count) noexcept {
+	switch (getISA()) {
+#ifdef FVK_CONVERT_X86
+	case ISA::AVX2:
+		float32ToFloat16F16C(src, dst, count);
+		return;
+#endif
+#ifdef FVK_CONVERT_NEON
+	case ISA::NEON:
+		float32ToFloat16NEON(src, dst, count);
+		return;
+#endif
+	default:
+		float32ToFloat16Scalar(src, dst, count);
+	}
+}
+
+void VKConvert::rgbToRGBA(const uint8_t *src, uint8_t *dst, size_t nrPixels, uint8_t alpha) noexcept {
+	switch (getISA()) {
+#ifdef FVK_CONVERT_X86
+	case ISA::AVX2:
+	case ISA::SSSE3:
+		rgbToRGBASSSE3(src, dst, nrPixels, alpha);
+		return;
+#endif
+#ifdef FVK_CONVERT_NEON
+	case ISA::NEON:
+		rgbToRGBANEON(src, dst, nrPixels, alpha);
+		return;
+#endif
+	default:
+		rgbToRGBAScalar(src, dst, nrPixels, alpha);
+	}
+}
+
+void VKConvert::widenIndices(const uint8_t *src, uint16_t *dst, size_t count) noexcept {
+	switch (getISA()) {
+#ifdef FVK_CONVERT_X86
+	case ISA::AVX2:
+		widen8To16AVX2(src, dst, count);
+		return;
+	case ISA::SSSE3:
+		widen8To16SSSE3(src, dst, count);
+		return;
+#endif
+#ifdef FVK_CONVERT_NEON
+	case ISA::NEON:
+		widen8To16NEON(src, dst, count);
+		return;
+#endif
+	default:
+		widenScalar(src, dst, count);
+	}
+}
+
+void VKConvert::widenIndices(const uint16_t *src, uint32_t *dst, size_t count) noexcept {
+	switch (getISA()) {
+#ifdef FVK_CONVERT_X86
+	case ISA::AVX2:
+		widen16To32AVX2(src, dst, count);
+		return;
+	case ISA::SSSE3:
+		widen16To32SSSE3(src, dst, count);
+		return;
+#endif
+#ifdef FVK_CONVERT_NEON
+	case ISA::NEON:
+		widen16To32NEON(src, dst, count);
+		return;
+#endif
+	default:
+		widenScalar(src, dst, count);
+	}
+}
+
+void VKConvert::repackRows(const void *src, size_t srcRowPitch, void *dst, size_t dstRowPitch, size_t rowSize,
+						   size_t nrRows) noexcept {
+	if (srcRowPitch == rowSize && dstRowPitch == rowSize) {
+		std::memcpy(dst, src, rowSize * nrRows);
+		return;
+	}
+	const uint8_t *srcRow = static_cast<const uint8_t *>(src);
+	uint8_t *dstRow = static_cast<uint8_t *>(dst);
+	for (size_t y = 0; y < nrRows; y++) {
+		std::memcpy(dstRow, srcRow, rowSize);
+		srcRow += srcRowPitch;
+		dstRow += dstRowPitch;
+	}
+}
+
+size_t VKConvert::getFormatSize(VkFormat format) noexcept {
+	switch (format) {
+	case VK_FORMAT_R8_UNORM:
+	case VK_FORMAT_R8_SRGB:
+		return 1;
+	case VK_FORMAT_R8G8_UNORM:
+	case VK_FORMAT_R16_SFLOAT:
+		return 2;
+	case VK_FORMAT_R8G8B8_UNORM:
+	case VK_FORMAT_R8G8B8_SRGB:
+	case VK_FORMAT_B8G8R8_UNORM:
+	case VK_FORMAT_B8G8R8_SRGB:
+		return 3;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_R16G16_SFLOAT:
+	case VK_FORMAT_R32_SFLOAT:
+		return 4;
+	case VK_FORMAT_R16G16B16_SFLOAT:
+		return 6;
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+	case VK_FORMAT_R32G32_SFLOAT:
+		return 8;
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		return 12;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+/*	Conversion kernels per row, between formats of the same component layout.	*/
+enum class RowConversion { None, Copy, Float16, RGBToRGBA };
+
+static RowConversion getRowConversion(VkFormat srcFormat, VkFormat dstFormat) noexcept {
+	if (srcFormat == dstFormat)
+		return VKConvert::getFormatSize(srcFormat) > 0 ? RowConversion::Copy : RowConversion::None;
+
+	switch (srcFormat) {
+	case VK_FORMAT_R32_SFLOAT:
+		return dstFormat == VK_FORMAT_R16_SFLOAT ? RowConversion::Float16 : RowConversion::None;
+	case VK_FORMAT_R32G32_SFLOAT:
+		return dstFormat == VK_FORMAT_R16G16_SFLOAT ? RowConversion::Float16 : RowConversion::None;
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		return dstFormat == VK_FORMAT_R16G16B16_SFLOAT ? RowConversion::Float16 : RowConversion::None;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		return dstFormat == VK_FORMAT_R16G16B16A16_SFLOAT ? RowConversion::Float16 : RowConversion::None;
+	case VK_FORMAT_R8G8B8_UNORM:
+		return dstFormat == VK_FORMAT_R8G8B8A8_UNORM ? RowConversion::RGBToRGBA : RowConversion::None;
+	case VK_FORMAT_R8G8B8_SRGB:
+		return dstFormat == VK_FORMAT_R8G8B8A8_SRGB ? RowConversion::RGBToRGBA : RowConversion::None;
+	case VK_FORMAT_B8G8R8_UNORM:
+		return dstFormat == VK_FORMAT_B8G8R8A8_UNORM ? RowConversion::RGBToRGBA : RowConversion::None;
+	case VK_FORMAT_B8G8R8_SRGB:
+		return dstFormat == VK_FORMAT_B8G8R8A8_SRGB ? RowConversion::RGBToRGBA : RowConversion::None;
+	default:
+		return RowConversion::None;
+	}
+}
+
+bool VKConvert::isConversionSupported(VkFormat srcFormat, VkFormat dstFormat) noexcept {
+	return getRowConversion(srcFormat, dstFormat) != RowConversion::None;
+}
+
+void VKConvert::convertImage(VkFormat srcFormat, const void *src, size_t srcRowPitch, VkFormat dstFormat, void *dst,
+							 size_t dstRowPitch, uint32_t width, uint32_t height) {
+	const RowConversion conversion = getRowConversion(srcFormat, dstFormat);
+	if (conversion == RowConversion::None)
+		throw cxxexcept::RuntimeException("Conversion from format {} to {} is not supported", srcFormat, dstFormat);
+
+	const size_t srcRowSize = getFormatSize(srcFormat) * width;
+	const size_t dstRowSize = getFormatSize(dstFormat) * width;
+	if (srcRowPitch == 0)
+		srcRowPitch = srcRowSize;
+	if (dstRowPitch == 0)
+		dstRowPitch = dstRowSize;
+
+	if (conversion == RowConversion::Copy) {
+		repackRows(src, srcRowPitch, dst, dstRowPitch, srcRowSize, height);
+		return;
+	}
+
+	const uint8_t *srcRow = static_cast<const uint8_t *>(src);
+	uint8_t *dstRow = static_cast<uint8_t *>(dst);
+
+	/*	Convert the whole image at once if both are tightly packed.	*/
+	size_t nrRows = height;
+	size_t nrPixels = width;
+	if (srcRowPitch == srcRowSize && dstRowPitch == dstRowSize) {
+		nrPixels *= height;
+		nrRows = 1;
+	}
+
+	for (size_t y = 0; y < nrRows; y++) {
+		switch (conversion) {
+		case RowConversion::Float16:
+			float32ToFloat16(reinterpret_cast<const float *>(srcRow), reinterpret_cast<uint16_t *>(dstRow),
+							 nrPixels * getFormatSize(srcFormat) / sizeof(float));
+			break;
+		case RowConversion::RGBToRGBA:
+			rgbToRGBA(srcRow, dstRow, nrPixels);
+			break;
+		default:
+			break;
+		}
+		srcRow += srcRowPitch;
+		dstRow += dstRowPitch;
+	}
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_CONVERT_H_
+#define _FVK_VK_CONVERT_H_ 1
+#include "VKUtil.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Host side data conversion for upload preparation, e.g. directly into mapped staging memory.
+ * Uses SSSE3/AVX2+F16C on x86 and NEON on AArch64 when available, selected at runtime, with a
+ * scalar fallback producing identical results.
+ */
+class FVK_DECL_EXTERN VKConvert {
+  public:
+	enum class ISA { Scalar, SSSE3, AVX2, NEON };
+
+	/**
+	 * @brief Get the instruction set the conversions are dispatched to.
+	 */
+	static ISA getISA() noexcept;
+
+	/**
+	 * @brief Override the dispatched instruction set, e.g. for benchmarking.
+	 * Falls back to the scalar path if not supported by the CPU.
+	 */
+	static void setISA(ISA isa) noexcept;
+
+	static ISA getBestSupportedISA() noexcept;
+	static const char *getISAName(ISA isa) noexcept;
+
+	/**
+	 * @brief Convert float32 to float16, rounding to nearest even.
+	 */
+	static void float32ToFloat16(const float *src, uint16_t *dst, size_t count) noexcept;
+
+	/**
+	 * @brief Expand 3 component 8 bit pixels to 4 components with constant alpha.
+	 */
+	static void rgbToRGBA(const uint8_t *src, uint8_t *dst, size_t nrPixels, uint8_t alpha = 0xFF) noexcept;
+
+	/**
+	 * @brief Widen indices, e.g. for devices without VK_EXT_index_type_uint8.
+	 */
+	static void widenIndices(const uint8_t *src, uint16_t *dst, size_t count) noexcept;
+	static void widenIndices(const uint16_t *src, uint32_t *dst, size_t count) noexcept;
+
+	/**
+	 * @brief Copy rows between different row pitches.
+	 */
+	static void repackRows(const void *src, size_t srcRowPitch, void *dst, size_t dstRowPitch, size_t rowSize,
+						   size_t nrRows) noexcept;
+
+	/**
+	 * @brief Check if convertImage supports the format pair.
+	 */
+	static bool isConversionSupported(VkFormat srcFormat, VkFormat dstFormat) noexcept;
+
+	/**
+	 * @brief Get the size of a texel for the uncompressed formats supported by the conversions, 0 otherwise.
+	 */
+	static size_t getFormatSize(VkFormat format) noexcept;
+
+	/**
+	 * @brief Convert a 2D image from the source format to the destination format, e.g. the format
+	 * the image was created with.
+	 *
+	 * @param srcFormat
+	 * @param src
+	 * @param srcRowPitch 0 for tightly packed.
+	 * @param dstFormat
+	 * @param dst
+	 * @param dstRowPitch 0 for tightly packed.
+	 * @param width
+	 * @param height
+	 */
+	static void convertImage(VkFormat srcFormat, const void *src, size_t srcRowPitch, VkFormat dstFormat, void *dst,
+							 size_t dstRowPitch, uint32_t width, uint32_t height);
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "VKDebug.h"
+#include <fmt/core.h>
+#include <mutex>
+
+namespace {
+	struct RegistryObject {
+		std::string name;
+		VkDeviceSize size;
+	};
+
+	struct HandleKey {
+		VkObjectType type;
+		uint64_t handle;
+		bool operator==(const HandleKey &other) const noexcept {
+			return this->type == other.type && this->handle == other.handle;
+		}
+	};
+
+	struct HandleKeyHash {
+		size_t operator()(const HandleKey &key) const noexcept {
+			return std::hash<uint64_t>()(key.handle) ^ (static_cast<size_t>(key.type) << 1);
+		}
+	};
+
+	std::mutex registryLock;
+	std::unordered_map<HandleKey, RegistryObject, HandleKeyHash> registryObjects;
+	std::unordered_map<std::string, VKDebugRegistry::Entry> registryEntries;
+
+	void fillLabel(VkDebugUtilsLabelEXT &label, const char *name, const float *color) noexcept {
+		label = {};
+		label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+		label.pLabelName = name;
+		if (color != nullptr) {
+			for (unsigned int i = 0; i < 4; i++)
+				label.color[i] = color[i];
+		}
+	}
+} // namespace
+
+void VKDebugRegistry::add(VkObjectType type, uint64_t handle, const char *name, VkDeviceSize size) {
+	std::lock_guard<std::mutex> guard(registryLock);
+
+	/*	Renaming moves the object from the previous name.	*/
+	RegistryObject &object = registryObjects[{type, handle}];
+	if (!object.name.empty()) {
+		Entry &previous = registryEntries[object.name];
+		previous.nrObjects--;
+		previous.nrBytes -= object.size;
+		if (previous.nrObjects == 0)
+			registryEntries.erase(object.name);
+	}
+
+	object.name = name;
+	object.size = size;
+	Entry &entry = registryEntries[object.name];
+	entry.nrObjects++;
+	entry.nrBytes += size;
+}
+
+void VKDebugRegistry::remove(VkObjectType type, uint64_t handle) {
+	std::lock_guard<std::mutex> guard(registryLock);
+	auto it = registryObjects.find({type, handle});
+	if (it == registryObjects.end())
+		return;
+
+	auto entry = registryEntries.find(it->second.name);
+	if (entry != registryEntries.end()) {
+		entry->second.nrObjects--;
+		entry->second.nrBytes -= it->second.size;
+		if (entry->second.nrObjects == 0)
+			registryEntries.erase(entry);
+	}
+	registryObjects.erase(it);
+}
+
+std::unordered_map<std::string, VKDebugRegistry::Entry> VKDebugRegistry::getEntries() {
+	std::lock_guard<std::mutex> guard(registryLock);
+	return registryEntries;
+}
+
+uint64_t VKDebugRegistry::getNrLiveObjects() {
+	std::lock_guard<std::mutex> guard(registryLock);
+	return registryObjects.size();
+}
+
+void VKDebug::setName(const VKDevice &device, VkObjectType type, uint64_t handle, const char *name,
+					  VkDeviceSize size) {
+#ifdef _DEBUG
+	VKDebugRegistry::add(type, handle, name, size);
+#else
+	(void)size;
+#endif
+
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkSetDebugUtilsObjectNameEXT == nullptr)
+		return;
+
+	VkDebugUtilsObjectNameInfoEXT nameInfo = {};
+	nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	nameInfo.objectType = type;
+	nameInfo.objectHandle = handle;
+	nameInfo.pObjectName = name;
+	VKS_VALIDATE(dispatch.vkSetDebugUtilsObjectNameEXT(device.getHandle(), &nameInfo));
+}
+
+void VKDebug::beginLabel(const VKDevice &device, VkCommandBuffer cmd, const char *name, const float *color) {
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkCmdBeginDebugUtilsLabelEXT == nullptr)
+		return;
+	VkDebugUtilsLabelEXT label;
+	fillLabel(label, name, color);
+	dispatch.vkCmdBeginDebugUtilsLabelEXT(cmd, &label);
+}
+
+void VKDebug::endLabel(const VKDevice &device, VkCommandBuffer cmd) {
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkCmdEndDebugUtilsLabelEXT != nullptr)
+		dispatch.vkCmdEndDebugUtilsLabelEXT(cmd);
+}
+
+void VKDebug::insertLabel(const VKDevice &device, VkCommandBuffer cmd, const char *name, const float *color) {
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkCmdInsertDebugUtilsLabelEXT == nullptr)
+		return;
+	VkDebugUtilsLabelEXT label;
+	fillLabel(label, name, color);
+	dispatch.vkCmdInsertDebugUtilsLabelEXT(cmd, &label);
+}
+
+void VKDebug::beginLabel(const VKDevice &device, VkQueue queue, const char *name, const float *color) {
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkQueueBeginDebugUtilsLabelEXT == nullptr)
+		return;
+	VkDebugUtilsLabelEXT label;
+	fillLabel(label, name, color);
+	std::unique_lock<std::mutex> guard = device.lockQueue(queue);
+	dispatch.vkQueueBeginDebugUtilsLabelEXT(queue, &label);
+}
+
+void VKDebug::endLabel(const VKDevice &device, VkQueue queue) {
+	const VKInstanceDispatch &dispatch = getDispatch(device);
+	if (dispatch.vkQueueEndDebugUtilsLabelEXT == nullptr)
+		return;
+	std::unique_lock<std::mutex> guard = device.lockQueue(queue);
+	dispatch.vkQueueEndDebugUtilsLabelEXT(queue);
+}
+
+VKDebugMessenger::VKDebugMessenger(const VulkanCore &core, VkDebugUtilsMessageSeverityFlagsEXT severities,
+								   Callback callback)
+	: core(core), messenger(VK_NULL_HANDLE), callback(std::move(callback)), nrErrors(0), nrWarnings(0) {
+	const VKInstanceDispatch &dispatch = core.getDispatch();
+	if (dispatch.vkCreateDebugUtilsMessengerEXT == nullptr)
+		throw cxxexcept::RuntimeException("{} is not enabled on the instance", VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+
+	VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	createInfo.messageSeverity = severities;
+	createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+							 VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+							 VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+	createInfo.pfnUserCallback = messageCallback;
+	createInfo.pUserData = this;
+
+	VKS_VALIDATE(dispatch.vkCreateDebugUtilsMessengerEXT(core.getHandle(), &createInfo, nullptr, &this->messenger));
+}
+
+VKDebugMessenger::~VKDebugMessenger() {
+	if (this->messenger != VK_NULL_HANDLE)
+		this->core.getDispatch().vkDestroyDebugUtilsMessengerEXT(this->core.getHandle(), this->messenger, nullptr);
+}
+
+VkBool32 VKAPI_CALL VKDebugMessenger::messageCallback(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+													  VkDebugUtilsMessageTypeFlagsEXT types,
+													  const VkDebugUtilsMessengerCallbackDataEXT *callbackData,
+													  void *userData) {
+	VKDebugMessenger *debugMessenger = static_cast<VKDebugMessenger *>(userData);
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+		debugMessenger->nrErrors++;
+	else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+		debugMessenger->nrWarnings++;
+
+	if (debugMessenger->callback) {
+		debugMessenger->callback(severity, types, callbackData->pMessage);
+	} else {
+		const char *level = "Verbose";
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+			level = "Error";
+		else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+			level = "Warning";
+		else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+			level = "Info";
+		fmt::print(stderr, "Vulkan {}: {}\n", level, callbackData->pMessage);
+	}
+	/*	The call that triggered the message must not be aborted.	*/
+	return VK_FALSE;
+}
@@ -21,20 +21,205 @@
  */
 #ifndef _FVK_VK_DEBUG_H_
 #define _FVK_VK_DEBUG_H_ 1
+#include "VKDevice.h"
 #include "VKUtil.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <unordered_map>
 
+/*	Non-dispatchable handles are only distinct types on 64-bit platforms, see vulkan_core.h.	*/
+#if defined(VK_USE_64_BIT_PTR_DEFINES)
+#define FVK_TYPED_HANDLES VK_USE_64_BIT_PTR_DEFINES
+#elif defined(__LP64__) || defined(_WIN64) || (defined(__x86_64__) && !defined(__ILP32__)) || defined(_M_X64) ||      \
+	defined(__ia64) || defined(_M_IA64) || defined(__aarch64__) || defined(__powerpc64__)
+#define FVK_TYPED_HANDLES 1
+#else
+#define FVK_TYPED_HANDLES 0
+#endif
+
+/**
+ * @brief Compile-time mapping from a Vulkan handle type to its VkObjectType.
+ *
+ * @tparam T
+ */
+template <typename T> struct VKObjectType;
+
+#define FVK_OBJECT_TYPE(T, Type)                                                                                       \
+	template <> struct VKObjectType<T> {                                                                               \
+		static constexpr VkObjectType value = Type;                                                                    \
+	};
+
+FVK_OBJECT_TYPE(VkInstance, VK_OBJECT_TYPE_INSTANCE)
+FVK_OBJECT_TYPE(VkPhysicalDevice, VK_OBJECT_TYPE_PHYSICAL_DEVICE)
+FVK_OBJECT_TYPE(VkDevice, VK_OBJECT_TYPE_DEVICE)
+FVK_OBJECT_TYPE(VkQueue, VK_OBJECT_TYPE_QUEUE)
+FVK_OBJECT_TYPE(VkCommandBuffer, VK_OBJECT_TYPE_COMMAND_BUFFER)
+#if FVK_TYPED_HANDLES
+FVK_OBJECT_TYPE(VkSemaphore, VK_OBJECT_TYPE_SEMAPHORE)
+FVK_OBJECT_TYPE(VkFence, VK_OBJECT_TYPE_FENCE)
+FVK_OBJECT_TYPE(VkDeviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY)
+FVK_OBJECT_TYPE(VkBuffer, VK_OBJECT_TYPE_BUFFER)
+FVK_OBJECT_TYPE(VkImage, VK_OBJECT_TYPE_IMAGE)
+FVK_OBJECT_TYPE(VkEvent, VK_OBJECT_TYPE_EVENT)
+FVK_OBJECT_TYPE(VkQueryPool, VK_OBJECT_TYPE_QUERY_POOL)
+FVK_OBJECT_TYPE(VkBufferView, VK_OBJECT_TYPE_BUFFER_VIEW)
+FVK_OBJECT_TYPE(VkImageView, VK_OBJECT_TYPE_IMAGE_VIEW)
+FVK_OBJECT_TYPE(VkShaderModule, VK_OBJECT_TYPE_SHADER_MODULE)
+FVK_OBJECT_TYPE(VkPipelineCache, VK_OBJECT_TYPE_PIPELINE_CACHE)
+FVK_OBJECT_TYPE(VkPipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT)
+FVK_OBJECT_TYPE(VkRenderPass, VK_OBJECT_TYPE_RENDER_PASS)
+FVK_OBJECT_TYPE(VkPipeline, VK_OBJECT_TYPE_PIPELINE)
+FVK_OBJECT_TYPE(VkDescriptorSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT)
+FVK_OBJECT_TYPE(VkSampler, VK_OBJECT_TYPE_SAMPLER)
+FVK_OBJECT_TYPE(VkDescriptorPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL)
+FVK_OBJECT_TYPE(VkDescriptorSet, VK_OBJECT_TYPE_DESCRIPTOR_SET)
+FVK_OBJECT_TYPE(VkFramebuffer, VK_OBJECT_TYPE_FRAMEBUFFER)
+FVK_OBJECT_TYPE(VkCommandPool, VK_OBJECT_TYPE_COMMAND_POOL)
+FVK_OBJECT_TYPE(VkSamplerYcbcrConversion, VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION)
+FVK_OBJECT_TYPE(VkDescriptorUpdateTemplate, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE)
+FVK_OBJECT_TYPE(VkSurfaceKHR, VK_OBJECT_TYPE_SURFACE_KHR)
+FVK_OBJECT_TYPE(VkSwapchainKHR, VK_OBJECT_TYPE_SWAPCHAIN_KHR)
+FVK_OBJECT_TYPE(VkDebugUtilsMessengerEXT, VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT)
+#endif
+
+/**
+ * @brief Registry of named objects with live counts and bytes per name. Only fed in debug
+ * builds, through VKDebug::setName and VKDebug::forget.
+ */
+class FVK_DECL_EXTERN VKDebugRegistry {
+  public:
+	struct Entry {
+		uint64_t nrObjects;
+		VkDeviceSize nrBytes;
+	};
+
+	static void add(VkObjectType type, uint64_t handle, const char *name, VkDeviceSize size);
+	static void remove(VkObjectType type, uint64_t handle);
+
+	/**
+	 * @brief Get the live object count and bytes per name.
+	 *
+	 * @return std::unordered_map<std::string, Entry>
+	 */
+	static std::unordered_map<std::string, Entry> getEntries();
+	static uint64_t getNrLiveObjects();
+};
+
+/**
+ * @brief VK_EXT_debug_utils object naming and labels. All functions are no-ops if the extension
+ * is not enabled on the instance.
+ */
 class FVK_DECL_EXTERN VKDebug {
   public:
-	template <typename T> static void setName(VkDevice device, T vk_object, const char *name) {
-		if (pfnDebugMarkerSetObjectName) {
-			VkDebugMarkerObjectNameInfoEXT nameInfo = {};
-			nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_MARKER_OBJECT_NAME_INFO_EXT;
-			nameInfo.objectType = VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT;
-			nameInfo.object = vk_object;
-			nameInfo.pObjectName = name;
-			pfnDebugMarkerSetObjectName(device, &nameInfo);
+	/**
+	 * @brief Name an object, the object type is deduced from the handle type.
+	 *
+	 * @tparam T Vulkan handle type.
+	 * @param device
+	 * @param object
+	 * @param name
+	 * @param size bytes accounted to the name in the debug registry.
+	 */
+	template <typename T>
+	static void setName(const VKDevice &device, T object, const char *name, VkDeviceSize size = 0) {
+		setName(device, VKObjectType<T>::value, (uint64_t)object, name, size);
+	}
+
+	static void setName(const VKDevice &device, VkObjectType type, uint64_t handle, const char *name,
+						VkDeviceSize size = 0);
+
+	/**
+	 * @brief Remove a named object from the debug registry, to be called when it is destroyed.
+	 */
+	template <typename T> static void forget(T object) { forget(VKObjectType<T>::value, (uint64_t)object); }
+	static void forget(VkObjectType type, uint64_t handle) {
+#ifdef _DEBUG
+		VKDebugRegistry::remove(type, handle);
+#else
+		(void)type;
+		(void)handle;
+#endif
+	}
+
+	static void beginLabel(const VKDevice &device, VkCommandBuffer cmd, const char *name,
+						   const float *color = nullptr);
+	static void endLabel(const VKDevice &device, VkCommandBuffer cmd);
+	static void insertLabel(const VKDevice &device, VkCommandBuffer cmd, const char *name,
+							const float *color = nullptr);
+
+	static void beginLabel(const VKDevice &device, VkQueue queue, const char *name, const float *color = nullptr);
+	static void endLabel(const VKDevice &device, VkQueue queue);
+
+	/**
+	 * @brief Label region of a command buffer for the lifetime of the object.
+	 */
+	class FVK_DECL_EXTERN ScopedLabel {
+	  public:
+		ScopedLabel(const VKDevice &device, VkCommandBuffer cmd, const char *name, const float *color = nullptr)
+			: device(device), cmd(cmd) {
+			VKDebug::beginLabel(device, cmd, name, color);
 		}
+		ScopedLabel(const ScopedLabel &) = delete;
+		ScopedLabel(ScopedLabel &&) = delete;
+		~ScopedLabel() { VKDebug::endLabel(this->device, this->cmd); }
+
+	  private:
+		const VKDevice &device;
+		VkCommandBuffer cmd;
+	};
+
+	static bool isEnabled(const VKDevice &device) noexcept {
+		return getDispatch(device).vkSetDebugUtilsObjectNameEXT != nullptr;
+	}
+
+  private:
+	static const VKInstanceDispatch &getDispatch(const VKDevice &device) noexcept {
+		return device.getPhysicalDevice(0)->getInstance().getDispatch();
 	}
 };
 
+/**
+ * @brief VK_EXT_debug_utils messenger routing validation messages to a callback, by default
+ * written to stderr.
+ */
+class FVK_DECL_EXTERN VKDebugMessenger {
+  public:
+	using Callback = std::function<void(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+										VkDebugUtilsMessageTypeFlagsEXT types, const char *message)>;
+
+	/**
+	 * @brief Construct a new VKDebugMessenger object
+	 *
+	 * @param core instance created with VK_EXT_debug_utils.
+	 * @param severities
+	 * @param callback nullptr for the default stderr output.
+	 */
+	VKDebugMessenger(const VulkanCore &core,
+					 VkDebugUtilsMessageSeverityFlagsEXT severities = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+																	  VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+					 Callback callback = nullptr);
+	VKDebugMessenger(const VKDebugMessenger &) = delete;
+	VKDebugMessenger(VKDebugMessenger &&) = delete;
+	~VKDebugMessenger();
+
+	VkDebugUtilsMessengerEXT getHandle() const noexcept { return this->messenger; }
+
+	/*	Number of messages per severity, error and warning.	*/
+	uint64_t getNrErrors() const noexcept { return this->nrErrors; }
+	uint64_t getNrWarnings() const noexcept { return this->nrWarnings; }
+
+  private:
+	static VKAPI_ATTR VkBool32 VKAPI_CALL messageCallback(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+														  VkDebugUtilsMessageTypeFlagsEXT types,
+														  const VkDebugUtilsMessengerCallbackDataEXT *callbackData,
+														  void *userData);
+
+	const VulkanCore &core;
+	VkDebugUtilsMessengerEXT messenger;
+	Callback callback;
+	std::atomic<uint64_t> nrErrors;
+	std::atomic<uint64_t> nrWarnings;
+};
+
 #endif
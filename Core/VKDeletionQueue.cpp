@@ -0,0 +1,173 @@
+#include "VKDeletionQueue.h"
+#include "VKContainers.h"
+#include "VKHelper.h"
+
+VKDeletionQueue::VKDeletionQueue(VkDevice device, const VKSyncPool &syncPool)
+	: device(device), syncPool(syncPool), nrQueued(0), nrDestroyed(0) {}
+
+VKDeletionQueue::~VKDeletionQueue() { this->flush(); }
+
+bool VKDeletionQueue::isSupported(VkObjectType type) noexcept {
+	switch (type) {
+	case VK_OBJECT_TYPE_DEVICE_MEMORY:
+	case VK_OBJECT_TYPE_BUFFER:
+	case VK_OBJECT_TYPE_BUFFER_VIEW:
+	case VK_OBJECT_TYPE_IMAGE:
+	case VK_OBJECT_TYPE_IMAGE_VIEW:
+	case VK_OBJECT_TYPE_SAMPLER:
+	case VK_OBJECT_TYPE_SHADER_MODULE:
+	case VK_OBJECT_TYPE_PIPELINE:
+	case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+	case VK_OBJECT_TYPE_PIPELINE_CACHE:
+	case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+	case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+	case VK_OBJECT_TYPE_RENDER_PASS:
+	case VK_OBJECT_TYPE_FRAMEBUFFER:
+	case VK_OBJECT_TYPE_QUERY_POOL:
+	case VK_OBJECT_TYPE_COMMAND_POOL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void VKDeletionQueue::destroy(VkObjectType type, uint64_t handle, VkDeviceMemory memory,
+							  const RetirePoint &retirePoint) {
+	if (!isSupported(type))
+		throw cxxexcept::RuntimeException("Object type {} can not be queued for deletion", type);
+
+	const Entry entry = {type, handle, memory, retirePoint};
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (!retirePoint.isPending()) {
+		this->destroyEntry(entry);
+		this->nrDestroyed++;
+		return;
+	}
+	this->pending.push_back(entry);
+	this->nrQueued++;
+}
+
+uint32_t VKDeletionQueue::collect() {
+	struct FenceStatus {
+		VkFence fence;
+		bool signaled;
+	};
+
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (this->pending.empty())
+		return 0;
+
+	/*	Query each timeline once, and each distinct fence once, frames usually share a few fences.	*/
+	std::array<uint64_t, VKSyncPool::MaxTimelines> completedValues = {};
+	for (uint32_t i = 0; i < this->syncPool.getNrTimelines(); i++)
+		completedValues[i] = this->syncPool.getCompletedTimelineValue(i);
+	auto isTimelineReached = [&completedValues](const RetirePoint &retirePoint) {
+		for (size_t i = 0; i < completedValues.size(); i++) {
+			if (retirePoint.timelineValues[i] > completedValues[i])
+				return false;
+		}
+		return true;
+	};
+	VKSmallVector<FenceStatus, 8> fences;
+	auto isFenceSignaled = [&](VkFence fence) {
+		for (const FenceStatus &status : fences) {
+			if (status.fence == fence)
+				return status.signaled;
+		}
+		const bool signaled = vkGetFenceStatus(this->device, fence) == VK_SUCCESS;
+		fences.push_back({fence, signaled});
+		return signaled;
+	};
+
+	/*	Destroy in release order, keeping the order of the remaining entries.	*/
+	uint32_t nrCollected = 0;
+	size_t keep = 0;
+	for (size_t i = 0; i < this->pending.size(); i++) {
+		const Entry &entry = this->pending[i];
+		const bool retired = isTimelineReached(entry.retirePoint) &&
+							 (entry.retirePoint.fence == VK_NULL_HANDLE || isFenceSignaled(entry.retirePoint.fence));
+		if (retired) {
+			this->destroyEntry(entry);
+			nrCollected++;
+		} else {
+			this->pending[keep++] = entry;
+		}
+	}
+	this->pending.resize(keep);
+
+	this->nrDestroyed += nrCollected;
+	return nrCollected;
+}
+
+void VKDeletionQueue::flush() {
+	std::lock_guard<std::mutex> guard(this->lock);
+	for (const Entry &entry : this->pending)
+		this->destroyEntry(entry);
+	this->nrDestroyed += this->pending.size();
+	this->pending.clear();
+}
+
+VKDeletionQueue::Statistics VKDeletionQueue::getStatistics() const {
+	std::lock_guard<std::mutex> guard(this->lock);
+	return {this->nrQueued, this->nrDestroyed, static_cast<uint64_t>(this->pending.size())};
+}
+
+void VKDeletionQueue::destroyEntry(const Entry &entry) const {
+	VkDevice handle = this->device;
+	switch (entry.type) {
+	case VK_OBJECT_TYPE_DEVICE_MEMORY:
+		VKHelper::freeMemory(handle, (VkDeviceMemory)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_BUFFER:
+		VKHelper::destroyBuffer(handle, (VkBuffer)entry.handle, entry.memory);
+		return;
+	case VK_OBJECT_TYPE_BUFFER_VIEW:
+		vkDestroyBufferView(handle, (VkBufferView)entry.handle, nullptr);
+		break;
+	case VK_OBJECT_TYPE_IMAGE:
+		VKHelper::destroyImage(handle, (VkImage)entry.handle, entry.memory);
+		return;
+	case VK_OBJECT_TYPE_IMAGE_VIEW:
+		VKHelper::destroyImageView(handle, (VkImageView)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_SAMPLER:
+		VKHelper::destroySampler(handle, (VkSampler)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_SHADER_MODULE:
+		VKHelper::destroyShaderModule(handle, (VkShaderModule)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_PIPELINE:
+		VKHelper::destroyPipeline(handle, (VkPipeline)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+		VKHelper::destroyPipelineLayout(handle, (VkPipelineLayout)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_PIPELINE_CACHE:
+		VKHelper::destroyPipelineCache(handle, (VkPipelineCache)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+		VKHelper::destroyDescriptorSetLayout(handle, (VkDescriptorSetLayout)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+		VKHelper::destroyDescPool(handle, (VkDescriptorPool)entry.handle);
+		break;
+	case VK_OBJECT_TYPE_RENDER_PASS:
+		vkDestroyRenderPass(handle, (VkRenderPass)entry.handle, nullptr);
+		break;
+	case VK_OBJECT_TYPE_FRAMEBUFFER:
+		vkDestroyFramebuffer(handle, (VkFramebuffer)entry.handle, nullptr);
+		break;
+	case VK_OBJECT_TYPE_QUERY_POOL:
+		vkDestroyQueryPool(handle, (VkQueryPool)entry.handle, nullptr);
+		break;
+	case VK_OBJECT_TYPE_COMMAND_POOL:
+		vkDestroyCommandPool(handle, (VkCommandPool)entry.handle, nullptr);
+		break;
+	default:
+		break;
+	}
+
+	/*	Memory bound to objects without their own destroy helper.	*/
+	if (entry.memory != VK_NULL_HANDLE)
+		VKHelper::freeMemory(handle, entry.memory);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_DELETION_QUEUE_H_
+#define _FVK_VK_DELETION_QUEUE_H_ 1
+#include "VKSyncPool.h"
+#include "VKUtil.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Queue of objects waiting for the GPU work that last used them to retire, before
+ * being destroyed. Lets objects be released while frames are in flight, without waiting
+ * for the queue or the device.
+ *
+ * Thread safe.
+ */
+class FVK_DECL_EXTERN VKDeletionQueue {
+  public:
+	/**
+	 * @brief The submissions an object was last used in. The latest value on each queue timeline
+	 * returned by VKSyncPool::submitTimeline, a fence signaled by the submission, or both.
+	 * A default constructed point has no pending use. Construct it with fromTimeline or fromFence,
+	 * VkFence is a uint64_t on 32-bit platforms and brace initialization would not tell them apart.
+	 */
+	struct RetirePoint {
+		/*	Indexed by VKSyncPool::TimelinePoint::timeline, 0 if not used on that queue.	*/
+		std::array<uint64_t, VKSyncPool::MaxTimelines> timelineValues = {};
+		VkFence fence = VK_NULL_HANDLE;
+
+		static RetirePoint fromTimeline(const VKSyncPool::TimelinePoint &timelinePoint) noexcept {
+			RetirePoint point;
+			point.addTimeline(timelinePoint);
+			return point;
+		}
+
+		static RetirePoint fromFence(VkFence fence) noexcept {
+			RetirePoint point;
+			point.fence = fence;
+			return point;
+		}
+
+		/**
+		 * @brief Add a submission, keeping the latest value of each queue timeline.
+		 */
+		void addTimeline(const VKSyncPool::TimelinePoint &timelinePoint) noexcept {
+			uint64_t &value = this->timelineValues[timelinePoint.timeline];
+			value = std::max(value, timelinePoint.value);
+		}
+
+		bool isPending() const noexcept {
+			for (const uint64_t value : this->timelineValues) {
+				if (value != 0)
+					return true;
+			}
+			return this->fence != VK_NULL_HANDLE;
+		}
+	};
+
+	struct Statistics {
+		uint64_t nrQueued;
+		uint64_t nrDestroyed;
+		uint64_t nrPending;
+	};
+
+	/**
+	 * @brief Construct a new VKDeletionQueue object
+	 *
+	 * @param device
+	 * @param syncPool pool owning the device timeline.
+	 */
+	VKDeletionQueue(VkDevice device, const VKSyncPool &syncPool);
+	VKDeletionQueue(const VKDeletionQueue &) = delete;
+	VKDeletionQueue(VKDeletionQueue &&) = delete;
+	~VKDeletionQueue();
+
+	/**
+	 * @brief Destroy the object once the retire point has been reached, or directly if it has
+	 * no pending use. A fence used as retire point must not be destroyed before the object has
+	 * been collected; it may be reset and reused, which only delays the destruction.
+	 *
+	 * @param type one of the types listed by isSupported.
+	 * @param handle
+	 * @param memory memory owned by the object, freed after it. VK_NULL_HANDLE if none.
+	 * @param retirePoint
+	 */
+	void destroy(VkObjectType type, uint64_t handle, VkDeviceMemory memory, const RetirePoint &retirePoint);
+
+	/**
+	 * @brief Destroy all objects whose retire point has been reached. Never blocks on the GPU;
+	 * call once per frame, VKSwapchain does so when the frame fence has been waited on.
+	 *
+	 * @return uint32_t number of destroyed objects.
+	 */
+	uint32_t collect();
+
+	/**
+	 * @brief Destroy all objects regardless of their retire point. The device must be idle.
+	 */
+	void flush();
+
+	/**
+	 * @brief Check if objects of the type can be queued.
+	 */
+	static bool isSupported(VkObjectType type) noexcept;
+
+	Statistics getStatistics() const;
+
+  private:
+	struct Entry {
+		VkObjectType type;
+		uint64_t handle;
+		VkDeviceMemory memory;
+		RetirePoint retirePoint;
+	};
+
+	void destroyEntry(const Entry &entry) const;
+
+	VkDevice device;
+	const VKSyncPool &syncPool;
+	std::vector<Entry> pending;
+	uint64_t nrQueued;
+	uint64_t nrDestroyed;
+	mutable std::mutex lock;
+};
+
+#endif
@@ -1,92 +1,116 @@
 #include "VKDevice.h"
 #include "Exception.hpp"
+#include <algorithm>
+#include <cstring>
 
 VKDevice::VKDevice(const std::vector<std::shared_ptr<PhysicalDevice>> &devices,
-				   const std::unordered_map<const char *, bool> &requested_extensions, VkQueueFlags requiredQueues) {
+				   const std::unordered_map<const char *, bool> &requested_extensions, VkQueueFlags requiredQueues,
+				   const void *pNext)
+	: logicalDevice(VK_NULL_HANDLE), graphicsQueue(VK_NULL_HANDLE), presentQueue(VK_NULL_HANDLE),
+	  computeQueue(VK_NULL_HANDLE), transferQueue(VK_NULL_HANDLE), sparseQueue(VK_NULL_HANDLE), dispatch() {
 
 	/*  Select queue with graphic.  */
 	uint32_t graphicsQueueNodeIndex = UINT32_MAX;
 	uint32_t computeQueueNodeIndex = UINT32_MAX;
 	uint32_t presentQueueNodeIndex = UINT32_MAX;
 	uint32_t transferQueueNodeIndex = UINT32_MAX;
+	bool dedicatedTransfer = false;
+
+	if (devices.empty())
+		throw cxxexcept::RuntimeException("No physical device specified");
 
 	/*  Required extensions.    */
 	std::vector<const char *> deviceExtensions;
 	deviceExtensions.reserve(requested_extensions.size());
 
-	for (size_t j = 0; j < devices.size(); j++) {
-		const std::shared_ptr<PhysicalDevice> &device = devices[j];
-		/*	Iterate through each extension and add if supported.	*/
-		for (const std::pair<const char *, bool> &n : requested_extensions) {
-			if (n.second) {
-				if (device->isExtensionSupported(n.first))
-					deviceExtensions.push_back(n.first);
-				else
-					throw cxxexcept::RuntimeException("Device '{}' does not support: {}\n", device->getDeviceName(), n.first);
-			}
+	/*	Iterate through each extension and add if supported by all devices.	*/
+	for (const std::pair<const char *, bool> &n : requested_extensions) {
+		if (!n.second)
+			continue;
+		for (size_t j = 0; j < devices.size(); j++) {
+			const std::shared_ptr<PhysicalDevice> &device = devices[j];
+			if (!device->isExtensionSupported(n.first))
+				throw cxxexcept::RuntimeException("Device '{}' does not support: {}\n", device->getDeviceName(), n.first);
 		}
+		deviceExtensions.push_back(n.first);
 	}
 
-	uint32_t nrQueues = 1;
-	for (size_t j = 0; j < devices.size(); j++) {
-		const std::shared_ptr<PhysicalDevice> &phDevice = devices[j];
-
-		for (size_t i = 0; i < phDevice->getQueueFamilyProperties().size(); i++) {
-			/*  */
-			const VkQueueFamilyProperties &familyProp = phDevice->getQueueFamilyProperties()[i];
+	/*	Devices in a group shares the same queue family layout, thus the first device is used.	*/
+	const std::shared_ptr<PhysicalDevice> &phDevice = devices[0];
+	for (size_t i = 0; i < phDevice->getQueueFamilyProperties().size(); i++) {
+		/*  */
+		const VkQueueFamilyProperties &familyProp = phDevice->getQueueFamilyProperties()[i];
 
-			/*  */
-			if ((familyProp.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 && (requiredQueues & VK_QUEUE_GRAPHICS_BIT) != 0) {
-				if (graphicsQueueNodeIndex == UINT32_MAX)
-					graphicsQueueNodeIndex = i;
-			}
-			if ((familyProp.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 && (requiredQueues & VK_QUEUE_COMPUTE_BIT) != 0) {
-				if (computeQueueNodeIndex == UINT32_MAX)
-					computeQueueNodeIndex = i;
+		/*  */
+		if ((familyProp.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 && (requiredQueues & VK_QUEUE_GRAPHICS_BIT) != 0) {
+			if (graphicsQueueNodeIndex == UINT32_MAX)
+				graphicsQueueNodeIndex = i;
+		}
+		if ((familyProp.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 && (requiredQueues & VK_QUEUE_COMPUTE_BIT) != 0) {
+			if (computeQueueNodeIndex == UINT32_MAX)
+				computeQueueNodeIndex = i;
+		}
+		if ((familyProp.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 && (requiredQueues & VK_QUEUE_TRANSFER_BIT) != 0) {
+			/*	Prefer a dedicated transfer family, usually a copy engine running alongside the other queues.	*/
+			const bool dedicated = (familyProp.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+			if (transferQueueNodeIndex == UINT32_MAX || (dedicated && !dedicatedTransfer)) {
+				transferQueueNodeIndex = i;
+				dedicatedTransfer = dedicated;
 			}
 		}
 	}
 
-	// TODO resolve in case compute is not supported on the graphic queue.
-	if ((requiredQueues & VK_QUEUE_COMPUTE_BIT) && computeQueueNodeIndex == UINT32_MAX) {
+	/*	Check so that all the required queues were found.	*/
+	if ((requiredQueues & VK_QUEUE_GRAPHICS_BIT) && graphicsQueueNodeIndex == UINT32_MAX)
+		throw cxxexcept::RuntimeException("Device '{}' does not support graphic queue", phDevice->getDeviceName());
+	if ((requiredQueues & VK_QUEUE_COMPUTE_BIT) && computeQueueNodeIndex == UINT32_MAX)
+		throw cxxexcept::RuntimeException("Device '{}' does not support compute queue", phDevice->getDeviceName());
+
+	/*	Graphic and compute queue implicitly supports transfer operations, even if the family does
+		not report the transfer bit, thus used only if no transfer family was found.	*/
+	if (transferQueueNodeIndex == UINT32_MAX) {
+		if (graphicsQueueNodeIndex != UINT32_MAX)
+			transferQueueNodeIndex = graphicsQueueNodeIndex;
+		else if (computeQueueNodeIndex != UINT32_MAX)
+			transferQueueNodeIndex = computeQueueNodeIndex;
+	}
+	if ((requiredQueues & VK_QUEUE_TRANSFER_BIT) && transferQueueNodeIndex == UINT32_MAX) {
+		for (size_t i = 0; i < phDevice->getQueueFamilyProperties().size(); i++) {
+			if (phDevice->getQueueFamilyProperties()[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) {
+				transferQueueNodeIndex = i;
+				break;
+			}
+		}
 	}
-	// TODO check so tha all the required required queues were found.
+	if ((requiredQueues & VK_QUEUE_TRANSFER_BIT) && transferQueueNodeIndex == UINT32_MAX)
+		throw cxxexcept::RuntimeException("Device '{}' does not support transfer queue", phDevice->getDeviceName());
+	presentQueueNodeIndex = graphicsQueueNodeIndex;
 
 	this->graphics_queue_node_index = graphicsQueueNodeIndex;
 	this->compute_queue_node_index = computeQueueNodeIndex;
-	this->present_queue_node_index = this->graphics_queue_node_index;
-	this->transfer_queue_node_index = this->graphics_queue_node_index;
+	this->present_queue_node_index = presentQueueNodeIndex;
+	this->transfer_queue_node_index = transferQueueNodeIndex;
+	this->sparse_queue_node_index = UINT32_MAX;
+
+	/*	One queue for each unique queue family.	*/
+	std::vector<uint32_t> queueFamilies;
+	for (const uint32_t family : {graphicsQueueNodeIndex, computeQueueNodeIndex, transferQueueNodeIndex}) {
+		if (family != UINT32_MAX && std::find(queueFamilies.begin(), queueFamilies.end(), family) == queueFamilies.end())
+			queueFamilies.push_back(family);
+	}
 
-	std::vector<VkDeviceQueueCreateInfo> queueCreations(nrQueues);
-	std::vector<float> queuePriorities(1.0f, nrQueues);
+	std::vector<VkDeviceQueueCreateInfo> queueCreations(queueFamilies.size());
+	const float queuePriority = 1.0f;
 	for (size_t i = 0; i < queueCreations.size(); i++) {
 		VkDeviceQueueCreateInfo &queueCreateInfo = queueCreations[i];
 		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 		queueCreateInfo.pNext = nullptr;
 		queueCreateInfo.flags = 0;
-		queueCreateInfo.queueFamilyIndex = this->graphics_queue_node_index;
+		queueCreateInfo.queueFamilyIndex = queueFamilies[i];
 		queueCreateInfo.queueCount = 1;
-		queueCreateInfo.pQueuePriorities = &queuePriorities[i];
+		queueCreateInfo.pQueuePriorities = &queuePriority;
 	}
 
-	// if ((requiredQueues & VK_QUEUE_COMPUTE_BIT) && computeQueueNodeIndex != UINT32_MAX) {
-	// VkDeviceQueueCreateInfo &queueCreateInfo = queueCreations[0];
-	// queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	// queueCreateInfo.pNext = nullptr;
-	// queueCreateInfo.flags = 0;
-	// queueCreateInfo.queueFamilyIndex = this->graphics_queue_node_index;
-	// queueCreateInfo.queueCount = nrQueues;
-	// queueCreateInfo.pQueuePriorities = queuePriorities.data();
-	//}
-	// std::vector<VkDeviceQueueCreateInfo> queueInfos(1);
-
-	// queueInfos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	// queueInfos[0].pNext = nullptr;
-	// queueInfos[0].flags = 0;
-	// queueInfos[0].queueFamilyIndex = this->graphics_queue_node_index;
-	// queueInfos[0].queueCount = nrQueues;
-	// queueInfos[0].pQueuePriorities = queuePriorities.data();
-
 	/*	*/
 	VkDeviceGroupDeviceCreateInfo deviceGroupDeviceCreateInfo{};
 	deviceGroupDeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO;
@@ -94,7 +118,7 @@ VKDevice::VKDevice(const std::vector<std::shared_ptr<PhysicalDevice>> &devices,
 	/*	*/
 	VkDeviceCreateInfo deviceInfo = {};
 	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	deviceInfo.pNext = VK_NULL_HANDLE;
+	deviceInfo.pNext = pNext;
 	deviceInfo.queueCreateInfoCount = queueCreations.size();
 	deviceInfo.pQueueCreateInfos = queueCreations.data();
 
@@ -105,35 +129,86 @@ VKDevice::VKDevice(const std::vector<std::shared_ptr<PhysicalDevice>> &devices,
 			groupDevices[i] = devices[i]->getHandle();
 		deviceGroupDeviceCreateInfo.physicalDeviceCount = groupDevices.size();
 		deviceGroupDeviceCreateInfo.pPhysicalDevices = groupDevices.data();
+		deviceGroupDeviceCreateInfo.pNext = pNext;
 		deviceInfo.pNext = &deviceGroupDeviceCreateInfo;
 	}
 
+	/*	Enable timeline semaphores if supported, core in 1.2 and otherwise VK_KHR_timeline_semaphore.
+		Core features are limited by the lower of the instance and device versions, and querying the
+		feature with vkGetPhysicalDeviceFeatures2 requires an instance of at least 1.1.	*/
+	const uint32_t instanceApiVersion = phDevice->getInstance().getApiVersion();
+	const uint32_t apiVersion = std::min(instanceApiVersion, phDevice->getProperties().apiVersion);
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+	const bool timelineExtension =
+		std::find_if(deviceExtensions.begin(), deviceExtensions.end(), [](const char *extension) {
+			return std::strcmp(extension, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0;
+		}) != deviceExtensions.end();
+	/*	A caller chain that already holds the feature is used as is, the structure may not be chained twice.	*/
+	const VkPhysicalDeviceTimelineSemaphoreFeatures *requestedTimeline =
+		findStructure<VkPhysicalDeviceTimelineSemaphoreFeatures>(pNext);
+	const VkPhysicalDeviceVulkan12Features *requestedVulkan12 = findStructure<VkPhysicalDeviceVulkan12Features>(pNext);
+	if (requestedTimeline != nullptr || requestedVulkan12 != nullptr) {
+		timelineFeatures.timelineSemaphore = (requestedTimeline != nullptr && requestedTimeline->timelineSemaphore) ||
+											 (requestedVulkan12 != nullptr && requestedVulkan12->timelineSemaphore);
+	} else if (instanceApiVersion >= VK_API_VERSION_1_1 && (timelineExtension || apiVersion >= VK_API_VERSION_1_2)) {
+		phDevice->checkFeature(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES, timelineFeatures);
+		if (timelineFeatures.timelineSemaphore) {
+			timelineFeatures.pNext = const_cast<void *>(deviceInfo.pNext);
+			deviceInfo.pNext = &timelineFeatures;
+		}
+	}
+
 	deviceInfo.enabledExtensionCount = deviceExtensions.size();
 	deviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
+	/*	Core features are only enabled through the caller chain, pEnabledFeatures is not used.	*/
+	const VkPhysicalDeviceFeatures2 *requestedFeatures = findStructure<VkPhysicalDeviceFeatures2>(pNext);
+	this->enabledFeatures = requestedFeatures != nullptr ? requestedFeatures->features : VkPhysicalDeviceFeatures{};
+
 	/*  Create device.  */
 	VKS_VALIDATE(vkCreateDevice(devices[0]->getHandle(), &deviceInfo, VK_NULL_HANDLE, &this->logicalDevice));
+	this->enabledExtensions.assign(deviceExtensions.begin(), deviceExtensions.end());
+
+	/*	Resolve the driver entry points, falling back to the loader when the instance table is missing.	*/
+	PFN_vkGetDeviceProcAddr getDeviceProcAddr = phDevice->getInstance().getDispatch().vkGetDeviceProcAddr;
+	this->dispatch.load(getHandle(), getDeviceProcAddr != nullptr ? getDeviceProcAddr : vkGetDeviceProcAddr);
 
 	/*  Get all queues.    */
-	if (requiredQueues & VK_QUEUE_GRAPHICS_BIT)
+	if (this->graphics_queue_node_index != UINT32_MAX)
 		vkGetDeviceQueue(getHandle(), this->graphics_queue_node_index, 0, &this->graphicsQueue);
-	if (requiredQueues & VK_QUEUE_GRAPHICS_BIT)
+	if (this->present_queue_node_index != UINT32_MAX)
 		vkGetDeviceQueue(getHandle(), this->present_queue_node_index, 0, &this->presentQueue);
-	if (requiredQueues & VK_QUEUE_COMPUTE_BIT)
+	if (this->compute_queue_node_index != UINT32_MAX)
 		vkGetDeviceQueue(getHandle(), this->compute_queue_node_index, 0, &this->computeQueue);
-	if (requiredQueues & VK_QUEUE_TRANSFER_BIT)
+	if (this->transfer_queue_node_index != UINT32_MAX)
 		vkGetDeviceQueue(getHandle(), this->transfer_queue_node_index, 0, &this->transferQueue);
 
+	/*	One lock and one timeline per unique queue, the default queues may alias.	*/
+	std::vector<VkQueue> queues(queueFamilies.size());
+	for (size_t i = 0; i < queueFamilies.size(); i++) {
+		vkGetDeviceQueue(getHandle(), queueFamilies[i], 0, &queues[i]);
+		this->queueLocks.addQueue(queues[i]);
+	}
+
 	this->physicalDevices = devices;
+	this->syncPool = std::make_unique<VKSyncPool>(
+		getHandle(), this->dispatch, timelineFeatures.timelineSemaphore == VK_TRUE, queues, &this->queueLocks);
+	this->deletionQueue = std::make_unique<VKDeletionQueue>(getHandle(), *this->syncPool);
 }
 
 VKDevice::VKDevice(const std::shared_ptr<PhysicalDevice> &physicalDevice,
-				   const std::unordered_map<const char *, bool> &requested_extensions, VkQueueFlags requiredQueues) {
-	const std::vector<std::shared_ptr<PhysicalDevice>> physical = {physicalDevice};
-	VKDevice(physical, requested_extensions, requiredQueues);
-}
+				   const std::unordered_map<const char *, bool> &requested_extensions, VkQueueFlags requiredQueues,
+				   const void *pNext)
+	: VKDevice(std::vector<std::shared_ptr<PhysicalDevice>>{physicalDevice}, requested_extensions, requiredQueues,
+			   pNext) {}
 
 VKDevice::~VKDevice() {
+	/*	Objects still waiting on the GPU are destroyed once the device is idle.	*/
+	if (this->deletionQueue) {
+		vkDeviceWaitIdle(this->getHandle());
+		this->deletionQueue.reset();
+	}
+	this->syncPool.reset();
 	if (this->getHandle() != VK_NULL_HANDLE)
 		vkDestroyDevice(this->getHandle(), VK_NULL_HANDLE);
 }
\ No newline at end of file
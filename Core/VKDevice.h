@@ -21,47 +21,68 @@
  */
 #ifndef _FVK_VK_DEVICE_H_
 #define _FVK_VK_DEVICE_H_ 1
+#include "VKContainers.h"
+#include "VKDeletionQueue.h"
 #include "VKHelper.h"
+#include "VKSyncPool.h"
+#include "VKThreadSafety.h"
 #include "VKUtil.h"
 #include "VkPhysicalDevice.h"
 #include "VulkanCore.h"
+#include <algorithm>
 #include <fmt/core.h>
+#include <memory>
 #include <optional>
+#include <string>
 #include <unordered_map>
 
 /**
- * @brief
+ * @brief Logical device.
  *
+ * Thread safety: all const query methods are safe to call concurrently. Queue submission
+ * through the device, or while holding lockQueue, is internally synchronized per queue.
+ * Command pools remain externally synchronized as in Vulkan, debug builds detect use of the
+ * same pool from multiple threads at once and throw.
  */
 class FVK_DECL_EXTERN VKDevice {
   public:
-	// TODO add support for group device.!
 	/**
 	 * @brief Construct a new VKDevice object
+	 * Multiple physical devices creates a linked device group, the devices
+	 * has to be part of the same VkPhysicalDeviceGroupProperties.
 	 *
 	 * @param physicalDevices
 	 * @param requested_extensions
 	 * @param requiredQueues
+	 * @param pNext feature chain to enable, such as VKStructureChain<VkPhysicalDeviceFeatures2, ...>::data()
+	 * filled by PhysicalDevice::getFeatures.
 	 */
 	VKDevice(const std::vector<std::shared_ptr<PhysicalDevice>> &physicalDevices,
 			 const std::unordered_map<const char *, bool> &requested_extensions = {{"VK_KHR_swapchain", true}},
-			 VkQueueFlags requiredQueues = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+			 VkQueueFlags requiredQueues = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT, const void *pNext = nullptr);
 	// TODO add std::function for override the select GPU.
 
 	VKDevice(const std::shared_ptr<PhysicalDevice> &physicalDevice,
 			 const std::unordered_map<const char *, bool> &requested_extensions = {{"VK_KHR_swapchain", true}},
-			 VkQueueFlags requiredQueues = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+			 VkQueueFlags requiredQueues = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT, const void *pNext = nullptr);
 	VKDevice(const VKDevice &) = delete;
 	VKDevice(VKDevice &&) = delete;
 	~VKDevice();
 
 	/**
-	 * @brief
+	 * @brief Check if the logical device was created from a device group.
 	 *
 	 * @return true
 	 * @return false
 	 */
-	bool isGroupDevice() const noexcept { return this->getPhysicalDevices().size() > 0; }
+	bool isGroupDevice() const noexcept { return this->getPhysicalDevices().size() > 1; }
+
+	/**
+	 * @brief Get the device mask that includes all physical devices in the group.
+	 *
+	 * @return uint32_t
+	 */
+	uint32_t getDefaultDeviceMask() const noexcept { return (1u << this->getNrPhysicalDevices()) - 1u; }
 	const std::vector<std::shared_ptr<PhysicalDevice>> &getPhysicalDevices() const noexcept { return this->physicalDevices; }
 
 	unsigned int getNrPhysicalDevices() const noexcept { return this->physicalDevices.size(); }
@@ -79,17 +100,105 @@ class FVK_DECL_EXTERN VKDevice {
 	uint32_t getDefaultGraphicQueueIndex() const noexcept { return this->graphics_queue_node_index; }
 	uint32_t getDefaultComputeQueueIndex() const noexcept { return this->compute_queue_node_index; }
 	uint32_t getDefaultTransferQueueIndex() const noexcept { return this->transfer_queue_node_index; }
+	uint32_t getDefaultPresentQueueIndex() const noexcept { return this->present_queue_node_index; }
+
+	/**
+	 * @brief Get the pool of recycled fences and semaphores of the device.
+	 *
+	 * @return VKSyncPool&
+	 */
+	VKSyncPool &getSyncPool() const noexcept { return *this->syncPool; }
+
+	/**
+	 * @brief Get the queue of objects destroyed once their last submission has retired,
+	 * fed by the VKUniqueHandle types.
+	 *
+	 * @return VKDeletionQueue&
+	 */
+	VKDeletionQueue &getDeletionQueue() const noexcept { return *this->deletionQueue; }
+
+	/**
+	 * @brief Get the device function table, calling the driver directly without the loader trampoline.
+	 *
+	 * @return const VKDeviceDispatch&
+	 */
+	const VKDeviceDispatch &getDispatch() const noexcept { return this->dispatch; }
+
+	/**
+	 * @brief Get the core features enabled at creation, from the VkPhysicalDeviceFeatures2
+	 * in the creation pNext chain. Supported but not enabled features are false.
+	 *
+	 * @return const VkPhysicalDeviceFeatures&
+	 */
+	const VkPhysicalDeviceFeatures &getEnabledFeatures() const noexcept { return this->enabledFeatures; }
+
+	/**
+	 * @brief Check if the extension was enabled at creation. Supported but not requested
+	 * extensions are not enabled, see PhysicalDevice::isExtensionSupported.
+	 *
+	 * @param extension
+	 * @return true
+	 * @return false
+	 */
+	bool isExtensionEnabled(const std::string &extension) const noexcept {
+		return std::find(this->enabledExtensions.begin(), this->enabledExtensions.end(), extension) !=
+			   this->enabledExtensions.end();
+	}
+
+	const std::vector<std::string> &getEnabledExtensions() const noexcept { return this->enabledExtensions; }
+
+	/**
+	 * @brief Lock one of the device queues for direct vkQueue* calls, held until the returned
+	 * lock is destroyed. Other queues can be submitted to concurrently.
+	 *
+	 * @param queue
+	 * @return std::unique_lock<std::mutex>
+	 */
+	std::unique_lock<std::mutex> lockQueue(VkQueue queue) const { return this->queueLocks.lock(queue); }
 
 	/**
 	 * @brief
 	 *
+	 * @tparam n index of the physical device in the group.
 	 * @param typeFilter
 	 * @param properties
 	 * @return uint32_t
 	 */
 	template <size_t n = 0>
 	std::optional<uint32_t> findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
-		return VKHelper::findMemoryType(physicalDevices[0]->getMemoryProperties(), typeFilter, properties);
+		return VKHelper::findMemoryType(physicalDevices[n]->getMemoryProperties(), typeFilter, properties);
+	}
+
+	/**
+	 * @brief Allocate device memory.
+	 * For device group, the memory is allocated on each physical device in the device mask.
+	 *
+	 * @param memRequirements
+	 * @param properties
+	 * @param deviceMask 0 for all devices in the group.
+	 * @param pNext
+	 * @return VkDeviceMemory
+	 */
+	VkDeviceMemory allocateMemory(const VkMemoryRequirements &memRequirements, VkMemoryPropertyFlags properties,
+								  uint32_t deviceMask = 0, const void *pNext = nullptr) {
+		VkMemoryAllocateFlagsInfo allocFlagsInfo = {};
+		allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		allocFlagsInfo.pNext = pNext;
+		allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_MASK_BIT;
+		allocFlagsInfo.deviceMask = deviceMask == 0 ? getDefaultDeviceMask() : deviceMask;
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.pNext = isGroupDevice() ? &allocFlagsInfo : pNext;
+		allocInfo.allocationSize = memRequirements.size;
+		const std::optional<uint32_t> typeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+		if (!typeIndex)
+			throw cxxexcept::RuntimeException("Could not find valid memory index");
+		allocInfo.memoryTypeIndex = typeIndex.value();
+
+		VkDeviceMemory memory;
+		VKS_VALIDATE(vkAllocateMemory(getHandle(), &allocInfo, nullptr, &memory));
+		return memory;
 	}
 
 	/**
@@ -117,10 +226,20 @@ class FVK_DECL_EXTERN VKDevice {
 		return pool;
 	}
 
-	void submitCommands(VkQueue queue, const std::vector<VkCommandBuffer> &cmd,
-						const std::vector<VkSemaphore> &waitSemaphores = {},
-						const std::vector<VkSemaphore> &signalSempores = {}, VkFence fence = VK_NULL_HANDLE,
-						const std::vector<VkPipelineStageFlags> &waitStages = {
+	/**
+	 * @brief Submit command buffers. All array arguments are views, so vectors, std::arrays and
+	 * brace-enclosed lists can be passed without any heap allocation.
+	 *
+	 * @param queue
+	 * @param cmd
+	 * @param waitSemaphores
+	 * @param signalSempores
+	 * @param fence
+	 * @param waitStages one per wait semaphore.
+	 */
+	void submitCommands(VkQueue queue, VKArrayView<VkCommandBuffer> cmd, VKArrayView<VkSemaphore> waitSemaphores = {},
+						VKArrayView<VkSemaphore> signalSempores = {}, VkFence fence = VK_NULL_HANDLE,
+						VKArrayView<VkPipelineStageFlags> waitStages = {
 							VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT}) {
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -137,13 +256,52 @@ class FVK_DECL_EXTERN VKDevice {
 		submitInfo.signalSemaphoreCount = signalSempores.size();
 		submitInfo.pSignalSemaphores = signalSempores.data();
 
-		VKS_VALIDATE(vkQueueSubmit(queue, 1, &submitInfo, fence));
+		std::unique_lock<std::mutex> guard = lockQueue(queue);
+		VKS_VALIDATE(this->dispatch.vkQueueSubmit(queue, 1, &submitInfo, fence));
 	}
 
-	std::vector<VkCommandBuffer> allocateCommandBuffers(VkCommandPool commandPool, VkCommandBufferLevel level,
-														unsigned int nrCmdBuffers = 1, const void *pNext = nullptr) {
-		std::vector<VkCommandBuffer> cmdBuffers(nrCmdBuffers);
+	/**
+	 * @brief Submit command buffers to a subset of the physical devices in the group.
+	 * Command buffers has to be begun with VkDeviceGroupCommandBufferBeginInfo covering
+	 * the device mask. Named apart from submitCommands, where {} would bind to the mask.
+	 *
+	 * @param queue
+	 * @param cmd
+	 * @param deviceMask 0 for all devices in the group.
+	 * @param fence
+	 */
+	void submitDeviceGroupCommands(VkQueue queue, VKArrayView<VkCommandBuffer> cmd, uint32_t deviceMask,
+								   VkFence fence = VK_NULL_HANDLE) {
+		VKSmallVector<uint32_t, 8> commandBufferDeviceMasks(cmd.size());
+		for (uint32_t &mask : commandBufferDeviceMasks)
+			mask = deviceMask == 0 ? getDefaultDeviceMask() : deviceMask;
+
+		VkDeviceGroupSubmitInfo deviceGroupSubmitInfo = {};
+		deviceGroupSubmitInfo.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_SUBMIT_INFO;
+		deviceGroupSubmitInfo.commandBufferCount = commandBufferDeviceMasks.size();
+		deviceGroupSubmitInfo.pCommandBufferDeviceMasks = commandBufferDeviceMasks.data();
 
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = isGroupDevice() ? &deviceGroupSubmitInfo : nullptr;
+		submitInfo.commandBufferCount = cmd.size();
+		submitInfo.pCommandBuffers = cmd.data();
+
+		std::unique_lock<std::mutex> guard = lockQueue(queue);
+		VKS_VALIDATE(this->dispatch.vkQueueSubmit(queue, 1, &submitInfo, fence));
+	}
+
+	/**
+	 * @brief Allocate command buffers into caller provided storage.
+	 *
+	 * @param commandPool
+	 * @param level
+	 * @param cmdBuffers array of at least nrCmdBuffers elements.
+	 * @param nrCmdBuffers
+	 * @param pNext
+	 */
+	void allocateCommandBuffers(VkCommandPool commandPool, VkCommandBufferLevel level, VkCommandBuffer *cmdBuffers,
+								unsigned int nrCmdBuffers, const void *pNext = nullptr) {
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.pNext = pNext;
@@ -151,11 +309,40 @@ class FVK_DECL_EXTERN VKDevice {
 		allocInfo.commandPool = commandPool;
 		allocInfo.commandBufferCount = nrCmdBuffers;
 
-		VKS_VALIDATE(vkAllocateCommandBuffers(getHandle(), &allocInfo, cmdBuffers.data()));
+		FVK_EXTERNAL_SYNC_SCOPE(commandPool);
+		VKS_VALIDATE(this->dispatch.vkAllocateCommandBuffers(getHandle(), &allocInfo, cmdBuffers));
+	}
 
+	std::vector<VkCommandBuffer> allocateCommandBuffers(VkCommandPool commandPool, VkCommandBufferLevel level,
+														unsigned int nrCmdBuffers = 1, const void *pNext = nullptr) {
+		std::vector<VkCommandBuffer> cmdBuffers(nrCmdBuffers);
+		allocateCommandBuffers(commandPool, level, cmdBuffers.data(), nrCmdBuffers, pNext);
 		return cmdBuffers;
 	}
 
+	/**
+	 * @brief Allocate command buffers in a small-buffer container, only touching the heap
+	 * when more than N command buffers are requested.
+	 *
+	 * @tparam N
+	 */
+	template <size_t N>
+	VKSmallVector<VkCommandBuffer, N> allocateCommandBuffersInline(VkCommandPool commandPool,
+																  VkCommandBufferLevel level,
+																  unsigned int nrCmdBuffers = N,
+																  const void *pNext = nullptr) {
+		VKSmallVector<VkCommandBuffer, N> cmdBuffers(nrCmdBuffers);
+		allocateCommandBuffers(commandPool, level, cmdBuffers.data(), nrCmdBuffers, pNext);
+		return cmdBuffers;
+	}
+
+	VkCommandBuffer allocateCommandBuffer(VkCommandPool commandPool, VkCommandBufferLevel level,
+										  const void *pNext = nullptr) {
+		VkCommandBuffer cmdBuffer;
+		allocateCommandBuffers(commandPool, level, &cmdBuffer, 1, pNext);
+		return cmdBuffer;
+	}
+
 	std::vector<VkCommandBuffer>
 	beginSingleTimeCommands(VkCommandPool commandPool, VkCommandBufferLevel level, unsigned int nrCmdBuffers = 1,
 							VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
@@ -168,20 +355,47 @@ class FVK_DECL_EXTERN VKDevice {
 		beginInfo.flags = usage;
 		beginInfo.pInheritanceInfo = pInheritInfo;
 
-		VKS_VALIDATE(vkBeginCommandBuffer(cmd[0], &beginInfo));
+		FVK_EXTERNAL_SYNC_SCOPE(commandPool);
+		for (VkCommandBuffer commandBuffer : cmd)
+			VKS_VALIDATE(this->dispatch.vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+		return cmd;
+	}
+
+	/**
+	 * @brief Allocate and begin a single command buffer without any heap allocation.
+	 */
+	VkCommandBuffer beginSingleTimeCommand(VkCommandPool commandPool,
+										   VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+										   VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+										   VkCommandBufferInheritanceInfo *pInheritInfo = nullptr,
+										   const void *pNext = nullptr) {
+		VkCommandBuffer cmd = allocateCommandBuffer(commandPool, level);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.pNext = pNext;
+		beginInfo.flags = usage;
+		beginInfo.pInheritanceInfo = pInheritInfo;
+
+		FVK_EXTERNAL_SYNC_SCOPE(commandPool);
+		VKS_VALIDATE(this->dispatch.vkBeginCommandBuffer(cmd, &beginInfo));
 
 		return cmd;
 	}
 
 	void endSingleTimeCommands(VkQueue queue, VkCommandBuffer commandBuffer, VkCommandPool commandPool) {
+		FVK_EXTERNAL_SYNC_SCOPE(commandPool);
 
-		VKS_VALIDATE(vkEndCommandBuffer(commandBuffer));
+		VKS_VALIDATE(this->dispatch.vkEndCommandBuffer(commandBuffer));
 
-		const std::vector<VkCommandBuffer> cmds = {commandBuffer};
-		submitCommands(queue, cmds);
-		VKS_VALIDATE(vkQueueWaitIdle(queue));
+		submitCommands(queue, commandBuffer);
+		{
+			std::unique_lock<std::mutex> guard = lockQueue(queue);
+			VKS_VALIDATE(this->dispatch.vkQueueWaitIdle(queue));
+		}
 
-		vkFreeCommandBuffers(getHandle(), commandPool, cmds.size(), cmds.data());
+		this->dispatch.vkFreeCommandBuffers(getHandle(), commandPool, 1, &commandBuffer);
 	}
 
 	/**
@@ -211,6 +425,13 @@ class FVK_DECL_EXTERN VKDevice {
 	VkQueue computeQueue;
 	VkQueue transferQueue;
 	VkQueue sparseQueue;
+
+	VKDeviceDispatch dispatch;
+	VkPhysicalDeviceFeatures enabledFeatures;
+	std::vector<std::string> enabledExtensions;
+	VKQueueLocks queueLocks;
+	std::unique_ptr<VKSyncPool> syncPool;
+	std::unique_ptr<VKDeletionQueue> deletionQueue;
 };
 
 #endif
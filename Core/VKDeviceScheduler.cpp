@@ -0,0 +1,149 @@
+#include "VKDeviceScheduler.h"
+
+VKDeviceScheduler::VKDeviceScheduler(const std::vector<std::shared_ptr<VKDevice>> &devices, unsigned int nrInFlight)
+	: roundRobin(0) {
+	if (devices.empty())
+		throw cxxexcept::RuntimeException("No device specified");
+	if (nrInFlight == 0)
+		throw cxxexcept::RuntimeException("Number of batches in flight must be greater than 0");
+
+	this->queues.resize(devices.size());
+	this->pending.resize(devices.size(), 0);
+
+	for (size_t i = 0; i < devices.size(); i++) {
+		DeviceQueue &deviceQueue = this->queues[i];
+		const std::shared_ptr<VKDevice> &device = devices[i];
+
+		/*	Prefer the compute queue, fallback on the graphic queue.	*/
+		uint32_t queueFamilyIndex;
+		if (device->getDefaultCompute() != VK_NULL_HANDLE) {
+			deviceQueue.queue = device->getDefaultCompute();
+			queueFamilyIndex = device->getDefaultComputeQueueIndex();
+		} else if (device->getDefaultGraphicQueue() != VK_NULL_HANDLE) {
+			deviceQueue.queue = device->getDefaultGraphicQueue();
+			queueFamilyIndex = device->getDefaultGraphicQueueIndex();
+		} else {
+			throw cxxexcept::RuntimeException("Device '{}' has no compute queue",
+											  device->getPhysicalDevice(0)->getDeviceName());
+		}
+
+		deviceQueue.device = device;
+		deviceQueue.commandPool = device->createCommandPool(queueFamilyIndex);
+		deviceQueue.next = 0;
+		deviceQueue.nrSubmitted = 0;
+
+		/*	*/
+		const std::vector<VkCommandBuffer> cmds =
+			device->allocateCommandBuffers(deviceQueue.commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, nrInFlight);
+
+		VkFenceCreateInfo fenceCreateInfo = {};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		deviceQueue.batches.resize(nrInFlight);
+		for (unsigned int j = 0; j < nrInFlight; j++) {
+			Batch &batch = deviceQueue.batches[j];
+			batch.cmd = cmds[j];
+			batch.pending = false;
+			VKS_VALIDATE(vkCreateFence(device->getHandle(), &fenceCreateInfo, nullptr, &batch.fence));
+		}
+	}
+}
+
+VKDeviceScheduler::~VKDeviceScheduler() {
+	this->wait();
+
+	for (DeviceQueue &deviceQueue : this->queues) {
+		VkDevice device = deviceQueue.device->getHandle();
+		for (Batch &batch : deviceQueue.batches) {
+			vkDestroyFence(device, batch.fence, nullptr);
+			vkFreeCommandBuffers(device, deviceQueue.commandPool, 1, &batch.cmd);
+		}
+		vkDestroyCommandPool(device, deviceQueue.commandPool, nullptr);
+	}
+}
+
+unsigned int VKDeviceScheduler::submit(const RecordCallback &record) {
+
+	/*	Poll the state of each device.	*/
+	for (size_t i = 0; i < this->queues.size(); i++)
+		this->pending[i] = updatePending(this->queues[i]);
+
+	const unsigned int index = selectDevice(this->pending, this->roundRobin);
+	this->roundRobin = (index + 1) % this->queues.size();
+
+	DeviceQueue &deviceQueue = this->queues[index];
+	VkDevice device = deviceQueue.device->getHandle();
+	const VKDeviceDispatch &dispatch = deviceQueue.device->getDispatch();
+
+	/*	Batches are used in ring order, the next one is the oldest.	*/
+	Batch &batch = deviceQueue.batches[deviceQueue.next];
+	if (batch.pending) {
+		VKS_VALIDATE(dispatch.vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX));
+		batch.pending = false;
+	}
+	VKS_VALIDATE(dispatch.vkResetFences(device, 1, &batch.fence));
+	VKS_VALIDATE(dispatch.vkResetCommandBuffer(batch.cmd, 0));
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VKS_VALIDATE(dispatch.vkBeginCommandBuffer(batch.cmd, &beginInfo));
+
+	record(*deviceQueue.device, batch.cmd);
+
+	VKS_VALIDATE(dispatch.vkEndCommandBuffer(batch.cmd));
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &batch.cmd;
+	{
+		std::unique_lock<std::mutex> guard = deviceQueue.device->lockQueue(deviceQueue.queue);
+		VKS_VALIDATE(dispatch.vkQueueSubmit(deviceQueue.queue, 1, &submitInfo, batch.fence));
+	}
+
+	batch.pending = true;
+	deviceQueue.next = (deviceQueue.next + 1) % deviceQueue.batches.size();
+	deviceQueue.nrSubmitted++;
+
+	return index;
+}
+
+void VKDeviceScheduler::wait() {
+	for (DeviceQueue &deviceQueue : this->queues) {
+		for (Batch &batch : deviceQueue.batches) {
+			if (batch.pending) {
+				VKS_VALIDATE(vkWaitForFences(deviceQueue.device->getHandle(), 1, &batch.fence, VK_TRUE, UINT64_MAX));
+				batch.pending = false;
+			}
+		}
+	}
+}
+
+unsigned int VKDeviceScheduler::selectDevice(const std::vector<unsigned int> &pending, unsigned int start) noexcept {
+	unsigned int selected = start % pending.size();
+	for (size_t i = 1; i < pending.size(); i++) {
+		const unsigned int index = (start + i) % pending.size();
+		if (pending[index] < pending[selected])
+			selected = index;
+	}
+	return selected;
+}
+
+unsigned int VKDeviceScheduler::updatePending(DeviceQueue &deviceQueue) {
+	const VKDeviceDispatch &dispatch = deviceQueue.device->getDispatch();
+	unsigned int nrPending = 0;
+	for (Batch &batch : deviceQueue.batches) {
+		if (!batch.pending)
+			continue;
+
+		const VkResult status = dispatch.vkGetFenceStatus(deviceQueue.device->getHandle(), batch.fence);
+		if (status == VK_SUCCESS)
+			batch.pending = false;
+		else if (status == VK_NOT_READY)
+			nrPending++;
+		else
+			VKS_VALIDATE(status);
+	}
+	return nrPending;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_DEVICE_SCHEDULER_H_
+#define _FVK_VK_DEVICE_SCHEDULER_H_ 1
+#include "VKDevice.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Distribute independent compute batches across multiple unlinked logical devices.
+ * Each device gets its own queue, command pool and a ring of in-flight batches. A batch is
+ * scheduled on the device with the least amount of pending work, ties are resolved in
+ * round-robin order.
+ *
+ * Not thread safe, all submission has to be done from a single thread.
+ */
+class FVK_DECL_EXTERN VKDeviceScheduler {
+  public:
+	using RecordCallback = std::function<void(VKDevice &device, VkCommandBuffer cmd)>;
+
+	/**
+	 * @brief Construct a new VKDeviceScheduler object
+	 *
+	 * @param devices
+	 * @param nrInFlight max number of batches in flight per device.
+	 */
+	VKDeviceScheduler(const std::vector<std::shared_ptr<VKDevice>> &devices, unsigned int nrInFlight = 2);
+	VKDeviceScheduler(const VKDeviceScheduler &) = delete;
+	VKDeviceScheduler(VKDeviceScheduler &&) = delete;
+	~VKDeviceScheduler();
+
+	/**
+	 * @brief Record and submit a batch on the least busy device.
+	 *
+	 * @param record callback recording the batch into the command buffer.
+	 * @return unsigned int index of the device the batch was submitted to.
+	 */
+	unsigned int submit(const RecordCallback &record);
+
+	/**
+	 * @brief Wait for all submitted batches on all devices.
+	 */
+	void wait();
+
+	/**
+	 * @brief Select the device index with the least pending work.
+	 *
+	 * @param pending number of pending batches per device.
+	 * @param start device index to start the round-robin search from.
+	 * @return unsigned int
+	 */
+	static unsigned int selectDevice(const std::vector<unsigned int> &pending, unsigned int start) noexcept;
+
+	unsigned int getNrDevices() const noexcept { return this->queues.size(); }
+	const std::shared_ptr<VKDevice> &getDevice(unsigned int index) const { return this->queues[index].device; }
+	uint64_t getNrSubmitted(unsigned int index) const { return this->queues[index].nrSubmitted; }
+
+  private:
+	struct Batch {
+		VkCommandBuffer cmd;
+		VkFence fence;
+		bool pending;
+	};
+
+	struct DeviceQueue {
+		std::shared_ptr<VKDevice> device;
+		VkQueue queue;
+		VkCommandPool commandPool;
+		std::vector<Batch> batches;
+		unsigned int next;
+		uint64_t nrSubmitted;
+	};
+
+	static unsigned int updatePending(DeviceQueue &queue);
+
+	std::vector<DeviceQueue> queues;
+	std::vector<unsigned int> pending;
+	unsigned int roundRobin;
+};
+
+#endif
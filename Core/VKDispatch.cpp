@@ -0,0 +1,51 @@
+#include "VKDispatch.h"
+
+void VKInstanceDispatch::load(VkInstance instance, PFN_vkGetInstanceProcAddr getInstanceProcAddr) {
+	if (getInstanceProcAddr == nullptr)
+		throw cxxexcept::RuntimeException("vkGetInstanceProcAddr is not available");
+
+#define FVK_LOAD_INSTANCE(name) this->name = reinterpret_cast<PFN_##name>(getInstanceProcAddr(instance, #name));
+	FVK_INSTANCE_FUNCTIONS(FVK_LOAD_INSTANCE)
+	FVK_INSTANCE_EXTENSION_FUNCTIONS(FVK_LOAD_INSTANCE)
+#undef FVK_LOAD_INSTANCE
+
+	if (this->vkGetDeviceProcAddr == nullptr)
+		throw cxxexcept::RuntimeException("Failed to resolve vkGetDeviceProcAddr");
+}
+
+void VKDeviceDispatch::load(VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr) {
+	if (getDeviceProcAddr == nullptr)
+		throw cxxexcept::RuntimeException("vkGetDeviceProcAddr is not available");
+
+#define FVK_LOAD_DEVICE(name)                                                                                          \
+	this->name = reinterpret_cast<PFN_##name>(getDeviceProcAddr(device, #name));                                       \
+	if (this->name == nullptr)                                                                                         \
+		throw cxxexcept::RuntimeException("Failed to resolve {}", #name);
+	FVK_DEVICE_FUNCTIONS(FVK_LOAD_DEVICE)
+#undef FVK_LOAD_DEVICE
+
+#define FVK_LOAD_DEVICE_EXTENSION(name) this->name = reinterpret_cast<PFN_##name>(getDeviceProcAddr(device, #name));
+	FVK_DEVICE_EXTENSION_FUNCTIONS(FVK_LOAD_DEVICE_EXTENSION)
+#undef FVK_LOAD_DEVICE_EXTENSION
+
+	/*	Timeline semaphore functions are core in 1.2, otherwise provided by VK_KHR_timeline_semaphore.	*/
+	if (this->vkWaitSemaphores == nullptr)
+		this->vkWaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphores>(getDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+	if (this->vkSignalSemaphore == nullptr)
+		this->vkSignalSemaphore =
+			reinterpret_cast<PFN_vkSignalSemaphore>(getDeviceProcAddr(device, "vkSignalSemaphoreKHR"));
+	if (this->vkGetSemaphoreCounterValue == nullptr)
+		this->vkGetSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValue>(
+			getDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+}
+
+const VKDeviceDispatch &VKDeviceDispatch::getGlobal() noexcept {
+	static const VKDeviceDispatch global = []() {
+		VKDeviceDispatch table = {};
+#define FVK_LOAD_GLOBAL(name) table.name = ::name;
+		FVK_DEVICE_FUNCTIONS(FVK_LOAD_GLOBAL)
+#undef FVK_LOAD_GLOBAL
+		return table;
+	}();
+	return global;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_DISPATCH_H_
+#define _FVK_VK_DISPATCH_H_ 1
+#include "VKUtil.h"
+
+/*	Instance level functions, queried with vkGetInstanceProcAddr.	*/
+#define FVK_INSTANCE_FUNCTIONS(X)                                                                                      \
+	X(vkDestroyInstance)                                                                                               \
+	X(vkEnumeratePhysicalDevices)                                                                                      \
+	X(vkGetDeviceProcAddr)                                                                                             \
+	X(vkGetPhysicalDeviceFeatures2)                                                                                    \
+	X(vkGetPhysicalDeviceProperties2)                                                                                  \
+	X(vkGetPhysicalDeviceMemoryProperties)                                                                             \
+	X(vkGetPhysicalDeviceFormatProperties)                                                                             \
+	X(vkGetPhysicalDeviceQueueFamilyProperties)
+
+/*	Instance extension functions, nullptr if the extension is not enabled.	*/
+#define FVK_INSTANCE_EXTENSION_FUNCTIONS(X)                                                                            \
+	X(vkCreateDebugUtilsMessengerEXT)                                                                                  \
+	X(vkDestroyDebugUtilsMessengerEXT)                                                                                 \
+	X(vkSetDebugUtilsObjectNameEXT)                                                                                    \
+	X(vkSetDebugUtilsObjectTagEXT)                                                                                     \
+	X(vkCmdBeginDebugUtilsLabelEXT)                                                                                    \
+	X(vkCmdEndDebugUtilsLabelEXT)                                                                                      \
+	X(vkCmdInsertDebugUtilsLabelEXT)                                                                                   \
+	X(vkQueueBeginDebugUtilsLabelEXT)                                                                                  \
+	X(vkQueueEndDebugUtilsLabelEXT)                                                                                    \
+	X(vkQueueInsertDebugUtilsLabelEXT)
+
+/*	Device level functions of the submission and recording paths.	*/
+#define FVK_DEVICE_FUNCTIONS(X)                                                                                        \
+	X(vkQueueSubmit)                                                                                                   \
+	X(vkQueueWaitIdle)                                                                                                 \
+	X(vkCreateFence)                                                                                                   \
+	X(vkDestroyFence)                                                                                                  \
+	X(vkCreateSemaphore)                                                                                               \
+	X(vkDestroySemaphore)                                                                                              \
+	X(vkAllocateCommandBuffers)                                                                                        \
+	X(vkFreeCommandBuffers)                                                                                            \
+	X(vkResetCommandPool)                                                                                              \
+	X(vkBeginCommandBuffer)                                                                                            \
+	X(vkEndCommandBuffer)                                                                                              \
+	X(vkResetCommandBuffer)                                                                                            \
+	X(vkWaitForFences)                                                                                                 \
+	X(vkResetFences)                                                                                                   \
+	X(vkGetFenceStatus)                                                                                                \
+	X(vkAllocateMemory)                                                                                                \
+	X(vkFreeMemory)                                                                                                    \
+	X(vkBindBufferMemory)                                                                                              \
+	X(vkBindImageMemory)                                                                                               \
+	X(vkCreateBuffer)                                                                                                  \
+	X(vkDestroyBuffer)                                                                                                 \
+	X(vkCreateImage)                                                                                                   \
+	X(vkDestroyImage)                                                                                                  \
+	X(vkGetBufferMemoryRequirements)                                                                                   \
+	X(vkGetImageMemoryRequirements)                                                                                    \
+	X(vkMapMemory)                                                                                                     \
+	X(vkUnmapMemory)                                                                                                   \
+	X(vkFlushMappedMemoryRanges)                                                                                       \
+	X(vkInvalidateMappedMemoryRanges)                                                                                  \
+	X(vkCmdPipelineBarrier)                                                                                            \
+	X(vkCmdBindPipeline)                                                                                               \
+	X(vkCmdBindDescriptorSets)                                                                                         \
+	X(vkCmdPushConstants)                                                                                              \
+	X(vkCmdDispatch)                                                                                                   \
+	X(vkCmdDispatchIndirect)                                                                                           \
+	X(vkCmdCopyBuffer)                                                                                                 \
+	X(vkCmdCopyBufferToImage)                                                                                          \
+	X(vkCmdFillBuffer)                                                                                                 \
+	X(vkCmdUpdateBuffer)                                                                                               \
+	X(vkCmdExecuteCommands)
+
+/*	Device extension or later core functions, nullptr if not available.	*/
+#define FVK_DEVICE_EXTENSION_FUNCTIONS(X)                                                                              \
+	X(vkQueuePresentKHR)                                                                                               \
+	X(vkAcquireNextImageKHR)                                                                                           \
+	X(vkWaitSemaphores)                                                                                                \
+	X(vkSignalSemaphore)                                                                                               \
+	X(vkGetSemaphoreCounterValue)                                                                                      \
+	X(vkGetMemoryFdKHR)                                                                                                \
+	X(vkGetMemoryFdPropertiesKHR)                                                                                      \
+	X(vkGetSemaphoreFdKHR)                                                                                             \
+	X(vkImportSemaphoreFdKHR)                                                                                          \
+	X(vkGetMemoryHostPointerPropertiesEXT)
+
+#define FVK_DISPATCH_MEMBER(name) PFN_##name name;
+
+/**
+ * @brief Instance function table, resolved once per instance through the linked loader's
+ * vkGetInstanceProcAddr, the same loader that created the instance.
+ */
+struct FVK_DECL_EXTERN VKInstanceDispatch {
+	FVK_INSTANCE_FUNCTIONS(FVK_DISPATCH_MEMBER)
+	FVK_INSTANCE_EXTENSION_FUNCTIONS(FVK_DISPATCH_MEMBER)
+
+	void load(VkInstance instance, PFN_vkGetInstanceProcAddr getInstanceProcAddr);
+};
+
+/**
+ * @brief Device function table pointing directly at the driver entry points, bypassing the
+ * loader trampoline that the exported vk* functions go through.
+ */
+struct FVK_DECL_EXTERN VKDeviceDispatch {
+	FVK_DEVICE_FUNCTIONS(FVK_DISPATCH_MEMBER)
+	FVK_DEVICE_EXTENSION_FUNCTIONS(FVK_DISPATCH_MEMBER)
+
+	void load(VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr);
+
+	/**
+	 * @brief Table of the linked loader exports, for use when no device table is at hand.
+	 * Extension functions are nullptr.
+	 *
+	 * @return const VKDeviceDispatch&
+	 */
+	static const VKDeviceDispatch &getGlobal() noexcept;
+};
+
+#endif
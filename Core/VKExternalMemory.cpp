@@ -0,0 +1,250 @@
+#include "VKExternalMemory.h"
+#include <cerrno>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+template <typename T> static T requireFunction(T function, const char *name) {
+	if (function == nullptr)
+		throw cxxexcept::RuntimeException("Failed to load {}, extension not enabled", name);
+	return function;
+}
+
+static VkBuffer createExternalBuffer(VKDevice &device, VkDeviceSize size, VkBufferUsageFlags usage,
+									 VkExternalMemoryHandleTypeFlagBits handleType) {
+	VkExternalMemoryBufferCreateInfo externalInfo = {};
+	externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+	externalInfo.handleTypes = handleType;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.pNext = &externalInfo;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkBuffer buffer;
+	VKS_VALIDATE(device.getDispatch().vkCreateBuffer(device.getHandle(), &bufferInfo, nullptr, &buffer));
+	return buffer;
+}
+
+/*	Allocate the dedicated memory of the buffer and bind it, the buffer is destroyed on failure.	*/
+static VkDeviceMemory allocateDedicated(VKDevice &device, VkBuffer buffer, VkMemoryPropertyFlags properties,
+										const VkMemoryRequirements &memRequirements, const void *pNext,
+										const VKCallSite &callSite) {
+	const VKDeviceDispatch &table = device.getDispatch();
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.pNext = pNext;
+	allocInfo.allocationSize = memRequirements.size;
+
+	const std::optional<uint32_t> typeIndex = device.findMemoryType(memRequirements.memoryTypeBits, properties);
+	if (!typeIndex) {
+		table.vkDestroyBuffer(device.getHandle(), buffer, nullptr);
+		throw cxxexcept::RuntimeException("Could not find valid memory index");
+	}
+	allocInfo.memoryTypeIndex = typeIndex.value();
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkResult result = table.vkAllocateMemory(device.getHandle(), &allocInfo, nullptr, &memory);
+	if (result == VK_SUCCESS) {
+		result = table.vkBindBufferMemory(device.getHandle(), buffer, memory, 0);
+		if (result != VK_SUCCESS)
+			table.vkFreeMemory(device.getHandle(), memory, nullptr);
+	}
+	if (result != VK_SUCCESS) {
+		table.vkDestroyBuffer(device.getHandle(), buffer, nullptr);
+		VKS_VALIDATE(result);
+	}
+
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, memRequirements.size, callSite);
+	VKResourceTracker::recordAllocation((uint64_t)memory, allocInfo.allocationSize, allocInfo.memoryTypeIndex,
+										device.getPhysicalDevice(0)->getMemoryProperties(), callSite);
+	return memory;
+}
+
+void VKExternalMemory::createExportableBuffer(VKDevice &device, VkDeviceSize size, VkBufferUsageFlags usage,
+											  VkMemoryPropertyFlags properties,
+											  VkExternalMemoryHandleTypeFlagBits handleType, VkBuffer &buffer,
+											  VkDeviceMemory &memory, const VKCallSite &callSite) {
+	buffer = createExternalBuffer(device, size, usage, handleType);
+
+	VkMemoryRequirements memRequirements;
+	device.getDispatch().vkGetBufferMemoryRequirements(device.getHandle(), buffer, &memRequirements);
+
+	/*	Dedicated, so the importer can bind the whole allocation to its buffer.	*/
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = {};
+	dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+	dedicatedInfo.buffer = buffer;
+
+	VkExportMemoryAllocateInfo exportInfo = {};
+	exportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+	exportInfo.pNext = &dedicatedInfo;
+	exportInfo.handleTypes = handleType;
+
+	memory = allocateDedicated(device, buffer, properties, memRequirements, &exportInfo, callSite);
+}
+
+int VKExternalMemory::exportMemory(VKDevice &device, VkDeviceMemory memory,
+								   VkExternalMemoryHandleTypeFlagBits handleType) {
+	PFN_vkGetMemoryFdKHR getMemoryFd = requireFunction(device.getDispatch().vkGetMemoryFdKHR, "vkGetMemoryFdKHR");
+
+	VkMemoryGetFdInfoKHR getFdInfo = {};
+	getFdInfo.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+	getFdInfo.memory = memory;
+	getFdInfo.handleType = handleType;
+
+	int fd;
+	VKS_VALIDATE(getMemoryFd(device.getHandle(), &getFdInfo, &fd));
+	return fd;
+}
+
+void VKExternalMemory::importBuffer(VKDevice &device, int fd, VkDeviceSize size, VkBufferUsageFlags usage,
+									VkMemoryPropertyFlags properties, VkExternalMemoryHandleTypeFlagBits handleType,
+									VkBuffer &buffer, VkDeviceMemory &memory, const VKCallSite &callSite) {
+	const VKDeviceDispatch &table = device.getDispatch();
+
+	/*	Opaque handles has to be imported with the memory type they were allocated with, which matches on
+		the same device and driver. Other handle types report the compatible memory types.	*/
+	uint32_t memoryTypeBits = UINT32_MAX;
+	if (handleType != VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT) {
+		PFN_vkGetMemoryFdPropertiesKHR getMemoryFdProperties =
+			requireFunction(table.vkGetMemoryFdPropertiesKHR, "vkGetMemoryFdPropertiesKHR");
+		VkMemoryFdPropertiesKHR fdProperties = {};
+		fdProperties.sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR;
+		VKS_VALIDATE(getMemoryFdProperties(device.getHandle(), handleType, fd, &fdProperties));
+		memoryTypeBits = fdProperties.memoryTypeBits;
+	}
+
+	buffer = createExternalBuffer(device, size, usage, handleType);
+
+	VkMemoryRequirements memRequirements;
+	table.vkGetBufferMemoryRequirements(device.getHandle(), buffer, &memRequirements);
+	memRequirements.memoryTypeBits &= memoryTypeBits;
+
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = {};
+	dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+	dedicatedInfo.buffer = buffer;
+
+	VkImportMemoryFdInfoKHR importInfo = {};
+	importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR;
+	importInfo.pNext = &dedicatedInfo;
+	importInfo.handleType = handleType;
+	importInfo.fd = fd;
+
+	memory = allocateDedicated(device, buffer, properties, memRequirements, &importInfo, callSite);
+}
+
+static VkSemaphore createSemaphore(VKDevice &device, bool timeline, const void *pNext) {
+	VkSemaphoreTypeCreateInfo typeInfo = {};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.pNext = pNext;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = timeline ? &typeInfo : pNext;
+
+	VkSemaphore semaphore;
+	VKS_VALIDATE(device.getDispatch().vkCreateSemaphore(device.getHandle(), &semaphoreInfo, nullptr, &semaphore));
+	return semaphore;
+}
+
+VkSemaphore VKExternalMemory::createExportableSemaphore(VKDevice &device, bool timeline) {
+	VkExportSemaphoreCreateInfo exportInfo = {};
+	exportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+	exportInfo.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+	return createSemaphore(device, timeline, &exportInfo);
+}
+
+int VKExternalMemory::exportSemaphore(VKDevice &device, VkSemaphore semaphore) {
+	PFN_vkGetSemaphoreFdKHR getSemaphoreFd =
+		requireFunction(device.getDispatch().vkGetSemaphoreFdKHR, "vkGetSemaphoreFdKHR");
+
+	VkSemaphoreGetFdInfoKHR getFdInfo = {};
+	getFdInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+	getFdInfo.semaphore = semaphore;
+	getFdInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	int fd;
+	VKS_VALIDATE(getSemaphoreFd(device.getHandle(), &getFdInfo, &fd));
+	return fd;
+}
+
+VkSemaphore VKExternalMemory::importSemaphore(VKDevice &device, int fd, bool timeline) {
+	PFN_vkImportSemaphoreFdKHR importSemaphoreFd =
+		requireFunction(device.getDispatch().vkImportSemaphoreFdKHR, "vkImportSemaphoreFdKHR");
+
+	VkSemaphore semaphore = createSemaphore(device, timeline, nullptr);
+
+	VkImportSemaphoreFdInfoKHR importInfo = {};
+	importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR;
+	importInfo.semaphore = semaphore;
+	importInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+	importInfo.fd = fd;
+
+	const VkResult result = importSemaphoreFd(device.getHandle(), &importInfo);
+	if (result != VK_SUCCESS) {
+		device.getDispatch().vkDestroySemaphore(device.getHandle(), semaphore, nullptr);
+		VKS_VALIDATE(result);
+	}
+	return semaphore;
+}
+
+#ifdef _WIN32
+void VKExternalMemory::sendFileDescriptor(int, int) {
+	throw cxxexcept::RuntimeException("File descriptor passing is not supported on Windows");
+}
+
+int VKExternalMemory::receiveFileDescriptor(int) {
+	throw cxxexcept::RuntimeException("File descriptor passing is not supported on Windows");
+}
+#else
+void VKExternalMemory::sendFileDescriptor(int socket, int fd) {
+	char data = 0;
+	struct iovec io = {&data, sizeof(data)};
+
+	char control[CMSG_SPACE(sizeof(int))] = {};
+	struct msghdr message = {};
+	message.msg_iov = &io;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	if (sendmsg(socket, &message, 0) < 0)
+		throw cxxexcept::RuntimeException("Failed to send file descriptor - {}", strerror(errno));
+}
+
+int VKExternalMemory::receiveFileDescriptor(int socket) {
+	char data;
+	struct iovec io = {&data, sizeof(data)};
+
+	char control[CMSG_SPACE(sizeof(int))] = {};
+	struct msghdr message = {};
+	message.msg_iov = &io;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	if (recvmsg(socket, &message, 0) <= 0)
+		throw cxxexcept::RuntimeException("Failed to receive file descriptor - {}", strerror(errno));
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+	if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+		throw cxxexcept::RuntimeException("No file descriptor received");
+
+	int fd;
+	std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	return fd;
+}
+#endif
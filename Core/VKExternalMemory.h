@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_EXTERNAL_MEMORY_H_
+#define _FVK_VK_EXTERNAL_MEMORY_H_ 1
+#include "VKDevice.h"
+#include "VKResourceTracker.h"
+
+/**
+ * @brief Share memory and semaphores between devices and processes through POSIX file descriptors.
+ * Requires the device extensions VK_KHR_external_memory_fd and VK_KHR_external_semaphore_fd,
+ * and VK_EXT_external_memory_dma_buf for dma-buf handles. Importing memory requires the
+ * exporting and importing devices to have the same deviceUUID.
+ */
+class FVK_DECL_EXTERN VKExternalMemory {
+  public:
+	/**
+	 * @brief Create a buffer with a dedicated allocation that can be exported.
+	 *
+	 * @param device
+	 * @param size
+	 * @param usage
+	 * @param properties
+	 * @param handleType VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT or VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT
+	 * @param buffer
+	 * @param memory
+	 * @param callSite recorded by VKResourceTracker, defaults to the caller.
+	 */
+	static void createExportableBuffer(VKDevice &device, VkDeviceSize size, VkBufferUsageFlags usage,
+									   VkMemoryPropertyFlags properties,
+									   VkExternalMemoryHandleTypeFlagBits handleType, VkBuffer &buffer,
+									   VkDeviceMemory &memory, const VKCallSite &callSite = VKCallSite::current());
+
+	/**
+	 * @brief Export the memory as a file descriptor, owned by the caller.
+	 *
+	 * @param device
+	 * @param memory
+	 * @param handleType
+	 * @return int
+	 */
+	static int exportMemory(VKDevice &device, VkDeviceMemory memory, VkExternalMemoryHandleTypeFlagBits handleType);
+
+	/**
+	 * @brief Import memory exported by exportMemory, bound to a new buffer.
+	 * The ownership of the file descriptor is transferred to Vulkan on success.
+	 *
+	 * @param device
+	 * @param fd
+	 * @param size size of the exported buffer.
+	 * @param usage
+	 * @param properties
+	 * @param handleType
+	 * @param buffer
+	 * @param memory
+	 * @param callSite recorded by VKResourceTracker, defaults to the caller.
+	 */
+	static void importBuffer(VKDevice &device, int fd, VkDeviceSize size, VkBufferUsageFlags usage,
+							 VkMemoryPropertyFlags properties, VkExternalMemoryHandleTypeFlagBits handleType,
+							 VkBuffer &buffer, VkDeviceMemory &memory,
+							 const VKCallSite &callSite = VKCallSite::current());
+
+	/**
+	 * @brief Create a semaphore that can be exported as an opaque file descriptor.
+	 *
+	 * @param device
+	 * @param timeline create a timeline semaphore, otherwise binary.
+	 * @return VkSemaphore
+	 */
+	static VkSemaphore createExportableSemaphore(VKDevice &device, bool timeline);
+
+	/**
+	 * @brief Export the semaphore as an opaque file descriptor, owned by the caller.
+	 */
+	static int exportSemaphore(VKDevice &device, VkSemaphore semaphore);
+
+	/**
+	 * @brief Create a semaphore importing the exported payload.
+	 * The ownership of the file descriptor is transferred to Vulkan on success.
+	 *
+	 * @param device
+	 * @param fd
+	 * @param timeline must match the type of the exported semaphore.
+	 * @return VkSemaphore
+	 */
+	static VkSemaphore importSemaphore(VKDevice &device, int fd, bool timeline);
+
+	/**
+	 * @brief Send a file descriptor over a unix domain socket.
+	 */
+	static void sendFileDescriptor(int socket, int fd);
+
+	/**
+	 * @brief Receive a file descriptor sent with sendFileDescriptor.
+	 */
+	static int receiveFileDescriptor(int socket);
+};
+
+#endif
@@ -1,6 +1,9 @@
 #include "VKHelper.h"
+#include "VKConvert.h"
 #include "VKUtil.h"
-
+#include "VkPhysicalDevice.h"
+#include <algorithm>
+#include <cstring>
 #include <vulkan/vulkan.h>
 
 std::optional<uint32_t> VKHelper::findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter,
@@ -22,7 +25,7 @@ std::optional<uint32_t> VKHelper::findMemoryType(const VkPhysicalDeviceMemoryPro
 
 void VKHelper::createBuffer(VkDevice device, VkDeviceSize size, const VkPhysicalDeviceMemoryProperties &memoryProperies,
 							VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
-							VkDeviceMemory &bufferMemory) {
+							VkDeviceMemory &bufferMemory, const VKCallSite &callSite) {
 
 	/**/
 	VkBufferCreateInfo bufferInfo = {};
@@ -53,12 +56,17 @@ void VKHelper::createBuffer(VkDevice device, VkDeviceSize size, const VkPhysical
 
 	/**/
 	VKS_VALIDATE(vkBindBufferMemory(device, buffer, bufferMemory, 0));
+
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, size, callSite);
+	VKResourceTracker::recordAllocation((uint64_t)bufferMemory, allocInfo.allocationSize, allocInfo.memoryTypeIndex,
+										memoryProperies, callSite);
 }
 
 void VKHelper::createImage(VkDevice device, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format,
 						   VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
 						   const VkPhysicalDeviceMemoryProperties &memProperties, VkImage &image,
-						   VkDeviceMemory &imageMemory, const VkAllocationCallbacks *pAllocator, const char *pNext) {
+						   VkDeviceMemory &imageMemory, const VkAllocationCallbacks *pAllocator, const char *pNext,
+						   const VKCallSite &callSite) {
 
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -96,10 +104,44 @@ void VKHelper::createImage(VkDevice device, uint32_t width, uint32_t height, uin
 	VKS_VALIDATE(vkAllocateMemory(device, &allocInfo, pAllocator, &imageMemory));
 
 	VKS_VALIDATE(vkBindImageMemory(device, image, imageMemory, 0));
+
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_IMAGE, (uint64_t)image, memRequirements.size, callSite);
+	VKResourceTracker::recordAllocation((uint64_t)imageMemory, allocInfo.allocationSize, allocInfo.memoryTypeIndex,
+										memProperties, callSite);
+}
+
+void VKHelper::stageImageCopy(VkDevice device, VkQueue queue, VkCommandPool commandPool,
+							  const VkPhysicalDeviceMemoryProperties &memProperties, VkImage image, VkFormat imageFormat,
+							  const void *pixels, VkFormat srcFormat, uint32_t width, uint32_t height,
+							  size_t srcRowPitch) {
+	if (!VKConvert::isConversionSupported(srcFormat, imageFormat))
+		throw cxxexcept::RuntimeException("Conversion from format {} to {} is not supported", srcFormat, imageFormat);
+
+	const VkDeviceSize stagingSize = static_cast<VkDeviceSize>(VKConvert::getFormatSize(imageFormat)) * width * height;
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	createBuffer(device, stagingSize, memProperties, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+				 stagingMemory);
+
+	/*	Convert straight into the staging memory, without an intermediate buffer.	*/
+	void *mapped;
+	VKS_VALIDATE(vkMapMemory(device, stagingMemory, 0, stagingSize, 0, &mapped));
+	VKConvert::convertImage(srcFormat, pixels, srcRowPitch, imageFormat, mapped, 0, width, height);
+	vkUnmapMemory(device, stagingMemory);
+
+	VkCommandBuffer cmd = beginSingleTimeCommands(device, commandPool);
+	transitionImageLayout(cmd, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	copyBufferToImageCmd(cmd, stagingBuffer, image, {width, height, 1});
+	transitionImageLayout(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	endSingleTimeCommands(device, queue, cmd, commandPool);
+
+	destroyBuffer(device, stagingBuffer, stagingMemory);
 }
 
 VkImageView VKHelper::createImageView(VkDevice device, VkImage image, VkImageViewType imageType, VkFormat format,
-									  VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
+									  VkImageAspectFlags aspectFlags, uint32_t mipLevels, const VKCallSite &callSite) {
 
 	/**/
 	VkImageViewCreateInfo viewInfo = {};
@@ -115,6 +157,7 @@ VkImageView VKHelper::createImageView(VkDevice device, VkImage image, VkImageVie
 
 	VkImageView imageView;
 	VKS_VALIDATE(vkCreateImageView(device, &viewInfo, nullptr, &imageView));
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)imageView, 0, callSite);
 
 	return imageView;
 }
@@ -122,7 +165,7 @@ VkImageView VKHelper::createImageView(VkDevice device, VkImage image, VkImageVie
 void VKHelper::createPipelineLayout(VkDevice device, VkPipelineLayout &pipelineLayout,
 									const std::vector<VkDescriptorSetLayout> &descLayouts,
 									const std::vector<VkPushConstantRange> &pushConstants,
-									const VkAllocationCallbacks *pAllocator, void *pNext) {
+									const VkAllocationCallbacks *pAllocator, void *pNext, const VKCallSite &callSite) {
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -133,6 +176,7 @@ void VKHelper::createPipelineLayout(VkDevice device, VkPipelineLayout &pipelineL
 	pipelineLayoutInfo.pPushConstantRanges = pushConstants.data();
 
 	VKS_VALIDATE(vkCreatePipelineLayout(device, &pipelineLayoutInfo, pAllocator, &pipelineLayout));
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)pipelineLayout, 0, callSite);
 }
 
 // bool VKHelper::isDeviceSuitable(VkPhysicalDevice device) {
@@ -163,71 +207,159 @@ void VKHelper::createPipelineLayout(VkDevice device, VkPipelineLayout &pipelineL
 // 		   deviceFeatures.geometryShader && deviceFeatures.samplerAnisotropy && displayCount > 0;
 // }
 
-// TODO add option filter of what device you want.
-void VKHelper::selectDefaultDevices(std::vector<VkPhysicalDevice> &devices,
-									std::vector<VkPhysicalDevice> &selectDevices, uint32_t device_type_filter) {
-	std::vector<VkPhysicalDevice> preliminaryDevices;
-	/*  Check for matching. */
-	// VK_KHR_device_group_creation
-	// VK_KHR_device_group_creation
-	/*	Check for the device with the best specs and can display.	*/
-
-	for (uint32_t i = 0; i < devices.size(); i++) {
-		const VkPhysicalDevice device = devices[i];
-		VkPhysicalDeviceProperties props = {};
-		vkGetPhysicalDeviceProperties(device, &props);
-
-		if ((props.deviceType & device_type_filter) == 0)
-			continue;
-
-		uint32_t nrDisplayProperties = 0;
-		VKS_VALIDATE(vkGetPhysicalDeviceDisplayPropertiesKHR(device, &nrDisplayProperties, nullptr));
-		// if (nrDisplayProperties <= 0)
-		// 	continue;
-
-		std::vector<VkDisplayPropertiesKHR> displayProperties(nrDisplayProperties);
-		VKS_VALIDATE(vkGetPhysicalDeviceDisplayPropertiesKHR(device, &nrDisplayProperties, displayProperties.data()));
-
-		/* Find all supported planes.	*/
-		uint32_t planeCount = 0;
-		VKS_VALIDATE(vkGetPhysicalDeviceDisplayPlanePropertiesKHR(device, &planeCount, nullptr));
-		// if (planeCount <= 0)
-		// 	continue;
-
-		for (uint32_t x = 0; x < displayProperties.size(); x++) {
-		}
+std::optional<float> VKHelper::scoreDevice(VkPhysicalDevice device, const DeviceSelectionPolicy &policy) {
+	VkPhysicalDeviceProperties props = {};
+	vkGetPhysicalDeviceProperties(device, &props);
+
+	/*	Filter by device type.	*/
+	if ((deviceTypeBit(props.deviceType) & policy.deviceTypeFilter) == DeviceTypeMask::None)
+		return {};
+
+	/*	All required features must be supported.	*/
+	VkPhysicalDeviceFeatures features = {};
+	vkGetPhysicalDeviceFeatures(device, &features);
+	const VkBool32 *required = reinterpret_cast<const VkBool32 *>(&policy.requiredFeatures);
+	const VkBool32 *supported = reinterpret_cast<const VkBool32 *>(&features);
+	for (size_t i = 0; i < sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32); i++) {
+		if (required[i] && !supported[i])
+			return {};
+	}
 
-		// Determine the type of the physical device
-		if (props.deviceType == VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-			preliminaryDevices.push_back(device);
-		} else if (props.deviceType == VkPhysicalDeviceType::VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) {
-			/*	TODO determine if it can draw and display.	*/
-			// preliminaryDevices.push_back(device);
-		} else {
-			/*	*/
+	/*	All required extensions must be supported.	*/
+	if (!policy.requiredExtensions.empty()) {
+		uint32_t nrExtensions = 0;
+		VKS_VALIDATE(vkEnumerateDeviceExtensionProperties(device, nullptr, &nrExtensions, nullptr));
+		std::vector<VkExtensionProperties> extensions(nrExtensions);
+		VKS_VALIDATE(vkEnumerateDeviceExtensionProperties(device, nullptr, &nrExtensions, extensions.data()));
+
+		for (const std::string &extension : policy.requiredExtensions) {
+			if (std::find_if(extensions.begin(), extensions.end(), [&extension](const VkExtensionProperties &prop) {
+					return std::strcmp(prop.extensionName, extension.c_str()) == 0;
+				}) == extensions.end())
+				return {};
 		}
 	}
 
-	for (uint32_t i = 0; i < preliminaryDevices.size(); i++) {
-		const VkPhysicalDevice device = devices[i];
-		// Determine the available device local memory.
-		VkPhysicalDeviceMemoryProperties memoryProps = {};
-		vkGetPhysicalDeviceMemoryProperties(device, &memoryProps);
-
-		VkMemoryHeap *heapsPointer = memoryProps.memoryHeaps;
-		std::vector<VkMemoryHeap> heaps =
-			std::vector<VkMemoryHeap>(heapsPointer, heapsPointer + memoryProps.memoryHeapCount);
-
-		for (uint32_t j = 0; j < heaps.size(); j++) {
-			VkMemoryHeap &heap = heaps[j];
-			if (heap.flags & VkMemoryHeapFlagBits::VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
-				selectDevices.push_back(device);
-				// Device local heap, should be size of total GPU VRAM.
-				// heap.size will be the size of VRAM in bytes. (bigger
-				// is better)
+	float score = policy.deviceTypeWeights[std::min<size_t>(props.deviceType, policy.deviceTypeWeights.size() - 1)];
+
+	/*	Total device local memory, each heap counted once.	*/
+	VkPhysicalDeviceMemoryProperties memoryProps = {};
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProps);
+	VkDeviceSize deviceLocalMemory = 0;
+	for (uint32_t i = 0; i < memoryProps.memoryHeapCount; i++) {
+		if (memoryProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			deviceLocalMemory += memoryProps.memoryHeaps[i].size;
+	}
+	score += policy.deviceLocalMemoryWeight * (static_cast<float>(deviceLocalMemory) / (1024.0f * 1024.0f * 1024.0f));
+
+	/*	Dedicated compute and transfer queue families allows async workloads.	*/
+	uint32_t nrQueueFamilies = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &nrQueueFamilies, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(nrQueueFamilies);
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &nrQueueFamilies, queueFamilies.data());
+
+	bool dedicatedCompute = false;
+	bool dedicatedTransfer = false;
+	for (const VkQueueFamilyProperties &family : queueFamilies) {
+		if ((family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			dedicatedCompute = true;
+		if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+			!(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			dedicatedTransfer = true;
+	}
+	if (dedicatedCompute)
+		score += policy.dedicatedComputeQueueWeight;
+	if (dedicatedTransfer)
+		score += policy.dedicatedTransferQueueWeight;
+
+	/*	Subgroup and driver properties requires Vulkan 1.1 and 1.2 respectively. The core
+		vkGetPhysicalDeviceProperties2 is only available if the instance was created with 1.1.	*/
+	if (policy.instanceApiVersion >= VK_API_VERSION_1_1 && props.apiVersion >= VK_API_VERSION_1_1) {
+		VkPhysicalDeviceDriverProperties driverProps = {};
+		driverProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES;
+
+		VkPhysicalDeviceSubgroupProperties subgroupProps = {};
+		subgroupProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+		if (props.apiVersion >= VK_API_VERSION_1_2)
+			subgroupProps.pNext = &driverProps;
+
+		VkPhysicalDeviceProperties2 props2 = {};
+		props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		props2.pNext = &subgroupProps;
+		vkGetPhysicalDeviceProperties2(device, &props2);
+
+		score += policy.subgroupSizeWeight * static_cast<float>(subgroupProps.subgroupSize);
+
+		if (props.apiVersion >= VK_API_VERSION_1_2) {
+			for (const std::pair<VkDriverId, float> &driverWeight : policy.driverWeights) {
+				if (driverWeight.first == driverProps.driverID)
+					score += driverWeight.second;
 			}
 		}
 	}
+
+	if (policy.customScore)
+		score = policy.customScore(device, score);
+
+	return score;
+}
+
+void VKHelper::selectDefaultDevices(const std::vector<VkPhysicalDevice> &devices,
+									std::vector<VkPhysicalDevice> &selectDevices,
+									const DeviceSelectionPolicy &policy) {
+	std::vector<std::pair<VkPhysicalDevice, float>> preliminaryDevices;
+	preliminaryDevices.reserve(devices.size());
+
+	/*	Score each device once.	*/
+	for (const VkPhysicalDevice device : devices) {
+		const std::optional<float> score = scoreDevice(device, policy);
+		if (score)
+			preliminaryDevices.emplace_back(device, score.value());
+	}
+
+	/*	Best device first, keep the enumeration order for equal scores.	*/
+	std::stable_sort(preliminaryDevices.begin(), preliminaryDevices.end(),
+					 [](const std::pair<VkPhysicalDevice, float> &a, const std::pair<VkPhysicalDevice, float> &b) {
+						 return a.second > b.second;
+					 });
+
+	for (const std::pair<VkPhysicalDevice, float> &device : preliminaryDevices) {
+		if (std::find(selectDevices.begin(), selectDevices.end(), device.first) == selectDevices.end())
+			selectDevices.push_back(device.first);
+	}
+}
+
+void VKHelper::selectDefaultDevices(const std::vector<VkPhysicalDevice> &devices,
+									std::vector<VkPhysicalDevice> &selectDevices, DeviceTypeMask device_type_filter) {
+	DeviceSelectionPolicy policy;
+	policy.deviceTypeFilter = device_type_filter;
+	selectDefaultDevices(devices, selectDevices, policy);
+}
+
+std::vector<std::shared_ptr<PhysicalDevice>>
+VKHelper::selectDefaultDevices(const std::vector<std::shared_ptr<PhysicalDevice>> &devices,
+							   const DeviceSelectionPolicy &policy) {
+	std::vector<VkPhysicalDevice> handles(devices.size());
+	for (size_t i = 0; i < devices.size(); i++)
+		handles[i] = devices[i]->getHandle();
+
+	DeviceSelectionPolicy instancePolicy = policy;
+	if (!devices.empty())
+		instancePolicy.instanceApiVersion = devices[0]->getInstance().getApiVersion();
+
+	std::vector<VkPhysicalDevice> selected;
+	selectDefaultDevices(handles, selected, instancePolicy);
+
+	/*	Map back the sorted handles to the physical device objects.	*/
+	std::vector<std::shared_ptr<PhysicalDevice>> selectDevices;
+	selectDevices.reserve(selected.size());
+	for (const VkPhysicalDevice handle : selected) {
+		auto it = std::find_if(devices.begin(), devices.end(), [handle](const std::shared_ptr<PhysicalDevice> &device) {
+			return device->getHandle() == handle;
+		});
+		selectDevices.push_back(*it);
+	}
+	return selectDevices;
 }
 
 VkSurfaceFormatKHR VKHelper::selectSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats,
@@ -333,3 +465,17 @@ VKHelper::SwapChainSupportDetails VKHelper::querySwapChainSupport(VkPhysicalDevi
 
 	return details;
 }
+
+VkSurfaceKHR VKHelper::createHeadlessSurface(VkInstance instance) {
+	PFN_vkCreateHeadlessSurfaceEXT pfnCreateHeadlessSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+		vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT"));
+	if (pfnCreateHeadlessSurface == nullptr)
+		throw cxxexcept::RuntimeException("Instance does not support: {}", VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+
+	VkHeadlessSurfaceCreateInfoEXT createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+	VkSurfaceKHR surface;
+	VKS_VALIDATE(pfnCreateHeadlessSurface(instance, &createInfo, nullptr, &surface));
+	return surface;
+}
@@ -21,15 +21,21 @@
  */
 #ifndef _FVK_VK_HELPER_H_
 #define _FVK_VK_HELPER_H_ 1
+#include "VKResourceTracker.h"
 #include "VKUtil.h"
+#include <algorithm>
 #include <array>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
+class PhysicalDevice;
+
 /**
  * @brief Helper functions.
  * Set of functions for common
@@ -160,7 +166,8 @@ class FVK_DECL_EXTERN VKHelper {
 	static void createMemory(VkDevice device, VkDeviceSize size, VkMemoryPropertyFlags properties,
 							 const VkMemoryRequirements &memRequirements,
 							 const VkPhysicalDeviceMemoryProperties &memoryProperies, VkDeviceMemory &deviceMemory,
-							 const VkAllocationCallbacks *pAllocator = nullptr, const char *pNext = nullptr) {
+							 const VkAllocationCallbacks *pAllocator = nullptr, const void *pNext = nullptr,
+							 const VKCallSite &callSite = VKCallSite::current()) {
 		/**/
 		VkMemoryAllocateInfo allocInfo = {};
 		allocInfo.pNext = pNext;
@@ -174,6 +181,8 @@ class FVK_DECL_EXTERN VKHelper {
 
 		/**/
 		VKS_VALIDATE(vkAllocateMemory(device, &allocInfo, pAllocator, &deviceMemory));
+		VKResourceTracker::recordAllocation((uint64_t)deviceMemory, size, allocInfo.memoryTypeIndex, memoryProperies,
+											callSite);
 	}
 
 	static VkFormat findSupportedFormat(VkPhysicalDevice physicalDevice, const std::vector<VkFormat> &candidates,
@@ -207,16 +216,18 @@ class FVK_DECL_EXTERN VKHelper {
 	 * @param properties
 	 * @param buffer
 	 * @param bufferMemory
+	 * @param callSite recorded by VKResourceTracker, defaults to the caller.
 	 */
 	static void createBuffer(VkDevice device, VkDeviceSize size,
 							 const VkPhysicalDeviceMemoryProperties &memoryProperies, VkBufferUsageFlags usage,
-							 VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory);
+							 VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory,
+							 const VKCallSite &callSite = VKCallSite::current());
 
 	static void createImage(VkDevice device, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format,
 							VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
 							const VkPhysicalDeviceMemoryProperties &memProperties, VkImage &image,
 							VkDeviceMemory &imageMemory, const VkAllocationCallbacks *pAllocator = nullptr,
-							const char *pNext = nullptr);
+							const char *pNext = nullptr, const VKCallSite &callSite = VKCallSite::current());
 
 	/**
 	 * @brief Create a Image View object
@@ -227,12 +238,22 @@ class FVK_DECL_EXTERN VKHelper {
 	 * @return VkImageView
 	 */
 	static VkImageView createImageView(VkDevice device, VkImage image, VkImageViewType imageType, VkFormat format,
-									   VkImageAspectFlags aspectFlags, uint32_t mipLevels);
+									   VkImageAspectFlags aspectFlags, uint32_t mipLevels,
+									   const VKCallSite &callSite = VKCallSite::current());
 
-	//	template<typename T>
-	// TOOD add more params.
+	/**
+	 * @brief Create a Sampler object, linear filtering with repeat.
+	 * Prefer VKSamplerCache, which shares samplers with equal description.
+	 * The caller has to enable samplerAnisotropy and clamp to maxSamplerAnisotropy, see
+	 * the overload taking the device features and limits.
+	 *
+	 * @param device
+	 * @param sampler
+	 * @param maxSamplerAnisotropy 1.0 disables anisotropic filtering.
+	 * @param pNext
+	 */
 	static void createSampler(VkDevice device, VkSampler &sampler, float maxSamplerAnisotropy = 1.0f,
-							  void *pNext = nullptr) {
+							  void *pNext = nullptr, const VKCallSite &callSite = VKCallSite::current()) {
 
 		VkSamplerCreateInfo samplerInfo{};
 		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -250,7 +271,7 @@ class FVK_DECL_EXTERN VKHelper {
 		/*	*/
 		samplerInfo.mipLodBias = 0;
 		/*	*/
-		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.anisotropyEnable = maxSamplerAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
 		samplerInfo.maxAnisotropy = maxSamplerAnisotropy;
 		/*	*/
 		samplerInfo.compareEnable = VK_FALSE;
@@ -262,7 +283,63 @@ class FVK_DECL_EXTERN VKHelper {
 		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 		samplerInfo.unnormalizedCoordinates = VK_FALSE;
 
-		VKS_VALIDATE(vkCreateSampler(device, &samplerInfo, nullptr, &sampler));
+		createSampler(device, sampler, samplerInfo, nullptr, callSite);
+	}
+
+	/**
+	 * @brief Create a Sampler object, linear filtering with repeat, with the anisotropy
+	 * limited to what the device supports.
+	 *
+	 * @param device
+	 * @param sampler
+	 * @param enabledFeatures features the device was created with, see VKDevice::getEnabledFeatures.
+	 * @param limits
+	 * @param maxSamplerAnisotropy disabled if samplerAnisotropy is not enabled.
+	 * @param pNext
+	 */
+	static void createSampler(VkDevice device, VkSampler &sampler, const VkPhysicalDeviceFeatures &enabledFeatures,
+							  const VkPhysicalDeviceLimits &limits, float maxSamplerAnisotropy = 1.0f,
+							  void *pNext = nullptr, const VKCallSite &callSite = VKCallSite::current()) {
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.anisotropyEnable = maxSamplerAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+		samplerInfo.maxAnisotropy = maxSamplerAnisotropy;
+		clampSamplerAnisotropy(samplerInfo, enabledFeatures, limits);
+
+		createSampler(device, sampler, samplerInfo.maxAnisotropy, pNext, callSite);
+	}
+
+	/**
+	 * @brief Disable the anisotropy if the samplerAnisotropy feature is not enabled,
+	 * otherwise clamp it to maxSamplerAnisotropy.
+	 *
+	 * @param samplerInfo
+	 * @param enabledFeatures
+	 * @param limits
+	 */
+	static void clampSamplerAnisotropy(VkSamplerCreateInfo &samplerInfo,
+									   const VkPhysicalDeviceFeatures &enabledFeatures,
+									   const VkPhysicalDeviceLimits &limits) noexcept {
+		if (!enabledFeatures.samplerAnisotropy || !samplerInfo.anisotropyEnable || samplerInfo.maxAnisotropy <= 1.0f) {
+			samplerInfo.anisotropyEnable = VK_FALSE;
+			samplerInfo.maxAnisotropy = 1.0f;
+		} else {
+			samplerInfo.maxAnisotropy = std::min(samplerInfo.maxAnisotropy, limits.maxSamplerAnisotropy);
+		}
+	}
+
+	/**
+	 * @brief Create a Sampler object from a full description.
+	 *
+	 * @param device
+	 * @param sampler
+	 * @param samplerInfo
+	 * @param pAllocator
+	 */
+	static void createSampler(VkDevice device, VkSampler &sampler, const VkSamplerCreateInfo &samplerInfo,
+							  const VkAllocationCallbacks *pAllocator = nullptr,
+							  const VKCallSite &callSite = VKCallSite::current()) {
+		VKS_VALIDATE(vkCreateSampler(device, &samplerInfo, pAllocator, &sampler));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_SAMPLER, (uint64_t)sampler, 0, callSite);
 	}
 
 	/**
@@ -274,7 +351,8 @@ class FVK_DECL_EXTERN VKHelper {
 	 */
 	static VkShaderModule createShaderModule(VkDevice device, const std::vector<char> &data,
 											 const VkAllocationCallbacks *pAllocator = nullptr,
-											 const char *pNext = nullptr) {
+											 const char *pNext = nullptr,
+											 const VKCallSite &callSite = VKCallSite::current()) {
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		createInfo.pNext = pNext;
@@ -284,10 +362,52 @@ class FVK_DECL_EXTERN VKHelper {
 
 		VkShaderModule shaderModule;
 		VKS_VALIDATE(vkCreateShaderModule(device, &createInfo, pAllocator, &shaderModule));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule, data.size(), callSite);
+
+		return shaderModule;
+	}
+
+	/**
+	 * @brief Create a Shader Module object directly from SPIR-V words, without any copy.
+	 *
+	 * @param device
+	 * @param code
+	 * @param codeSize size in bytes.
+	 * @return VkShaderModule
+	 */
+	static VkShaderModule createShaderModule(VkDevice device, const uint32_t *code, size_t codeSize,
+											 const VkAllocationCallbacks *pAllocator = nullptr,
+											 const void *pNext = nullptr,
+											 const VKCallSite &callSite = VKCallSite::current()) {
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.pNext = pNext;
+		createInfo.flags = 0;
+		createInfo.codeSize = codeSize;
+		createInfo.pCode = code;
+
+		VkShaderModule shaderModule;
+		VKS_VALIDATE(vkCreateShaderModule(device, &createInfo, pAllocator, &shaderModule));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule, codeSize, callSite);
 
 		return shaderModule;
 	}
 
+	/**
+	 * @brief Create a Shader Module object from an embedded SPIR-V array.
+	 *
+	 * @tparam n number of words.
+	 * @param device
+	 * @param code
+	 * @return VkShaderModule
+	 */
+	template <size_t n>
+	static VkShaderModule createShaderModule(VkDevice device, const uint32_t (&code)[n],
+											 const VkAllocationCallbacks *pAllocator = nullptr,
+											 const VKCallSite &callSite = VKCallSite::current()) {
+		return createShaderModule(device, code, n * sizeof(uint32_t), pAllocator, nullptr, callSite);
+	}
+
 	/**
 	 * @brief Create a Pipeline Layout object
 	 *
@@ -300,7 +420,8 @@ class FVK_DECL_EXTERN VKHelper {
 	static void createPipelineLayout(VkDevice device, VkPipelineLayout &pipelineLayout,
 									 const std::vector<VkDescriptorSetLayout> &descLayouts = {},
 									 const std::vector<VkPushConstantRange> &pushConstants = {},
-									 const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr);
+									 const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr,
+									 const VKCallSite &callSite = VKCallSite::current());
 
 	/**
 	 * @brief Create a Descriptor Set Layout object
@@ -315,12 +436,14 @@ class FVK_DECL_EXTERN VKHelper {
 	template <size_t n>
 	static void createDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout &descriptorSetLayout,
 										  const std::array<VkDescriptorSetLayoutBinding, n> &descitprSetLayoutBindings,
-										  const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr) {
+										  const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr,
+										  const VKCallSite &callSite = VKCallSite::current()) {
 
 		std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindingsV(descitprSetLayoutBindings.begin(),
 																			   descitprSetLayoutBindings.end());
 
-		createDescriptorSetLayout(device, descriptorSetLayout, descriptorSetLayoutBindingsV, pAllocator, pNext);
+		createDescriptorSetLayout(device, descriptorSetLayout, descriptorSetLayoutBindingsV, pAllocator, pNext,
+								  callSite);
 	}
 
 	/**
@@ -334,7 +457,8 @@ class FVK_DECL_EXTERN VKHelper {
 	 */
 	static void createDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout &descriptorSetLayout,
 										  const std::vector<VkDescriptorSetLayoutBinding> &descitprSetLayoutBindings,
-										  const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr) {
+										  const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr,
+										  const VKCallSite &callSite = VKCallSite::current()) {
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.pNext = pNext;
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -342,11 +466,13 @@ class FVK_DECL_EXTERN VKHelper {
 		layoutInfo.pBindings = descitprSetLayoutBindings.data();
 
 		VKS_VALIDATE(vkCreateDescriptorSetLayout(device, &layoutInfo, pAllocator, &descriptorSetLayout));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)descriptorSetLayout, 0,
+										callSite);
 	}
 
 	static VkDescriptorPool createDescPool(VkDevice device, const std::vector<VkDescriptorPoolSize> &poolSizes = {},
 										   uint32_t maxSets = 1, const VkAllocationCallbacks *pAllocator = nullptr,
-										   void *pNext = nullptr) {
+										   void *pNext = nullptr, const VKCallSite &callSite = VKCallSite::current()) {
 		VkDescriptorPool descPool;
 
 		VkDescriptorPoolCreateInfo poolInfo{};
@@ -357,13 +483,15 @@ class FVK_DECL_EXTERN VKHelper {
 		poolInfo.maxSets = maxSets;
 
 		VKS_VALIDATE(vkCreateDescriptorPool(device, &poolInfo, pAllocator, &descPool));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)descPool, 0, callSite);
 
 		return descPool;
 	}
 
 	static VkPipelineCache createPipelineCache(VkDevice device, int size, void *pdata,
 											   const VkAllocationCallbacks *pAllocator = nullptr,
-											   void *pNext = nullptr) {
+											   void *pNext = nullptr,
+											   const VKCallSite &callSite = VKCallSite::current()) {
 
 		VkPipelineCache pipelineCache;
 
@@ -375,6 +503,7 @@ class FVK_DECL_EXTERN VKHelper {
 		pipelineCacheInfo.flags = 0;
 
 		VKS_VALIDATE(vkCreatePipelineCache(device, &pipelineCacheInfo, pAllocator, &pipelineCache));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_PIPELINE_CACHE, (uint64_t)pipelineCache, size, callSite);
 
 		return pipelineCache;
 	}
@@ -386,7 +515,8 @@ class FVK_DECL_EXTERN VKHelper {
 											VkPipelineCache pipelineCache = VK_NULL_HANDLE,
 											VkPipeline basePipelineHandle = VK_NULL_HANDLE,
 											uint32_t basePipelineIndex = 0,
-											const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr) {
+											const VkAllocationCallbacks *pAllocator = nullptr, void *pNext = nullptr,
+											const VKCallSite &callSite = VKCallSite::current()) {
 
 		VkPipeline pipeline;
 		VkComputePipelineCreateInfo pipelineCreateInfo = {};
@@ -399,13 +529,163 @@ class FVK_DECL_EXTERN VKHelper {
 		pipelineCreateInfo.basePipelineIndex = basePipelineIndex;
 
 		VKS_VALIDATE(vkCreateComputePipelines(device, pipelineCache, 1, &pipelineCreateInfo, pAllocator, &pipeline));
+		VKResourceTracker::recordCreate(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, 0, callSite);
 
 		return pipeline;
 	}
 
+	/**
+	 * @brief Destroy functions matching the create functions, keeping VKResourceTracker in
+	 * balance. Null handles are ignored, as with the Vulkan destroy functions.
+	 */
+	static void destroyBuffer(VkDevice device, VkBuffer buffer, VkDeviceMemory bufferMemory,
+							  const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer);
+		vkDestroyBuffer(device, buffer, pAllocator);
+		freeMemory(device, bufferMemory, pAllocator);
+	}
+
+	static void destroyImage(VkDevice device, VkImage image, VkDeviceMemory imageMemory,
+							 const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_IMAGE, (uint64_t)image);
+		vkDestroyImage(device, image, pAllocator);
+		freeMemory(device, imageMemory, pAllocator);
+	}
+
+	static void freeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory);
+		vkFreeMemory(device, memory, pAllocator);
+	}
+
+	static void destroyImageView(VkDevice device, VkImageView imageView,
+								 const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)imageView);
+		vkDestroyImageView(device, imageView, pAllocator);
+	}
+
+	static void destroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_SAMPLER, (uint64_t)sampler);
+		vkDestroySampler(device, sampler, pAllocator);
+	}
+
+	static void destroyShaderModule(VkDevice device, VkShaderModule shaderModule,
+									const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule);
+		vkDestroyShaderModule(device, shaderModule, pAllocator);
+	}
+
+	static void destroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout,
+									  const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)pipelineLayout);
+		vkDestroyPipelineLayout(device, pipelineLayout, pAllocator);
+	}
+
+	static void destroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout,
+										   const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)descriptorSetLayout);
+		vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+	}
+
+	static void destroyDescPool(VkDevice device, VkDescriptorPool descPool,
+								const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)descPool);
+		vkDestroyDescriptorPool(device, descPool, pAllocator);
+	}
+
+	static void destroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache,
+									 const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_PIPELINE_CACHE, (uint64_t)pipelineCache);
+		vkDestroyPipelineCache(device, pipelineCache, pAllocator);
+	}
+
+	static void destroyPipeline(VkDevice device, VkPipeline pipeline,
+								const VkAllocationCallbacks *pAllocator = nullptr) {
+		VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline);
+		vkDestroyPipeline(device, pipeline, pAllocator);
+	}
+
 	//
 	// static bool isDeviceSuitable(VkPhysicalDevice device);
 
+	/**
+	 * @brief Mask of device types, one bit per VkPhysicalDeviceType. A distinct type so that masks
+	 * of raw VkPhysicalDeviceType values, as taken by selectDefaultDevices before, do not compile.
+	 */
+	enum class DeviceTypeMask : uint32_t { None = 0 };
+
+	friend constexpr DeviceTypeMask operator|(DeviceTypeMask a, DeviceTypeMask b) noexcept {
+		return static_cast<DeviceTypeMask>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+	}
+	friend constexpr DeviceTypeMask operator&(DeviceTypeMask a, DeviceTypeMask b) noexcept {
+		return static_cast<DeviceTypeMask>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+	}
+
+	/**
+	 * @brief Convert a VkPhysicalDeviceType into its bit in a DeviceTypeMask.
+	 */
+	static constexpr DeviceTypeMask deviceTypeBit(VkPhysicalDeviceType type) noexcept {
+		return static_cast<DeviceTypeMask>(1u << static_cast<uint32_t>(type));
+	}
+
+	/**
+	 * @brief Weighting policy used for ranking physical devices.
+	 * Each property of the device contributes its value multiplied with
+	 * the associated weight to the final score. A device that is filtered
+	 * out by type or is missing a required feature/extension is rejected.
+	 */
+	struct DeviceSelectionPolicy {
+		/*	Device types that are allowed.	*/
+		DeviceTypeMask deviceTypeFilter = deviceTypeBit(VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) |
+										  deviceTypeBit(VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU);
+
+		/*	Score per device type, indexed by VkPhysicalDeviceType. An order of magnitude apart and above
+			what the other properties add up to in practice, so the device type always dominates.	*/
+		std::array<float, VK_PHYSICAL_DEVICE_TYPE_CPU + 1> deviceTypeWeights = {0.0f, 100000.0f, 1000000.0f,
+																				 10000.0f, 1000.0f};
+
+		/*	Score per GiB of total device local heap memory.	*/
+		float deviceLocalMemoryWeight = 100.0f;
+		/*	Score for having a compute queue family without graphic.	*/
+		float dedicatedComputeQueueWeight = 200.0f;
+		/*	Score for having a transfer queue family without graphic and compute.	*/
+		float dedicatedTransferQueueWeight = 100.0f;
+		/*	Score per subgroup invocation.	*/
+		float subgroupSizeWeight = 2.0f;
+
+		/*	Additional score for specific drivers.	*/
+		std::vector<std::pair<VkDriverId, float>> driverWeights;
+
+		/*	Features that every selected device must support, VK_TRUE means required.	*/
+		VkPhysicalDeviceFeatures requiredFeatures = {};
+		std::vector<std::string> requiredExtensions;
+
+		/*	Optional user override, receives the computed score and returns the final score.	*/
+		std::function<float(VkPhysicalDevice device, float score)> customScore;
+
+		/*	API version the instance was created with, gates the vkGetPhysicalDeviceProperties2 queries.	*/
+		uint32_t instanceApiVersion = VK_API_VERSION_1_0;
+	};
+
+	/**
+	 * @brief Compute the score of a device based on the policy.
+	 *
+	 * @param device
+	 * @param policy
+	 * @return std::optional<float> no value if the device is rejected by the policy.
+	 */
+	static std::optional<float> scoreDevice(VkPhysicalDevice device, const DeviceSelectionPolicy &policy);
+
+	/**
+	 * @brief Select all devices accepted by the policy, sorted with the highest score first.
+	 *
+	 * @param devices
+	 * @param selectDevices
+	 * @param policy
+	 */
+	static void selectDefaultDevices(const std::vector<VkPhysicalDevice> &devices,
+									 std::vector<VkPhysicalDevice> &selectDevices,
+									 const DeviceSelectionPolicy &policy);
+
 	/**
 	 * @brief
 	 *
@@ -413,10 +693,23 @@ class FVK_DECL_EXTERN VKHelper {
 	 * @param selectDevices
 	 * @param device_type_filter
 	 */
-	static void selectDefaultDevices(std::vector<VkPhysicalDevice> &devices,
+	static void selectDefaultDevices(const std::vector<VkPhysicalDevice> &devices,
 									 std::vector<VkPhysicalDevice> &selectDevices,
-									 uint32_t device_type_filter = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU |
-																   VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU);
+									 DeviceTypeMask device_type_filter =
+										 deviceTypeBit(VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) |
+										 deviceTypeBit(VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU));
+
+	/**
+	 * @brief Select all physical devices accepted by the policy, sorted with the highest score first.
+	 * The instance API version of the policy is taken from the devices' instance.
+	 *
+	 * @param devices
+	 * @param policy
+	 * @return std::vector<std::shared_ptr<PhysicalDevice>>
+	 */
+	static std::vector<std::shared_ptr<PhysicalDevice>>
+	selectDefaultDevices(const std::vector<std::shared_ptr<PhysicalDevice>> &devices,
+						 const DeviceSelectionPolicy &policy = {});
 
 	// TODO improve to accomudate the configurations.
 	/**
@@ -517,6 +810,28 @@ class FVK_DECL_EXTERN VKHelper {
 		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 	}
 
+	/**
+	 * @brief Upload pixels to a 2D image, converting them from the source format to the image format
+	 * directly into the mapped staging memory, see VKConvert. Leaves the image in the
+	 * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL layout.
+	 *
+	 * @param device
+	 * @param queue
+	 * @param commandPool
+	 * @param memProperties
+	 * @param image image created with VK_IMAGE_USAGE_TRANSFER_DST_BIT and undefined layout.
+	 * @param imageFormat format the image was created with.
+	 * @param pixels
+	 * @param srcFormat format of the pixels.
+	 * @param width
+	 * @param height
+	 * @param srcRowPitch 0 for tightly packed.
+	 */
+	static void stageImageCopy(VkDevice device, VkQueue queue, VkCommandPool commandPool,
+							   const VkPhysicalDeviceMemoryProperties &memProperties, VkImage image,
+							   VkFormat imageFormat, const void *pixels, VkFormat srcFormat, uint32_t width,
+							   uint32_t height, size_t srcRowPitch = 0);
+
 	// static void stageBufferCmdCopy(VkDevice device, VkQueue queue, VkCommandBuffer cmd, VkBuffer src, VkBuffer dst,
 	// 							   VkDeviceSize size) {
 
@@ -596,6 +911,14 @@ class FVK_DECL_EXTERN VKHelper {
 	}
 
 	static VkSurfaceKHR createSurface([[maybe_unused]] VkInstance instance) { return VK_NULL_HANDLE; }
+
+	/**
+	 * @brief Create a surface without any window system, requires VK_EXT_headless_surface.
+	 *
+	 * @param instance
+	 * @return VkSurfaceKHR
+	 */
+	static VkSurfaceKHR createHeadlessSurface(VkInstance instance);
 };
 
 #endif
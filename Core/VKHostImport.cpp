@@ -0,0 +1,117 @@
+#include "VKHostImport.h"
+#include <cstring>
+
+bool VKHostImport::isSupported(const VKDevice &device) {
+	/*	The device table may resolve commands of extensions that are not enabled.	*/
+	return device.isExtensionEnabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+}
+
+VkDeviceSize VKHostImport::getImportAlignment(const VKDevice &device) {
+	if (!isSupported(device))
+		return 0;
+	VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProperties = {};
+	device.getPhysicalDevice(0)->getProperties(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT,
+											   hostProperties);
+	return hostProperties.minImportedHostPointerAlignment;
+}
+
+bool VKHostImport::importBuffer(VKDevice &device, void *hostPointer, VkDeviceSize size, VkBufferUsageFlags usage,
+								VkBuffer &buffer, VkDeviceMemory &memory, const VKCallSite &callSite) {
+	const VkDeviceSize alignment = getImportAlignment(device);
+	if (alignment == 0 || size == 0 || reinterpret_cast<uintptr_t>(hostPointer) % alignment != 0 ||
+		size % alignment != 0)
+		return false;
+
+	const VKDeviceDispatch &table = device.getDispatch();
+	if (table.vkGetMemoryHostPointerPropertiesEXT == nullptr)
+		return false;
+
+	const VkExternalMemoryHandleTypeFlagBits handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+	VkMemoryHostPointerPropertiesEXT pointerProperties = {};
+	pointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+	if (table.vkGetMemoryHostPointerPropertiesEXT(device.getHandle(), handleType, hostPointer, &pointerProperties) !=
+		VK_SUCCESS)
+		return false;
+
+	VkExternalMemoryBufferCreateInfo externalInfo = {};
+	externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+	externalInfo.handleTypes = handleType;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.pNext = &externalInfo;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	VKS_VALIDATE(table.vkCreateBuffer(device.getHandle(), &bufferInfo, nullptr, &buffer));
+
+	VkMemoryRequirements memRequirements;
+	table.vkGetBufferMemoryRequirements(device.getHandle(), buffer, &memRequirements);
+	memRequirements.memoryTypeBits &= pointerProperties.memoryTypeBits;
+
+	const std::optional<uint32_t> typeIndex = VKHelper::findMemoryType(
+		device.getPhysicalDevice(0)->getMemoryProperties(), memRequirements.memoryTypeBits, 0);
+	if (!typeIndex || memRequirements.size > size) {
+		table.vkDestroyBuffer(device.getHandle(), buffer, nullptr);
+		return false;
+	}
+
+	VkImportMemoryHostPointerInfoEXT importInfo = {};
+	importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+	importInfo.handleType = handleType;
+	importInfo.pHostPointer = hostPointer;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.pNext = &importInfo;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = typeIndex.value();
+
+	if (table.vkAllocateMemory(device.getHandle(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		table.vkDestroyBuffer(device.getHandle(), buffer, nullptr);
+		return false;
+	}
+
+	const VkResult result = table.vkBindBufferMemory(device.getHandle(), buffer, memory, 0);
+	if (result != VK_SUCCESS) {
+		table.vkDestroyBuffer(device.getHandle(), buffer, nullptr);
+		table.vkFreeMemory(device.getHandle(), memory, nullptr);
+		VKS_VALIDATE(result);
+	}
+
+	VKResourceTracker::recordCreate(VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, size, callSite);
+	VKResourceTracker::recordAllocation((uint64_t)memory, allocInfo.allocationSize, allocInfo.memoryTypeIndex,
+										device.getPhysicalDevice(0)->getMemoryProperties(), callSite);
+	return true;
+}
+
+bool VKHostImport::uploadBuffer(VKDevice &device, VkQueue queue, VkCommandPool commandPool, const void *data,
+								VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset) {
+	VkBuffer srcBuffer;
+	VkDeviceMemory srcMemory;
+
+	/*	The imported memory is only read by the transfer.	*/
+	const bool imported = importBuffer(device, const_cast<void *>(data), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+									   srcBuffer, srcMemory);
+	if (!imported) {
+		VKHelper::createBuffer(device.getHandle(), size, device.getPhysicalDevice(0)->getMemoryProperties(),
+							   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, srcBuffer,
+							   srcMemory);
+		void *mapped;
+		VKS_VALIDATE(device.getDispatch().vkMapMemory(device.getHandle(), srcMemory, 0, size, 0, &mapped));
+		std::memcpy(mapped, data, size);
+		device.getDispatch().vkUnmapMemory(device.getHandle(), srcMemory);
+	}
+
+	VkCommandBuffer cmd = device.beginSingleTimeCommand(commandPool);
+	VkBufferCopy region = {};
+	region.srcOffset = 0;
+	region.dstOffset = dstOffset;
+	region.size = size;
+	device.getDispatch().vkCmdCopyBuffer(cmd, srcBuffer, dst, 1, &region);
+	device.endSingleTimeCommands(queue, cmd, commandPool);
+
+	VKHelper::destroyBuffer(device.getHandle(), srcBuffer, srcMemory);
+	return imported;
+}
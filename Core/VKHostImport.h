@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_HOST_IMPORT_H_
+#define _FVK_VK_HOST_IMPORT_H_ 1
+#include "VKDevice.h"
+#include "VKResourceTracker.h"
+
+/**
+ * @brief Wrap application memory as a VkBuffer with VK_EXT_external_memory_host, so the device
+ * reads it directly instead of from a staging copy. Both the pointer and the size have to be
+ * aligned to minImportedHostPointerAlignment, see getImportAlignment.
+ */
+class FVK_DECL_EXTERN VKHostImport {
+  public:
+	/**
+	 * @brief Check if VK_EXT_external_memory_host is enabled on the device.
+	 */
+	static bool isSupported(const VKDevice &device);
+
+	/**
+	 * @brief Get the required alignment of imported pointers and sizes, 0 if not supported.
+	 */
+	static VkDeviceSize getImportAlignment(const VKDevice &device);
+
+	/**
+	 * @brief Import the host memory as a buffer.
+	 * The memory must outlive the buffer and memory objects, and must not be freed while in use
+	 * by the device.
+	 *
+	 * @param device
+	 * @param hostPointer
+	 * @param size
+	 * @param usage
+	 * @param buffer
+	 * @param memory
+	 * @param callSite recorded by VKResourceTracker, defaults to the caller.
+	 * @return true if imported, false if not supported or not aligned.
+	 */
+	static bool importBuffer(VKDevice &device, void *hostPointer, VkDeviceSize size, VkBufferUsageFlags usage,
+							 VkBuffer &buffer, VkDeviceMemory &memory,
+							 const VKCallSite &callSite = VKCallSite::current());
+
+	/**
+	 * @brief Copy host data into the buffer, reading directly from the host memory if it can be
+	 * imported and falling back to a staging copy otherwise. Waits for the copy to complete.
+	 *
+	 * @param device
+	 * @param queue
+	 * @param commandPool
+	 * @param data
+	 * @param size
+	 * @param dst buffer created with VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+	 * @param dstOffset
+	 * @return true if the host memory was imported, false if staged.
+	 */
+	static bool uploadBuffer(VKDevice &device, VkQueue queue, VkCommandPool commandPool, const void *data,
+							 VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset = 0);
+};
+
+#endif
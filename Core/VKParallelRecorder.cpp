@@ -0,0 +1,85 @@
+#include "VKParallelRecorder.h"
+#include <algorithm>
+
+VKParallelRecorder::VKParallelRecorder(const std::shared_ptr<VKDevice> &device, uint32_t queueFamilyIndex,
+									   unsigned int nrFramesInFlight, unsigned int nrThreads)
+	: device(device), threadPool(nrThreads), frameIndex(0) {
+
+	this->framePools.resize(std::max(1u, nrFramesInFlight));
+	for (auto &pools : this->framePools) {
+		pools.resize(this->threadPool.getNrThreads());
+		for (WorkerPool &pool : pools) {
+			/*	Buffers are reset together with the pool.	*/
+			pool.commandPool = device->createCommandPool(queueFamilyIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			pool.nrUsed = 0;
+		}
+	}
+}
+
+VKParallelRecorder::~VKParallelRecorder() {
+	for (auto &pools : this->framePools) {
+		for (WorkerPool &pool : pools) {
+			vkDestroyCommandPool(this->device->getHandle(), pool.commandPool, nullptr);
+		}
+	}
+}
+
+VkCommandBuffer VKParallelRecorder::acquireCommandBuffer(WorkerPool &pool) {
+	if (pool.nrUsed == pool.cmds.size()) {
+		pool.cmds.push_back(
+			this->device->allocateCommandBuffer(pool.commandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+	}
+	return pool.cmds[pool.nrUsed++];
+}
+
+void VKParallelRecorder::nextFrame(VkFence fence) {
+	const VKDeviceDispatch &dispatch = this->device->getDispatch();
+	if (fence != VK_NULL_HANDLE)
+		VKS_VALIDATE(dispatch.vkWaitForFences(this->device->getHandle(), 1, &fence, VK_TRUE, UINT64_MAX));
+
+	this->frameIndex = (this->frameIndex + 1) % this->framePools.size();
+	for (WorkerPool &pool : this->framePools[this->frameIndex]) {
+		if (pool.nrUsed > 0) {
+			VKS_VALIDATE(dispatch.vkResetCommandPool(this->device->getHandle(), pool.commandPool, 0));
+			pool.nrUsed = 0;
+		}
+	}
+}
+
+void VKParallelRecorder::record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo &inheritance,
+								uint32_t nrItems, uint32_t itemsPerChunk, const RecordCallback &record) {
+	if (nrItems == 0)
+		return;
+	if (itemsPerChunk == 0)
+		throw cxxexcept::RuntimeException("Items per chunk must be greater than 0");
+
+	/*	Command buffers of earlier calls in the frame are kept, they may be pending execution.	*/
+	std::vector<WorkerPool> &pools = this->framePools[this->frameIndex];
+
+	const uint32_t nrChunks = (nrItems + itemsPerChunk - 1) / itemsPerChunk;
+	this->chunkCmds.resize(nrChunks);
+
+	VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (inheritance.renderPass != VK_NULL_HANDLE)
+		usage |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+	this->threadPool.parallelFor(nrChunks, [&](unsigned int chunk, unsigned int workerIndex) {
+		/*	A worker only accesses its own command pool.	*/
+		FVK_EXTERNAL_SYNC_SCOPE(pools[workerIndex].commandPool);
+		VkCommandBuffer cmd = this->acquireCommandBuffer(pools[workerIndex]);
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = usage;
+		beginInfo.pInheritanceInfo = &inheritance;
+		VKS_VALIDATE(vkBeginCommandBuffer(cmd, &beginInfo));
+
+		const uint32_t first = chunk * itemsPerChunk;
+		record(cmd, first, std::min(itemsPerChunk, nrItems - first));
+
+		VKS_VALIDATE(vkEndCommandBuffer(cmd));
+		this->chunkCmds[chunk] = cmd;
+	});
+
+	vkCmdExecuteCommands(primary, this->chunkCmds.size(), this->chunkCmds.data());
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_PARALLEL_RECORDER_H_
+#define _FVK_VK_PARALLEL_RECORDER_H_ 1
+#include "VKDevice.h"
+#include "VKThreadPool.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Record secondary command buffers in parallel and execute them from a primary command buffer.
+ * The workload is split into chunks that are recorded on a work-stealing thread pool, each worker
+ * with its own command pool. The secondary command buffers are executed in chunk order, so the
+ * result is deterministic regardless of which thread recorded which chunk.
+ *
+ * Command pools are kept per frame in flight. Any number of record calls can be made within a
+ * frame, nextFrame advances to the next frame and resets the pools used by frame
+ * n - nrFramesInFlight, which must have finished executing on the device.
+ */
+class FVK_DECL_EXTERN VKParallelRecorder {
+  public:
+	/**
+	 * @brief Record the items [first, first + count) of a chunk.
+	 */
+	using RecordCallback = std::function<void(VkCommandBuffer cmd, uint32_t first, uint32_t count)>;
+
+	/**
+	 * @brief Construct a new VKParallelRecorder object
+	 *
+	 * @param device
+	 * @param queueFamilyIndex queue family the primary command buffer is submitted to.
+	 * @param nrFramesInFlight
+	 * @param nrThreads number of recording threads, 0 uses the number of hardware threads.
+	 */
+	VKParallelRecorder(const std::shared_ptr<VKDevice> &device, uint32_t queueFamilyIndex,
+					   unsigned int nrFramesInFlight = 2, unsigned int nrThreads = 0);
+	VKParallelRecorder(const VKParallelRecorder &) = delete;
+	VKParallelRecorder(VKParallelRecorder &&) = delete;
+	~VKParallelRecorder();
+
+	/**
+	 * @brief Advance to the next frame and reset its command pools.
+	 *
+	 * @param fence signaled once the frame that last used the pools has completed, waited on
+	 * before the reset. VK_NULL_HANDLE if the caller already knows it has completed.
+	 */
+	void nextFrame(VkFence fence = VK_NULL_HANDLE);
+
+	/**
+	 * @brief Record nrItems split in chunks of itemsPerChunk into secondary command buffers of the
+	 * current frame and execute them in order from the primary command buffer.
+	 *
+	 * @param primary primary command buffer in the recording state. If the inheritance info has a
+	 * render pass, the primary must be inside that subpass begun with
+	 * VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+	 * @param inheritance
+	 * @param nrItems
+	 * @param itemsPerChunk
+	 * @param record
+	 */
+	void record(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo &inheritance, uint32_t nrItems,
+				uint32_t itemsPerChunk, const RecordCallback &record);
+
+	unsigned int getNrThreads() const noexcept { return this->threadPool.getNrThreads(); }
+	unsigned int getFrameIndex() const noexcept { return this->frameIndex; }
+
+  private:
+	struct WorkerPool {
+		VkCommandPool commandPool;
+		std::vector<VkCommandBuffer> cmds;
+		uint32_t nrUsed;
+	};
+
+	VkCommandBuffer acquireCommandBuffer(WorkerPool &pool);
+
+	std::shared_ptr<VKDevice> device;
+	VKThreadPool threadPool;
+	/*	Command pools indexed by [frame][worker].	*/
+	std::vector<std::vector<WorkerPool>> framePools;
+	unsigned int frameIndex;
+	std::vector<VkCommandBuffer> chunkCmds;
+};
+
+#endif
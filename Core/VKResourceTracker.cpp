@@ -0,0 +1,191 @@
+#include "VKResourceTracker.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+std::atomic<bool> VKResourceTracker::enabled(false);
+std::atomic<uint64_t> VKResourceTracker::nrLiveObjects(0);
+
+namespace {
+	struct HandleKey {
+		VkObjectType type;
+		uint64_t handle;
+		bool operator==(const HandleKey &other) const noexcept {
+			return this->type == other.type && this->handle == other.handle;
+		}
+	};
+
+	struct HandleKeyHash {
+		size_t operator()(const HandleKey &key) const noexcept {
+			return std::hash<uint64_t>()(key.handle) ^ (static_cast<size_t>(key.type) << 1);
+		}
+	};
+
+	std::mutex trackerLock;
+	std::unordered_map<HandleKey, VKResourceTracker::Record, HandleKeyHash> trackerRecords;
+	uint64_t trackerSequence = 0;
+	std::atomic<VkDeviceSize> heapLiveBytes[VK_MAX_MEMORY_HEAPS];
+	std::once_flag reportAtExitFlag;
+
+	const char *getObjectTypeName(VkObjectType type) noexcept {
+		switch (type) {
+		case VK_OBJECT_TYPE_DEVICE_MEMORY:
+			return "DeviceMemory";
+		case VK_OBJECT_TYPE_BUFFER:
+			return "Buffer";
+		case VK_OBJECT_TYPE_IMAGE:
+			return "Image";
+		case VK_OBJECT_TYPE_IMAGE_VIEW:
+			return "ImageView";
+		case VK_OBJECT_TYPE_SAMPLER:
+			return "Sampler";
+		case VK_OBJECT_TYPE_SHADER_MODULE:
+			return "ShaderModule";
+		case VK_OBJECT_TYPE_PIPELINE_CACHE:
+			return "PipelineCache";
+		case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+			return "PipelineLayout";
+		case VK_OBJECT_TYPE_PIPELINE:
+			return "Pipeline";
+		case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+			return "DescriptorSetLayout";
+		case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+			return "DescriptorPool";
+		default:
+			return "Object";
+		}
+	}
+
+	void reportAtExit() {
+		if (VKResourceTracker::getNrLiveObjects() > 0)
+			VKResourceTracker::report(stderr);
+	}
+} // namespace
+
+void VKResourceTracker::setEnabled(bool enable, bool reportAtExit) {
+	if (reportAtExit)
+		std::call_once(reportAtExitFlag, []() { std::atexit(::reportAtExit); });
+	enabled.store(enable, std::memory_order_relaxed);
+}
+
+void VKResourceTracker::add(VkObjectType type, uint64_t handle, VkDeviceSize size, const VKCallSite &callSite,
+							uint32_t memoryTypeIndex, uint32_t heapIndex) {
+	if (heapIndex < VK_MAX_MEMORY_HEAPS)
+		heapLiveBytes[heapIndex].fetch_add(size, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> guard(trackerLock);
+	auto result = trackerRecords.try_emplace({type, handle});
+	Record &record = result.first->second;
+	if (result.second) {
+		nrLiveObjects.fetch_add(1, std::memory_order_relaxed);
+	} else if (record.heapIndex < VK_MAX_MEMORY_HEAPS) {
+		/*	The handle was reused after being destroyed without a record.	*/
+		heapLiveBytes[record.heapIndex].fetch_sub(record.size, std::memory_order_relaxed);
+	}
+	record = {type, handle, size, memoryTypeIndex, heapIndex, callSite, ++trackerSequence};
+}
+
+void VKResourceTracker::remove(VkObjectType type, uint64_t handle) {
+	uint32_t heapIndex;
+	VkDeviceSize size;
+	{
+		std::lock_guard<std::mutex> guard(trackerLock);
+		auto it = trackerRecords.find({type, handle});
+		/*	Created while the tracker was disabled.	*/
+		if (it == trackerRecords.end())
+			return;
+		heapIndex = it->second.heapIndex;
+		size = it->second.size;
+		trackerRecords.erase(it);
+		nrLiveObjects.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	if (heapIndex < VK_MAX_MEMORY_HEAPS)
+		heapLiveBytes[heapIndex].fetch_sub(size, std::memory_order_relaxed);
+}
+
+VkDeviceSize VKResourceTracker::getLiveBytes(uint32_t heapIndex) noexcept {
+	if (heapIndex >= VK_MAX_MEMORY_HEAPS)
+		return 0;
+	return heapLiveBytes[heapIndex].load(std::memory_order_relaxed);
+}
+
+VKResourceTracker::Snapshot VKResourceTracker::snapshot() {
+	Snapshot snapshot;
+	{
+		std::lock_guard<std::mutex> guard(trackerLock);
+		snapshot.sequence = trackerSequence;
+		snapshot.records.reserve(trackerRecords.size());
+		for (const auto &it : trackerRecords)
+			snapshot.records.push_back(it.second);
+	}
+
+	std::sort(snapshot.records.begin(), snapshot.records.end(),
+			  [](const Record &a, const Record &b) { return a.sequence < b.sequence; });
+	for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; i++)
+		snapshot.heapBytes[i] = getLiveBytes(i);
+	return snapshot;
+}
+
+VKResourceTracker::Diff VKResourceTracker::diff(const Snapshot &previous, const Snapshot &current) {
+	Diff diff;
+
+	/*	Both are sorted by sequence, and a sequence number is never reused, so a single merge pass suffices.	*/
+	auto prev = previous.records.begin();
+	auto cur = current.records.begin();
+	while (prev != previous.records.end() || cur != current.records.end()) {
+		if (cur == current.records.end() || (prev != previous.records.end() && prev->sequence < cur->sequence)) {
+			diff.destroyed.push_back(*prev++);
+		} else if (prev == previous.records.end() || cur->sequence < prev->sequence) {
+			diff.created.push_back(*cur++);
+		} else {
+			prev++;
+			cur++;
+		}
+	}
+
+	for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; i++)
+		diff.heapBytes[i] = static_cast<int64_t>(current.heapBytes[i]) - static_cast<int64_t>(previous.heapBytes[i]);
+	return diff;
+}
+
+uint64_t VKResourceTracker::report(std::FILE *out) {
+	struct Group {
+		uint64_t nrObjects;
+		VkDeviceSize nrBytes;
+	};
+
+	const Snapshot live = snapshot();
+
+	/*	Group by call site and type, the file pointers are string literals so comparing them is enough.	*/
+	using GroupKey = std::tuple<const char *, uint32_t, VkObjectType>;
+	std::map<GroupKey, Group> groups;
+	for (const Record &record : live.records) {
+		Group &group = groups[GroupKey(record.callSite.file, record.callSite.line, record.type)];
+		group.nrObjects++;
+		group.nrBytes += record.size;
+	}
+
+	using GroupEntry = std::pair<GroupKey, Group>;
+	std::vector<GroupEntry> sorted(groups.begin(), groups.end());
+	std::sort(sorted.begin(), sorted.end(),
+			  [](const GroupEntry &a, const GroupEntry &b) { return a.second.nrBytes > b.second.nrBytes; });
+
+	fmt::print(out, "fvkcore: {} live objects\n", live.records.size());
+	for (const auto &group : sorted) {
+		const char *file = std::get<0>(group.first);
+		fmt::print(out, "  {:>6} x {:<20} {:>12} bytes  {}:{}\n", group.second.nrObjects,
+				   getObjectTypeName(std::get<2>(group.first)), group.second.nrBytes,
+				   file != nullptr ? file : "<unknown>", std::get<1>(group.first));
+	}
+	for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; i++) {
+		if (live.heapBytes[i] > 0)
+			fmt::print(out, "  heap {}: {} bytes\n", i, live.heapBytes[i]);
+	}
+
+	return live.records.size();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_RESOURCE_TRACKER_H_
+#define _FVK_VK_RESOURCE_TRACKER_H_ 1
+#include "VKUtil.h"
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+/*	GCC, Clang and MSVC 16.6+ evaluate these builtins at the outermost call site when used as default arguments.	*/
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+#define FVK_CALL_SITE_FILE __builtin_FILE()
+#define FVK_CALL_SITE_LINE __builtin_LINE()
+#else
+#define FVK_CALL_SITE_FILE nullptr
+#define FVK_CALL_SITE_LINE 0
+#endif
+
+/**
+ * @brief Source location of the code that created an object. Used as a trailing default
+ * argument, so the location is that of the caller and not of VKHelper.
+ */
+struct FVK_DECL_EXTERN VKCallSite {
+	const char *file;
+	uint32_t line;
+
+	static constexpr VKCallSite current(const char *file = FVK_CALL_SITE_FILE,
+										uint32_t line = FVK_CALL_SITE_LINE) noexcept {
+		return {file, line};
+	}
+};
+
+/**
+ * @brief Live accounting of the objects created through VKHelper, with the size, memory type and
+ * call site of each. Disabled by default; while disabled every record is a single relaxed load,
+ * and while enabled a short critical section, so it can be left on in production builds.
+ *
+ * Only VkDeviceMemory objects are accounted to the heap counters, buffers and images carry their
+ * size for the report only, so memory is never counted twice.
+ */
+class FVK_DECL_EXTERN VKResourceTracker {
+  public:
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	struct Record {
+		VkObjectType type;
+		uint64_t handle;
+		VkDeviceSize size;
+		uint32_t memoryTypeIndex;
+		uint32_t heapIndex;
+		VKCallSite callSite;
+		uint64_t sequence; /*	Creation order, increasing over the process lifetime.	*/
+	};
+
+	struct Snapshot {
+		uint64_t sequence; /*	Last sequence number handed out when the snapshot was taken.	*/
+		std::vector<Record> records; /*	Live objects, sorted by sequence.	*/
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBytes;
+	};
+
+	struct Diff {
+		std::vector<Record> created;   /*	Live in the current snapshot, but not in the previous.	*/
+		std::vector<Record> destroyed; /*	Live in the previous snapshot, but not in the current.	*/
+		std::array<int64_t, VK_MAX_MEMORY_HEAPS> heapBytes;
+	};
+
+	/**
+	 * @brief Enable or disable the accounting. Objects created while disabled are not tracked,
+	 * destroying already tracked objects is still recorded after disabling.
+	 *
+	 * @param enable
+	 * @param reportAtExit print the leak report to stderr at process exit.
+	 */
+	static void setEnabled(bool enable, bool reportAtExit = false);
+	static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Record the creation of an object.
+	 *
+	 * @param type
+	 * @param handle
+	 * @param size bytes, 0 if not applicable.
+	 * @param callSite
+	 * @param memoryTypeIndex memory type of VkDeviceMemory objects.
+	 * @param heapIndex heap accounted with size, InvalidIndex for objects that do not own memory.
+	 */
+	static void recordCreate(VkObjectType type, uint64_t handle, VkDeviceSize size, const VKCallSite &callSite,
+							 uint32_t memoryTypeIndex = InvalidIndex, uint32_t heapIndex = InvalidIndex) {
+		if (isEnabled())
+			add(type, handle, size, callSite, memoryTypeIndex, heapIndex);
+	}
+
+	/**
+	 * @brief Record the creation of a memory allocation, accounted to the heap of the memory type.
+	 */
+	static void recordAllocation(uint64_t handle, VkDeviceSize size, uint32_t memoryTypeIndex,
+								 const VkPhysicalDeviceMemoryProperties &memProperties, const VKCallSite &callSite) {
+		if (isEnabled())
+			add(VK_OBJECT_TYPE_DEVICE_MEMORY, handle, size, callSite, memoryTypeIndex,
+				memProperties.memoryTypes[memoryTypeIndex].heapIndex);
+	}
+
+	static void recordDestroy(VkObjectType type, uint64_t handle) {
+		if (nrLiveObjects.load(std::memory_order_relaxed) != 0 && handle != 0)
+			remove(type, handle);
+	}
+
+	/**
+	 * @brief Get the bytes currently allocated from a heap, without locking.
+	 *
+	 * @param heapIndex
+	 * @return VkDeviceSize
+	 */
+	static VkDeviceSize getLiveBytes(uint32_t heapIndex) noexcept;
+	static uint64_t getNrLiveObjects() noexcept { return nrLiveObjects.load(std::memory_order_relaxed); }
+
+	static Snapshot snapshot();
+
+	/**
+	 * @brief Compute the objects created and destroyed between two snapshots, taking the
+	 * snapshots periodically and diffing them shows what keeps growing.
+	 *
+	 * @param previous
+	 * @param current
+	 * @return Diff
+	 */
+	static Diff diff(const Snapshot &previous, const Snapshot &current);
+
+	/**
+	 * @brief Print the live objects grouped by call site and type, largest first. At shutdown,
+	 * after all objects should have been destroyed, this is the leak report.
+	 *
+	 * @param out
+	 * @return uint64_t number of live objects.
+	 */
+	static uint64_t report(std::FILE *out = stderr);
+
+  private:
+	static void add(VkObjectType type, uint64_t handle, VkDeviceSize size, const VKCallSite &callSite,
+					uint32_t memoryTypeIndex, uint32_t heapIndex);
+	static void remove(VkObjectType type, uint64_t handle);
+
+	static std::atomic<bool> enabled;
+	static std::atomic<uint64_t> nrLiveObjects;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "VKSamplerCache.h"
+#include <functional>
+
+template <typename T> static inline void hashCombine(size_t &seed, const T &value) noexcept {
+	seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+size_t VKSamplerCache::SamplerHash::operator()(const VkSamplerCreateInfo &info) const noexcept {
+	size_t seed = 0;
+	hashCombine(seed, static_cast<uint32_t>(info.flags));
+	hashCombine(seed, static_cast<uint32_t>(info.magFilter));
+	hashCombine(seed, static_cast<uint32_t>(info.minFilter));
+	hashCombine(seed, static_cast<uint32_t>(info.mipmapMode));
+	hashCombine(seed, static_cast<uint32_t>(info.addressModeU));
+	hashCombine(seed, static_cast<uint32_t>(info.addressModeV));
+	hashCombine(seed, static_cast<uint32_t>(info.addressModeW));
+	hashCombine(seed, info.mipLodBias);
+	hashCombine(seed, static_cast<uint32_t>(info.anisotropyEnable));
+	hashCombine(seed, info.maxAnisotropy);
+	hashCombine(seed, static_cast<uint32_t>(info.compareEnable));
+	hashCombine(seed, static_cast<uint32_t>(info.compareOp));
+	hashCombine(seed, info.minLod);
+	hashCombine(seed, info.maxLod);
+	hashCombine(seed, static_cast<uint32_t>(info.borderColor));
+	hashCombine(seed, static_cast<uint32_t>(info.unnormalizedCoordinates));
+	return seed;
+}
+
+bool VKSamplerCache::SamplerEqual::operator()(const VkSamplerCreateInfo &a,
+											  const VkSamplerCreateInfo &b) const noexcept {
+	return a.flags == b.flags && a.magFilter == b.magFilter && a.minFilter == b.minFilter &&
+		   a.mipmapMode == b.mipmapMode && a.addressModeU == b.addressModeU && a.addressModeV == b.addressModeV &&
+		   a.addressModeW == b.addressModeW && a.mipLodBias == b.mipLodBias &&
+		   a.anisotropyEnable == b.anisotropyEnable && a.maxAnisotropy == b.maxAnisotropy &&
+		   a.compareEnable == b.compareEnable && a.compareOp == b.compareOp && a.minLod == b.minLod &&
+		   a.maxLod == b.maxLod && a.borderColor == b.borderColor &&
+		   a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+VKSamplerCache::VKSamplerCache(const std::shared_ptr<VKDevice> &device) : device(device) {}
+
+VKSamplerCache::~VKSamplerCache() {
+	for (const std::pair<const VkSamplerCreateInfo, VkSampler> &sampler : this->samplers)
+		vkDestroySampler(this->device->getHandle(), sampler.second, nullptr);
+}
+
+VkSampler VKSamplerCache::getSampler(const VkSamplerCreateInfo &samplerInfo) { return acquireSampler(samplerInfo); }
+
+VkDescriptorSetLayoutBinding VKSamplerCache::getImmutableSamplerBinding(uint32_t binding, VkShaderStageFlags stages,
+																		const VkSamplerCreateInfo &samplerInfo,
+																		VkDescriptorType type) {
+	VkDescriptorSetLayoutBinding layoutBinding = {};
+	layoutBinding.binding = binding;
+	layoutBinding.descriptorType = type;
+	layoutBinding.descriptorCount = 1;
+	layoutBinding.stageFlags = stages;
+	layoutBinding.pImmutableSamplers = &acquireSampler(samplerInfo);
+	return layoutBinding;
+}
+
+const VkSampler &VKSamplerCache::acquireSampler(const VkSamplerCreateInfo &samplerInfo) {
+	if (samplerInfo.pNext != nullptr)
+		throw cxxexcept::RuntimeException("Sampler cache does not support pNext chains");
+
+	const PhysicalDevice &physicalDevice = *this->device->getPhysicalDevice(0);
+
+	/*	Normalize the description against the device capabilities, before the lookup.	*/
+	VkSamplerCreateInfo key = samplerInfo;
+	key.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	VKHelper::clampSamplerAnisotropy(key, this->device->getEnabledFeatures(), physicalDevice.getDeviceLimits());
+
+	std::lock_guard<std::mutex> guard(this->lock);
+
+	auto it = this->samplers.find(key);
+	if (it != this->samplers.end())
+		return it->second;
+
+	if (this->samplers.size() >= physicalDevice.getDeviceLimits().maxSamplerAllocationCount)
+		throw cxxexcept::RuntimeException("Sampler allocation count exceeded {}",
+										  physicalDevice.getDeviceLimits().maxSamplerAllocationCount);
+
+	VkSampler sampler;
+	VKS_VALIDATE(vkCreateSampler(this->device->getHandle(), &key, nullptr, &sampler));
+
+	return this->samplers.emplace(key, sampler).first->second;
+}
+
+VkSamplerCreateInfo VKSamplerCache::createSamplerInfo(VkFilter filter, VkSamplerAddressMode addressMode,
+													  float maxAnisotropy) {
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = filter;
+	samplerInfo.minFilter = filter;
+	samplerInfo.mipmapMode =
+		filter == VK_FILTER_NEAREST ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerInfo.addressModeU = addressMode;
+	samplerInfo.addressModeV = addressMode;
+	samplerInfo.addressModeW = addressMode;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+	samplerInfo.maxAnisotropy = maxAnisotropy;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	return samplerInfo;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_SAMPLER_CACHE_H_
+#define _FVK_VK_SAMPLER_CACHE_H_ 1
+#include "VKDevice.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Cache of immutable samplers, keyed by the full sampler description.
+ * Equal descriptions share the same VkSampler, thus the number of sampler objects
+ * is bounded by the number of unique descriptions. The samplers are owned by the
+ * cache and destroyed with it.
+ */
+class FVK_DECL_EXTERN VKSamplerCache {
+  public:
+	VKSamplerCache(const std::shared_ptr<VKDevice> &device);
+	VKSamplerCache(const VKSamplerCache &) = delete;
+	VKSamplerCache(VKSamplerCache &&) = delete;
+	~VKSamplerCache();
+
+	/**
+	 * @brief Get the Sampler object matching the description, created on first request.
+	 * Anisotropy is disabled if the feature is not enabled on the device and clamped to maxSamplerAnisotropy.
+	 *
+	 * @param samplerInfo pNext chains are not supported.
+	 * @return VkSampler
+	 */
+	VkSampler getSampler(const VkSamplerCreateInfo &samplerInfo);
+
+	/**
+	 * @brief Get a descriptor set layout binding with the sampler embedded as immutable sampler.
+	 * The pImmutableSamplers pointer remains valid for the lifetime of the cache.
+	 *
+	 * @param binding
+	 * @param stages
+	 * @param samplerInfo
+	 * @param type VK_DESCRIPTOR_TYPE_SAMPLER or VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+	 * @return VkDescriptorSetLayoutBinding
+	 */
+	VkDescriptorSetLayoutBinding
+	getImmutableSamplerBinding(uint32_t binding, VkShaderStageFlags stages, const VkSamplerCreateInfo &samplerInfo,
+							   VkDescriptorType type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+	/**
+	 * @brief Create a Sampler Info object with default values.
+	 *
+	 * @param filter
+	 * @param addressMode
+	 * @param maxAnisotropy 1.0 disables anisotropic filtering.
+	 * @return VkSamplerCreateInfo
+	 */
+	static VkSamplerCreateInfo createSamplerInfo(VkFilter filter = VK_FILTER_LINEAR,
+												 VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+												 float maxAnisotropy = 1.0f);
+
+	size_t getNrSamplers() const noexcept { return this->samplers.size(); }
+
+  private:
+	struct SamplerHash {
+		size_t operator()(const VkSamplerCreateInfo &info) const noexcept;
+	};
+	struct SamplerEqual {
+		bool operator()(const VkSamplerCreateInfo &a, const VkSamplerCreateInfo &b) const noexcept;
+	};
+
+	/*	Returns a reference to the stored handle, stable for the lifetime of the cache.	*/
+	const VkSampler &acquireSampler(const VkSamplerCreateInfo &samplerInfo);
+
+	std::shared_ptr<VKDevice> device;
+	std::unordered_map<VkSamplerCreateInfo, VkSampler, SamplerHash, SamplerEqual> samplers;
+	std::mutex lock;
+};
+
+#endif
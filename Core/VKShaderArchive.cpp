@@ -0,0 +1,183 @@
+#include "VKShaderArchive.h"
+#include "VKHelper.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+VKShaderArchive::VKShaderArchive(const std::string &path)
+	: data(nullptr), size(0), header(nullptr), entries(nullptr) {
+#ifdef _WIN32
+	this->fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								   FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->fileHandle == INVALID_HANDLE_VALUE)
+		throw cxxexcept::RuntimeException("Failed to open shader archive '{}'", path);
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(this->fileHandle, &fileSize);
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+
+	this->mappingHandle = CreateFileMappingA(this->fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (this->mappingHandle == nullptr) {
+		CloseHandle(this->fileHandle);
+		throw cxxexcept::RuntimeException("Failed to map shader archive '{}'", path);
+	}
+	this->data = static_cast<const uint8_t *>(MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw cxxexcept::RuntimeException("Failed to open shader archive '{}' - {}", path, strerror(errno));
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		close(fd);
+		throw cxxexcept::RuntimeException("Failed to stat shader archive '{}' - {}", path, strerror(errno));
+	}
+	this->size = static_cast<size_t>(fileStat.st_size);
+
+	void *mapping = this->size > 0 ? mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	/*	The mapping keeps the file referenced.	*/
+	close(fd);
+	this->data = mapping != MAP_FAILED ? static_cast<const uint8_t *>(mapping) : nullptr;
+#endif
+	if (this->data == nullptr) {
+		this->unmap();
+		throw cxxexcept::RuntimeException("Failed to map shader archive '{}'", path);
+	}
+
+	/*	Validate the header and the index, the code is validated by the driver.	*/
+	this->header = reinterpret_cast<const Header *>(this->data);
+	if (this->size < sizeof(Header) || this->header->magic != Magic || this->header->version != Version ||
+		this->header->nrEntries > (this->size - sizeof(Header)) / sizeof(Entry)) {
+		this->unmap();
+		throw cxxexcept::RuntimeException("'{}' is not a valid shader archive", path);
+	}
+	this->entries = reinterpret_cast<const Entry *>(this->data + sizeof(Header));
+
+	for (uint32_t i = 0; i < this->header->nrEntries; i++) {
+		const Entry &entry = this->entries[i];
+		/*	Compare against the remaining size, the sum of offset and size may overflow.	*/
+		if (entry.codeOffset % sizeof(uint32_t) != 0 || entry.codeOffset > this->size ||
+			entry.codeSize > this->size - entry.codeOffset || entry.nameOffset > this->size ||
+			entry.nameLength > this->size - entry.nameOffset) {
+			this->unmap();
+			throw cxxexcept::RuntimeException("Shader archive '{}' has invalid entry {}", path, i);
+		}
+	}
+}
+
+VKShaderArchive::~VKShaderArchive() { this->unmap(); }
+
+void VKShaderArchive::unmap() noexcept {
+#ifdef _WIN32
+	if (this->data != nullptr)
+		UnmapViewOfFile(this->data);
+	if (this->mappingHandle != nullptr)
+		CloseHandle(this->mappingHandle);
+	if (this->fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(this->fileHandle);
+	this->mappingHandle = nullptr;
+	this->fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (this->data != nullptr)
+		munmap(const_cast<uint8_t *>(this->data), this->size);
+#endif
+	this->data = nullptr;
+	this->header = nullptr;
+	this->entries = nullptr;
+}
+
+bool VKShaderArchive::find(const std::string &name, Module &module) const noexcept {
+	const uint64_t hash = hashName(name.data(), name.size());
+	const Entry *end = this->entries + this->header->nrEntries;
+
+	/*	Binary search the hash, then compare the names to resolve collisions.	*/
+	const Entry *it = std::lower_bound(this->entries, end, hash,
+									   [](const Entry &entry, uint64_t value) { return entry.nameHash < value; });
+	for (; it != end && it->nameHash == hash; it++) {
+		if (it->nameLength == name.size() &&
+			std::memcmp(this->data + it->nameOffset, name.data(), it->nameLength) == 0) {
+			module.code = reinterpret_cast<const uint32_t *>(this->data + it->codeOffset);
+			module.codeSize = it->codeSize;
+			return true;
+		}
+	}
+	return false;
+}
+
+VKShaderArchive::Module VKShaderArchive::getModule(const std::string &name) const {
+	Module module;
+	if (!this->find(name, module))
+		throw cxxexcept::RuntimeException("Shader archive does not contain: {}", name);
+	return module;
+}
+
+VkShaderModule VKShaderArchive::createShaderModule(VkDevice device, const std::string &name,
+												   const VkAllocationCallbacks *pAllocator) const {
+	const Module module = this->getModule(name);
+	return VKHelper::createShaderModule(device, module.code, module.codeSize, pAllocator);
+}
+
+std::string VKShaderArchive::getModuleName(uint32_t index) const {
+	const Entry &entry = this->entries[index];
+	return std::string(reinterpret_cast<const char *>(this->data + entry.nameOffset), entry.nameLength);
+}
+
+void VKShaderArchive::pack(const std::string &path,
+						   const std::vector<std::pair<std::string, std::vector<uint32_t>>> &modules) {
+	const auto align = [](uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); };
+
+	Header header = {};
+	header.magic = Magic;
+	header.version = Version;
+	header.nrEntries = static_cast<uint32_t>(modules.size());
+
+	/*	Layout: header, index, string table, code.	*/
+	std::vector<Entry> entries(modules.size());
+	uint64_t offset = sizeof(Header) + sizeof(Entry) * modules.size();
+	for (size_t i = 0; i < modules.size(); i++) {
+		const std::string &name = modules[i].first;
+		entries[i].nameHash = hashName(name.data(), name.size());
+		entries[i].nameOffset = static_cast<uint32_t>(offset);
+		entries[i].nameLength = static_cast<uint32_t>(name.size());
+		offset += name.size();
+	}
+	for (size_t i = 0; i < modules.size(); i++) {
+		offset = align(offset, 8);
+		entries[i].codeOffset = offset;
+		entries[i].codeSize = modules[i].second.size() * sizeof(uint32_t);
+		offset += entries[i].codeSize;
+	}
+
+	/*	Sort the index by hash, the data layout is kept in the input order.	*/
+	std::vector<Entry> index = entries;
+	std::stable_sort(index.begin(), index.end(),
+					 [](const Entry &a, const Entry &b) { return a.nameHash < b.nameHash; });
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw cxxexcept::RuntimeException("Failed to create shader archive '{}'", path);
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(index.data()), sizeof(Entry) * index.size());
+	for (const std::pair<std::string, std::vector<uint32_t>> &module : modules)
+		file.write(module.first.data(), module.first.size());
+
+	const char padding[8] = {0};
+	for (size_t i = 0; i < modules.size(); i++) {
+		const uint64_t position = static_cast<uint64_t>(file.tellp());
+		file.write(padding, entries[i].codeOffset - position);
+		file.write(reinterpret_cast<const char *>(modules[i].second.data()), entries[i].codeSize);
+	}
+
+	if (!file)
+		throw cxxexcept::RuntimeException("Failed to write shader archive '{}'", path);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_SHADER_ARCHIVE_H_
+#define _FVK_VK_SHADER_ARCHIVE_H_ 1
+#include "VKUtil.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Read-only archive of SPIR-V modules, memory mapped.
+ * The archive consists of a header, an index sorted by the hash of the module
+ * name, a string table and the SPIR-V code aligned to 8 bytes. Modules are
+ * returned as pointers directly into the mapping, thus loading any number of
+ * modules only costs one mapping and no copies.
+ *
+ * All values are stored little-endian.
+ */
+class FVK_DECL_EXTERN VKShaderArchive {
+  public:
+	static constexpr uint32_t Magic = 0x534B5646; /*	'FVKS'	*/
+	static constexpr uint32_t Version = 1;
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t nrEntries;
+		uint32_t reserved;
+	};
+
+	struct Entry {
+		uint64_t nameHash;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint64_t codeOffset;
+		uint64_t codeSize;
+	};
+
+	/**
+	 * @brief SPIR-V code of a module within the mapping.
+	 */
+	struct Module {
+		const uint32_t *code;
+		/*	Size in bytes.	*/
+		size_t codeSize;
+	};
+
+	VKShaderArchive(const std::string &path);
+	VKShaderArchive(const VKShaderArchive &) = delete;
+	VKShaderArchive(VKShaderArchive &&) = delete;
+	~VKShaderArchive();
+
+	/**
+	 * @brief Find the module by name.
+	 *
+	 * @param name
+	 * @param module
+	 * @return true if found.
+	 */
+	bool find(const std::string &name, Module &module) const noexcept;
+
+	/**
+	 * @brief Get the Module object, throws if not found.
+	 *
+	 * @param name
+	 * @return Module
+	 */
+	Module getModule(const std::string &name) const;
+
+	/**
+	 * @brief Create a Shader Module object directly from the mapping.
+	 *
+	 * @param device
+	 * @param name
+	 * @return VkShaderModule
+	 */
+	VkShaderModule createShaderModule(VkDevice device, const std::string &name,
+									  const VkAllocationCallbacks *pAllocator = nullptr) const;
+
+	uint32_t getNrModules() const noexcept { return this->header->nrEntries; }
+	std::string getModuleName(uint32_t index) const;
+
+	/**
+	 * @brief Write an archive of the modules.
+	 *
+	 * @param path
+	 * @param modules name and SPIR-V code pairs.
+	 */
+	static void pack(const std::string &path,
+					 const std::vector<std::pair<std::string, std::vector<uint32_t>>> &modules);
+
+	/**
+	 * @brief 64-bit FNV-1a hash of the module name.
+	 */
+	static constexpr uint64_t hashName(const char *name, size_t length) noexcept {
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (size_t i = 0; i < length; i++) {
+			hash ^= static_cast<uint8_t>(name[i]);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+  private:
+	void unmap() noexcept;
+
+	const uint8_t *data;
+	size_t size;
+	const Header *header;
+	const Entry *entries;
+#ifdef _WIN32
+	void *fileHandle;
+	void *mappingHandle;
+#endif
+};
+
+#endif
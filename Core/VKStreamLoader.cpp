@@ -0,0 +1,519 @@
+#include "VKStreamLoader.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef FVK_USE_IO_URING
+#include <liburing.h>
+#endif
+
+class VKStreamLoader::Reader {
+  public:
+	virtual ~Reader() { this->close(); }
+
+	void open(const std::string &path) {
+#ifdef _WIN32
+		this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								 FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (this->file == INVALID_HANDLE_VALUE)
+			throw cxxexcept::RuntimeException("Failed to open file '{}'", path);
+		LARGE_INTEGER size;
+		GetFileSizeEx(this->file, &size);
+		this->fileSize = static_cast<uint64_t>(size.QuadPart);
+#else
+		this->fd = ::open(path.c_str(), O_RDONLY);
+		if (this->fd < 0)
+			throw cxxexcept::RuntimeException("Failed to open file '{}' - {}", path, strerror(errno));
+		struct stat st;
+		fstat(this->fd, &st);
+		this->fileSize = static_cast<uint64_t>(st.st_size);
+#if defined(POSIX_FADV_SEQUENTIAL)
+		posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+	}
+
+	void close() noexcept {
+#ifdef _WIN32
+		if (this->file != INVALID_HANDLE_VALUE)
+			CloseHandle(this->file);
+		this->file = INVALID_HANDLE_VALUE;
+#else
+		if (this->fd >= 0)
+			::close(this->fd);
+		this->fd = -1;
+#endif
+	}
+
+	uint64_t getFileSize() const noexcept { return this->fileSize; }
+
+	/**
+	 * @brief Start reading size bytes at the offset into dst.
+	 */
+	virtual void submit(unsigned int slot, void *dst, size_t size, uint64_t offset) = 0;
+
+	/**
+	 * @brief Block until any of the submitted reads has completed.
+	 *
+	 * @return unsigned int slot of the completed read.
+	 */
+	virtual unsigned int wait() = 0;
+
+	virtual bool isIOUring() const noexcept = 0;
+
+  protected:
+	/*	Blocking read of the complete range.	*/
+	void readAt(void *dst, size_t size, uint64_t offset) const {
+		uint8_t *data = static_cast<uint8_t *>(dst);
+		while (size > 0) {
+#ifdef _WIN32
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD nrRead = 0;
+			const DWORD request = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+			if (!ReadFile(this->file, data, request, &nrRead, &overlapped))
+				throw cxxexcept::RuntimeException("Failed to read file at offset {}", offset);
+#else
+			const ssize_t nrRead = pread(this->fd, data, size, static_cast<off_t>(offset));
+			if (nrRead < 0) {
+				if (errno == EINTR)
+					continue;
+				throw cxxexcept::RuntimeException("Failed to read file at offset {} - {}", offset, strerror(errno));
+			}
+#endif
+			if (nrRead == 0)
+				throw cxxexcept::RuntimeException("Unexpected end of file at offset {}", offset);
+			data += nrRead;
+			size -= nrRead;
+			offset += nrRead;
+		}
+	}
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+#else
+	int fd = -1;
+#endif
+	uint64_t fileSize = 0;
+};
+
+/*	Blocking reads on a thread pool.	*/
+class ThreadPoolReader : public VKStreamLoader::Reader {
+  public:
+	ThreadPoolReader(unsigned int nrThreads) : threadPool(nrThreads) {}
+	~ThreadPoolReader() override { this->threadPool.wait(); }
+
+	void submit(unsigned int slot, void *dst, size_t size, uint64_t offset) override {
+		this->threadPool.submit([this, slot, dst, size, offset](unsigned int) {
+			std::exception_ptr exception;
+			try {
+				this->readAt(dst, size, offset);
+			} catch (...) {
+				exception = std::current_exception();
+			}
+			{
+				std::unique_lock<std::mutex> guard(this->lock);
+				this->completed.emplace_back(slot, exception);
+			}
+			this->condition.notify_one();
+		});
+	}
+
+	unsigned int wait() override {
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->condition.wait(guard, [this] { return !this->completed.empty(); });
+		const std::pair<unsigned int, std::exception_ptr> result = this->completed.front();
+		this->completed.pop_front();
+		if (result.second)
+			std::rethrow_exception(result.second);
+		return result.first;
+	}
+
+	bool isIOUring() const noexcept override { return false; }
+
+  private:
+	VKThreadPool threadPool;
+	std::mutex lock;
+	std::condition_variable condition;
+	std::deque<std::pair<unsigned int, std::exception_ptr>> completed;
+};
+
+#ifdef FVK_USE_IO_URING
+/*	Asynchronous reads with io_uring, short reads are resubmitted for the remainder.	*/
+class IOUringReader : public VKStreamLoader::Reader {
+  public:
+	IOUringReader(unsigned int nrEntries) : requests(nrEntries) {
+		const int result = io_uring_queue_init(nrEntries, &this->ring, 0);
+		if (result < 0)
+			throw cxxexcept::RuntimeException("Failed to create io_uring - {}", strerror(-result));
+	}
+	~IOUringReader() override { io_uring_queue_exit(&this->ring); }
+
+	void submit(unsigned int slot, void *dst, size_t size, uint64_t offset) override {
+		Request &request = this->requests[slot];
+		request.dst = static_cast<uint8_t *>(dst);
+		request.remaining = size;
+		request.offset = offset;
+		this->enqueue(slot);
+	}
+
+	unsigned int wait() override {
+		while (true) {
+			struct io_uring_cqe *cqe;
+			const int result = io_uring_wait_cqe(&this->ring, &cqe);
+			if (result == -EINTR)
+				continue;
+			if (result < 0)
+				throw cxxexcept::RuntimeException("Failed waiting for io_uring - {}", strerror(-result));
+
+			const unsigned int slot =
+				static_cast<unsigned int>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+			const int nrRead = cqe->res;
+			io_uring_cqe_seen(&this->ring, cqe);
+
+			Request &request = this->requests[slot];
+			if (nrRead < 0)
+				throw cxxexcept::RuntimeException("Failed to read file at offset {} - {}", request.offset,
+												  strerror(-nrRead));
+			if (nrRead == 0)
+				throw cxxexcept::RuntimeException("Unexpected end of file at offset {}", request.offset);
+
+			request.dst += nrRead;
+			request.remaining -= nrRead;
+			request.offset += nrRead;
+			if (request.remaining == 0)
+				return slot;
+			this->enqueue(slot);
+		}
+	}
+
+	bool isIOUring() const noexcept override { return true; }
+
+  private:
+	struct Request {
+		uint8_t *dst;
+		size_t remaining;
+		uint64_t offset;
+	};
+
+	void enqueue(unsigned int slot) {
+		const Request &request = this->requests[slot];
+		struct io_uring_sqe *sqe = io_uring_get_sqe(&this->ring);
+		if (sqe == nullptr)
+			throw cxxexcept::RuntimeException("io_uring submission queue is full");
+		const unsigned int nrBytes = static_cast<unsigned int>(std::min<size_t>(request.remaining, 1u << 30));
+		io_uring_prep_read(sqe, this->fd, request.dst, nrBytes, request.offset);
+		io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(static_cast<uintptr_t>(slot)));
+		const int result = io_uring_submit(&this->ring);
+		if (result < 0)
+			throw cxxexcept::RuntimeException("Failed to submit io_uring read - {}", strerror(-result));
+	}
+
+	struct io_uring ring;
+	std::vector<Request> requests;
+};
+#endif
+
+namespace {
+/*	Accumulates the wall time during which at least one operation of a stage is in flight.	*/
+struct StageTimer {
+	using clock = std::chrono::steady_clock;
+
+	void begin() {
+		if (this->active++ == 0)
+			this->since = clock::now();
+	}
+	void end() {
+		if (--this->active == 0)
+			this->seconds += std::chrono::duration<double>(clock::now() - this->since).count();
+	}
+
+	unsigned int active = 0;
+	clock::time_point since;
+	double seconds = 0;
+};
+} // namespace
+
+VKStreamLoader::VKStreamLoader(const std::shared_ptr<VKDevice> &device, VkDeviceSize chunkSize,
+							   unsigned int nrChunksInFlight, unsigned int nrThreads)
+	: device(device), chunkSize(chunkSize) {
+	nrChunksInFlight = std::max(1u, nrChunksInFlight);
+
+#ifdef FVK_USE_IO_URING
+	try {
+		this->reader = std::make_unique<IOUringReader>(nrChunksInFlight);
+	} catch (const std::exception &) {
+		/*	io_uring can be unavailable, e.g. disabled by the kernel or the sandbox.	*/
+	}
+#endif
+	if (!this->reader)
+		this->reader = std::make_unique<ThreadPoolReader>(nrThreads == 0 ? nrChunksInFlight : nrThreads);
+
+	/*	Without a transfer queue, the graphics or compute queue is used, both support transfer.	*/
+	if (device->getDefaultTransfer() != VK_NULL_HANDLE) {
+		this->queue = device->getDefaultTransfer();
+		this->queueFamilyIndex = device->getDefaultTransferQueueIndex();
+	} else if (device->getDefaultGraphicQueue() != VK_NULL_HANDLE) {
+		this->queue = device->getDefaultGraphicQueue();
+		this->queueFamilyIndex = device->getDefaultGraphicQueueIndex();
+	} else if (device->getDefaultCompute() != VK_NULL_HANDLE) {
+		this->queue = device->getDefaultCompute();
+		this->queueFamilyIndex = device->getDefaultComputeQueueIndex();
+	} else {
+		throw cxxexcept::RuntimeException("Device has no queue that supports transfer");
+	}
+	this->commandPool = device->createCommandPool(this->queueFamilyIndex);
+
+	/*	Copies are timed on the device, the host only observes them between blocking reads.	*/
+	this->queryPool = VK_NULL_HANDLE;
+	const uint32_t timestampValidBits =
+		device->getPhysicalDevice(0)->getQueueFamilyProperties()[this->queueFamilyIndex].timestampValidBits;
+	this->timestampMask = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1;
+	if (timestampValidBits > 0) {
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = 2 * nrChunksInFlight;
+		VKS_VALIDATE(vkCreateQueryPool(device->getHandle(), &queryPoolInfo, nullptr, &this->queryPool));
+	}
+
+	VKHelper::createBuffer(device->getHandle(), chunkSize * nrChunksInFlight,
+						   device->getPhysicalDevice(0)->getMemoryProperties(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+						   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						   this->stagingBuffer, this->stagingMemory);
+	void *mapped;
+	VKS_VALIDATE(vkMapMemory(device->getHandle(), this->stagingMemory, 0, VK_WHOLE_SIZE, 0, &mapped));
+
+	const std::vector<VkCommandBuffer> cmds =
+		device->allocateCommandBuffers(this->commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, nrChunksInFlight);
+	this->slots.resize(nrChunksInFlight);
+	for (unsigned int i = 0; i < nrChunksInFlight; i++) {
+		Slot &slot = this->slots[i];
+		slot.cmd = cmds[i];
+		slot.fence = device->getSyncPool().acquireFence();
+		slot.mapped = static_cast<uint8_t *>(mapped) + i * chunkSize;
+		slot.copying = false;
+	}
+}
+
+VKStreamLoader::~VKStreamLoader() {
+	this->reader.reset();
+	for (Slot &slot : this->slots)
+		this->device->getSyncPool().releaseFence(slot.fence);
+	vkUnmapMemory(this->device->getHandle(), this->stagingMemory);
+	VKHelper::destroyBuffer(this->device->getHandle(), this->stagingBuffer, this->stagingMemory);
+	if (this->queryPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(this->device->getHandle(), this->queryPool, nullptr);
+	vkDestroyCommandPool(this->device->getHandle(), this->commandPool, nullptr);
+}
+
+bool VKStreamLoader::isIOUringEnabled() const noexcept { return this->reader->isIOUring(); }
+
+VKStreamLoader::Statistics VKStreamLoader::loadBuffer(const std::string &path, VkBuffer dst, VkDeviceSize dstOffset,
+													  uint64_t fileOffset, uint64_t size,
+													  uint32_t dstQueueFamilyIndex) {
+	const VkDevice handle = this->device->getHandle();
+	const StageTimer::clock::time_point start = StageTimer::clock::now();
+
+	this->reader->open(path);
+	const uint64_t fileSize = this->reader->getFileSize();
+	if (fileOffset > fileSize || (size > 0 && fileOffset + size > fileSize)) {
+		this->reader->close();
+		throw cxxexcept::RuntimeException("Range {} + {} exceeds the file size {} of '{}'", fileOffset, size,
+										  fileSize, path);
+	}
+	if (size == 0)
+		size = fileSize - fileOffset;
+
+	const uint64_t nrChunks = (size + this->chunkSize - 1) / this->chunkSize;
+	uint64_t nextChunk = 0;
+	uint64_t nrCopied = 0;
+	unsigned int nrReading = 0;
+	StageTimer readTimer, copyTimer;
+	/*	Device timestamps of each copy, relative to the first copy.	*/
+	std::vector<std::pair<uint64_t, uint64_t>> copyIntervals;
+	uint64_t firstTimestamp = 0;
+
+	auto issueRead = [&](unsigned int index) {
+		Slot &slot = this->slots[index];
+		const uint64_t chunkOffset = nextChunk * this->chunkSize;
+		slot.fileOffset = fileOffset + chunkOffset;
+		slot.size = std::min<uint64_t>(this->chunkSize, size - chunkOffset);
+		this->reader->submit(index, slot.mapped, slot.size, slot.fileOffset);
+		readTimer.begin();
+		nrReading++;
+		nextChunk++;
+	};
+
+	auto issueCopy = [&](unsigned int index) {
+		Slot &slot = this->slots[index];
+		VKS_VALIDATE(vkResetFences(handle, 1, &slot.fence));
+		VKS_VALIDATE(vkResetCommandBuffer(slot.cmd, 0));
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VKS_VALIDATE(vkBeginCommandBuffer(slot.cmd, &beginInfo));
+		if (this->queryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(slot.cmd, this->queryPool, 2 * index, 2);
+			vkCmdWriteTimestamp(slot.cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->queryPool, 2 * index);
+		}
+
+		VkBufferCopy region = {};
+		region.srcOffset = index * this->chunkSize;
+		region.dstOffset = dstOffset + (slot.fileOffset - fileOffset);
+		region.size = slot.size;
+		vkCmdCopyBuffer(slot.cmd, this->stagingBuffer, dst, 1, &region);
+		if (this->queryPool != VK_NULL_HANDLE)
+			vkCmdWriteTimestamp(slot.cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->queryPool, 2 * index + 1);
+		VKS_VALIDATE(vkEndCommandBuffer(slot.cmd));
+
+		this->device->submitCommands(this->queue, {slot.cmd}, {}, {}, slot.fence);
+		slot.copying = true;
+		if (this->queryPool == VK_NULL_HANDLE)
+			copyTimer.begin();
+	};
+
+	auto completeCopy = [&](unsigned int index) {
+		this->slots[index].copying = false;
+		if (this->queryPool != VK_NULL_HANDLE) {
+			uint64_t timestamps[2];
+			VKS_VALIDATE(vkGetQueryPoolResults(handle, this->queryPool, 2 * index, 2, sizeof(timestamps), timestamps,
+											   sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+			if (copyIntervals.empty())
+				firstTimestamp = timestamps[0];
+			const uint64_t begin = (timestamps[0] - firstTimestamp) & this->timestampMask;
+			copyIntervals.emplace_back(begin, begin + ((timestamps[1] - timestamps[0]) & this->timestampMask));
+		} else {
+			copyTimer.end();
+		}
+		nrCopied++;
+		if (nextChunk < nrChunks)
+			issueRead(index);
+	};
+
+	try {
+		for (unsigned int i = 0; i < this->slots.size() && nextChunk < nrChunks; i++)
+			issueRead(i);
+
+		std::vector<VkFence> copyFences;
+		while (nrCopied < nrChunks) {
+			/*	Recycle the chunks whose copy has finished.	*/
+			for (unsigned int i = 0; i < this->slots.size(); i++) {
+				if (this->slots[i].copying && vkGetFenceStatus(handle, this->slots[i].fence) == VK_SUCCESS)
+					completeCopy(i);
+			}
+
+			if (nrReading > 0) {
+				/*	Copy the next chunk that has been read.	*/
+				/*	Accounted before waiting, a failed wait has consumed its completion.	*/
+				nrReading--;
+				const unsigned int index = this->reader->wait();
+				readTimer.end();
+				issueCopy(index);
+			} else if (nrCopied < nrChunks) {
+				/*	Only copies left, block on any of them.	*/
+				copyFences.clear();
+				for (const Slot &slot : this->slots) {
+					if (slot.copying)
+						copyFences.push_back(slot.fence);
+				}
+				VKS_VALIDATE(vkWaitForFences(handle, copyFences.size(), copyFences.data(), VK_FALSE, UINT64_MAX));
+			}
+		}
+	} catch (...) {
+		/*	The reads and copies still reference the staging memory.	*/
+		for (; nrReading > 0; nrReading--) {
+			try {
+				this->reader->wait();
+			} catch (...) {
+			}
+		}
+		for (Slot &slot : this->slots) {
+			if (slot.copying)
+				vkWaitForFences(handle, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+			slot.copying = false;
+		}
+		this->reader->close();
+		throw;
+	}
+	this->reader->close();
+
+	if (dstQueueFamilyIndex != VK_QUEUE_FAMILY_IGNORED && dstQueueFamilyIndex != this->queueFamilyIndex && size > 0)
+		this->transferOwnership(dst, dstOffset, size, dstQueueFamilyIndex);
+
+	/*	Union of the copy intervals, copies of different slots may overlap.	*/
+	if (this->queryPool != VK_NULL_HANDLE) {
+		std::sort(copyIntervals.begin(), copyIntervals.end());
+		uint64_t nrTicks = 0;
+		uint64_t coveredEnd = 0;
+		for (const std::pair<uint64_t, uint64_t> &interval : copyIntervals) {
+			const uint64_t begin = std::max(interval.first, coveredEnd);
+			if (interval.second > begin)
+				nrTicks += interval.second - begin;
+			coveredEnd = std::max(coveredEnd, interval.second);
+		}
+		copyTimer.seconds = static_cast<double>(nrTicks) *
+							this->device->getPhysicalDevice(0)->getDeviceLimits().timestampPeriod * 1e-9;
+	}
+
+	Statistics statistics = {};
+	statistics.nrBytes = size;
+	statistics.nrChunks = static_cast<uint32_t>(nrChunks);
+	statistics.readSeconds = readTimer.seconds;
+	statistics.copySeconds = copyTimer.seconds;
+	statistics.totalSeconds = std::chrono::duration<double>(StageTimer::clock::now() - start).count();
+	return statistics;
+}
+
+void VKStreamLoader::transferOwnership(VkBuffer dst, VkDeviceSize offset, VkDeviceSize size,
+									   uint32_t dstQueueFamilyIndex) {
+	/*	Default queue of the family the buffer is acquired on.	*/
+	VkQueue dstQueue = VK_NULL_HANDLE;
+	if (dstQueueFamilyIndex == this->device->getDefaultGraphicQueueIndex())
+		dstQueue = this->device->getDefaultGraphicQueue();
+	else if (dstQueueFamilyIndex == this->device->getDefaultComputeQueueIndex())
+		dstQueue = this->device->getDefaultCompute();
+	else if (dstQueueFamilyIndex == this->device->getDefaultPresentQueueIndex())
+		dstQueue = this->device->getDefaultPresent();
+	if (dstQueue == VK_NULL_HANDLE)
+		throw cxxexcept::RuntimeException("No queue created for queue family {}", dstQueueFamilyIndex);
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = this->queueFamilyIndex;
+	barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
+	barrier.buffer = dst;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	/*	Release on the transfer queue, after all copies in submission order.	*/
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	VkCommandBuffer cmd = this->device->beginSingleTimeCommand(this->commandPool);
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+						 &barrier, 0, nullptr);
+	this->device->endSingleTimeCommands(this->queue, cmd, this->commandPool);
+
+	/*	Acquire on the destination queue, the release has completed on the host.	*/
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	VkCommandPool dstCommandPool = this->device->createCommandPool(dstQueueFamilyIndex);
+	cmd = this->device->beginSingleTimeCommand(dstCommandPool);
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1,
+						 &barrier, 0, nullptr);
+	this->device->endSingleTimeCommands(dstQueue, cmd, dstCommandPool);
+	vkDestroyCommandPool(this->device->getHandle(), dstCommandPool, nullptr);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_STREAM_LOADER_H_
+#define _FVK_VK_STREAM_LOADER_H_ 1
+#include "VKDevice.h"
+#include "VKThreadPool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Stream a file into a device buffer through a ring of persistently mapped staging chunks.
+ * File chunks are read straight into the staging memory, with io_uring if available and otherwise
+ * with pread on a thread pool, while the copies of already read chunks execute on the transfer
+ * queue, or on the graphics or compute queue if the device has none. Reads and copies of multiple
+ * chunks are in flight at the same time, so a large load is bound by the slowest of disk and
+ * transfer bandwidth instead of their sum.
+ */
+class FVK_DECL_EXTERN VKStreamLoader {
+  public:
+	struct Statistics {
+		uint64_t nrBytes;
+		uint32_t nrChunks;
+		/*	Wall time with at least one read in flight.	*/
+		double readSeconds;
+		/*	Device time with at least one copy executing, from timestamp queries. Wall time from
+			submission to observed completion if the transfer queue has no timestamp support.	*/
+		double copySeconds;
+		double totalSeconds;
+
+		double getReadThroughput() const noexcept { return readSeconds > 0 ? nrBytes / readSeconds / 1e9 : 0; }
+		double getCopyThroughput() const noexcept { return copySeconds > 0 ? nrBytes / copySeconds / 1e9 : 0; }
+		double getTotalThroughput() const noexcept { return totalSeconds > 0 ? nrBytes / totalSeconds / 1e9 : 0; }
+	};
+
+	/**
+	 * @brief Construct a new VKStreamLoader object
+	 *
+	 * @param device
+	 * @param chunkSize size of each read and copy.
+	 * @param nrChunksInFlight number of staging chunks.
+	 * @param nrThreads number of read threads when io_uring is not used, 0 for nrChunksInFlight.
+	 */
+	VKStreamLoader(const std::shared_ptr<VKDevice> &device, VkDeviceSize chunkSize = 8 * 1024 * 1024,
+				   unsigned int nrChunksInFlight = 4, unsigned int nrThreads = 0);
+	VKStreamLoader(const VKStreamLoader &) = delete;
+	VKStreamLoader(VKStreamLoader &&) = delete;
+	~VKStreamLoader();
+
+	/**
+	 * @brief Load a range of the file into the buffer and wait for it to complete.
+	 *
+	 * @param path
+	 * @param dst buffer created with VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+	 * @param dstOffset
+	 * @param fileOffset
+	 * @param size number of bytes, 0 for the remainder of the file.
+	 * @param dstQueueFamilyIndex queue family that uses the buffer afterwards. For an exclusive buffer
+	 * and a family other than the one copying, ownership of the range is released from the copy
+	 * queue and acquired on the default queue of that family. VK_QUEUE_FAMILY_IGNORED to skip.
+	 * @return Statistics throughput of each stage.
+	 */
+	Statistics loadBuffer(const std::string &path, VkBuffer dst, VkDeviceSize dstOffset = 0, uint64_t fileOffset = 0,
+						  uint64_t size = 0, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
+
+	/**
+	 * @brief Check if reads are issued with io_uring.
+	 */
+	bool isIOUringEnabled() const noexcept;
+
+	VkDeviceSize getChunkSize() const noexcept { return this->chunkSize; }
+	unsigned int getNrChunksInFlight() const noexcept { return this->slots.size(); }
+
+	/*	File read backend, defined in the implementation.	*/
+	class Reader;
+
+  private:
+	void transferOwnership(VkBuffer dst, VkDeviceSize offset, VkDeviceSize size, uint32_t dstQueueFamilyIndex);
+
+	struct Slot {
+		VkCommandBuffer cmd;
+		VkFence fence;
+		uint8_t *mapped;
+		uint64_t fileOffset;
+		VkDeviceSize size;
+		bool copying;
+	};
+
+	std::shared_ptr<VKDevice> device;
+	VkQueue queue;
+	uint32_t queueFamilyIndex;
+	VkCommandPool commandPool;
+	/*	Two timestamps per slot around its copy, null if the queue has no timestamp support.	*/
+	VkQueryPool queryPool;
+	uint64_t timestampMask;
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	VkDeviceSize chunkSize;
+	std::vector<Slot> slots;
+	std::unique_ptr<Reader> reader;
+};
+
+#endif
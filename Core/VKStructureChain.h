@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_STRUCTURE_CHAIN_H_
+#define _FVK_VK_STRUCTURE_CHAIN_H_ 1
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vulkan/vulkan.h>
+
+/**
+ * @brief Compile-time mapping from a Vulkan structure to its VkStructureType.
+ * Add a FVK_STRUCTURE_TYPE specialization to make a structure usable in VKStructureChain.
+ *
+ * @tparam T
+ */
+template <typename T> struct VKStructureType;
+
+#define FVK_STRUCTURE_TYPE(T, Type)                                                                                    \
+	template <> struct VKStructureType<T> {                                                                            \
+		static constexpr VkStructureType value = Type;                                                                 \
+	};
+
+/*	Chain roots.	*/
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceFeatures2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceProperties2, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2)
+FVK_STRUCTURE_TYPE(VkInstanceCreateInfo, VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO)
+FVK_STRUCTURE_TYPE(VkDeviceCreateInfo, VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO)
+FVK_STRUCTURE_TYPE(VkSubmitInfo, VK_STRUCTURE_TYPE_SUBMIT_INFO)
+FVK_STRUCTURE_TYPE(VkMemoryAllocateInfo, VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO)
+
+/*	Features.	*/
+FVK_STRUCTURE_TYPE(VkPhysicalDevice16BitStorageFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceMultiviewFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVariablePointersFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VARIABLE_POINTERS_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceSamplerYcbcrConversionFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLER_YCBCR_CONVERSION_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceShaderDrawParametersFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES)
+#ifdef VK_VERSION_1_2
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan11Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan12Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDevice8BitStorageFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceShaderFloat16Int8Features,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceDescriptorIndexingFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceTimelineSemaphoreFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceBufferDeviceAddressFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceScalarBlockLayoutFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceHostQueryResetFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES)
+#endif
+#ifdef VK_VERSION_1_3
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan13Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceSynchronization2Features,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceDynamicRenderingFeatures,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceMaintenance4Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_FEATURES)
+#endif
+
+/*	Properties.	*/
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceSubgroupProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceIDProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceMaintenance3Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_3_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceMultiviewProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceExternalMemoryHostPropertiesEXT,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT)
+#ifdef VK_VERSION_1_2
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan11Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan12Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceDriverProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceDescriptorIndexingProperties,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceTimelineSemaphoreProperties,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceFloatControlsProperties,
+				   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FLOAT_CONTROLS_PROPERTIES)
+#endif
+#ifdef VK_VERSION_1_3
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceVulkan13Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES)
+FVK_STRUCTURE_TYPE(VkPhysicalDeviceMaintenance4Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_PROPERTIES)
+#endif
+
+/*	Instance and device creation.	*/
+FVK_STRUCTURE_TYPE(VkDebugUtilsMessengerCreateInfoEXT, VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT)
+FVK_STRUCTURE_TYPE(VkValidationFeaturesEXT, VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT)
+FVK_STRUCTURE_TYPE(VkDeviceGroupDeviceCreateInfo, VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO)
+
+/**
+ * @brief Chain of Vulkan structures stored in a single object, with every sType set and the
+ * pNext pointers linked in declaration order when constructed. Structures are zero
+ * initialized and accessed by type.
+ *
+ * @code
+ * VKStructureChain<VkPhysicalDeviceFeatures2, VkPhysicalDeviceVulkan12Features> features;
+ * physicalDevice->getFeatures(features);
+ * if (features.get<VkPhysicalDeviceVulkan12Features>().timelineSemaphore) ...
+ * @endcode
+ *
+ * @tparam Root first structure, the one passed to Vulkan.
+ * @tparam Ts structures linked after the root, each type may only occur once.
+ */
+template <typename Root, typename... Ts> class VKStructureChain {
+  public:
+	static constexpr size_t size = sizeof...(Ts) + 1;
+
+	VKStructureChain() noexcept : structures() { this->link(std::make_index_sequence<size>()); }
+	VKStructureChain(const VKStructureChain &other) noexcept : structures(other.structures) {
+		this->link(std::make_index_sequence<size>());
+	}
+	VKStructureChain &operator=(const VKStructureChain &other) noexcept {
+		this->structures = other.structures;
+		this->link(std::make_index_sequence<size>());
+		return *this;
+	}
+
+	/**
+	 * @brief Get structure in the chain by type.
+	 */
+	template <typename T> T &get() noexcept { return std::get<T>(this->structures); }
+	template <typename T> const T &get() const noexcept { return std::get<T>(this->structures); }
+
+	Root &root() noexcept { return std::get<0>(this->structures); }
+	const Root &root() const noexcept { return std::get<0>(this->structures); }
+
+	/**
+	 * @brief Get pointer to the root, to be used as pNext of another structure.
+	 */
+	void *data() noexcept { return &this->root(); }
+	const void *data() const noexcept { return &this->root(); }
+
+	/**
+	 * @brief Attach an external chain after the last structure.
+	 *
+	 * @param pNext
+	 */
+	void setNext(void *pNext) noexcept { std::get<size - 1>(this->structures).pNext = pNext; }
+
+  private:
+	template <size_t... I> void link(std::index_sequence<I...>) noexcept {
+		((std::get<I>(this->structures).sType =
+			  VKStructureType<std::tuple_element_t<I, std::tuple<Root, Ts...>>>::value),
+		 ...);
+		((std::get<I>(this->structures).pNext = I + 1 < size ? this->address<I + 1>() : nullptr), ...);
+	}
+
+	template <size_t I> void *address() noexcept {
+		if constexpr (I < size)
+			return &std::get<I>(this->structures);
+		else
+			return nullptr;
+	}
+
+	std::tuple<Root, Ts...> structures;
+};
+
+/**
+ * @brief Find structure in a pNext chain by its sType.
+ *
+ * @param pNext
+ * @param type
+ * @return const VkBaseInStructure* nullptr if not in the chain.
+ */
+inline const VkBaseInStructure *findStructure(const void *pNext, VkStructureType type) noexcept {
+	const VkBaseInStructure *structure = static_cast<const VkBaseInStructure *>(pNext);
+	while (structure != nullptr && structure->sType != type)
+		structure = structure->pNext;
+	return structure;
+}
+
+template <typename T> const T *findStructure(const void *pNext) noexcept {
+	return reinterpret_cast<const T *>(findStructure(pNext, VKStructureType<T>::value));
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include "VKSwapchain.h"
+#include <algorithm>
+#include <iterator>
+
+VKSwapchain::VKSwapchain(const std::shared_ptr<VKDevice> &device, VkSurfaceKHR surface, VkExtent2D extent,
+						 const SwapchainConfig &config)
+	: device(device), surface(surface), config(config), presentQueue(VK_NULL_HANDLE), swapchain(VK_NULL_HANDLE),
+	  usePresentFences(device->isExtensionEnabled(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME)), currentFrame(0),
+	  frameCounter(0) {
+
+	if (config.nrFramesInFlight == 0)
+		throw cxxexcept::RuntimeException("Number of frames in flight must be greater than 0");
+
+	/*	The default present family is the graphic family, which is not guaranteed to support the surface.	*/
+	const VkPhysicalDevice physicalDevice = device->getPhysicalDevice(0)->getHandle();
+	for (const uint32_t family : {device->getDefaultPresentQueueIndex(), device->getDefaultGraphicQueueIndex(),
+								  device->getDefaultComputeQueueIndex(), device->getDefaultTransferQueueIndex()}) {
+		if (family == UINT32_MAX)
+			continue;
+		VkBool32 supported = VK_FALSE;
+		VKS_VALIDATE(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, family, surface, &supported));
+		if (supported) {
+			vkGetDeviceQueue(device->getHandle(), family, 0, &this->presentQueue);
+			break;
+		}
+	}
+	if (this->presentQueue == VK_NULL_HANDLE)
+		throw cxxexcept::RuntimeException("Surface is not supported by any queue family of the device");
+
+	/*	Create the synchronization objects for each frame in flight.	*/
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	this->frames.resize(config.nrFramesInFlight);
+	for (FrameSync &frame : this->frames) {
+		VKS_VALIDATE(vkCreateSemaphore(device->getHandle(), &semaphoreCreateInfo, nullptr, &frame.imageAvailable));
+		VKS_VALIDATE(vkCreateSemaphore(device->getHandle(), &semaphoreCreateInfo, nullptr, &frame.renderFinished));
+		VKS_VALIDATE(vkCreateFence(device->getHandle(), &fenceCreateInfo, nullptr, &frame.inFlight));
+		frame.submitted = true;
+	}
+
+	this->createSwapchain(extent, VK_NULL_HANDLE);
+}
+
+VKSwapchain::~VKSwapchain() {
+	VkDevice handle = this->device->getHandle();
+
+	/*	Wait for the frames in flight, not the whole device. A frame acquired but not presented may
+		never have been submitted, its fence would never signal, thus wait for the device instead.	*/
+	bool pendingFrame = false;
+	for (const FrameSync &frame : this->frames)
+		pendingFrame |= !frame.submitted;
+	if (pendingFrame) {
+		vkDeviceWaitIdle(handle);
+	} else {
+		for (const FrameSync &frame : this->frames)
+			vkWaitForFences(handle, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+	}
+
+	this->releaseRetired(true);
+	this->recyclePresentFences(this->presentFences, true);
+
+	for (VkImageView imageView : this->imageViews)
+		VKHelper::destroyImageView(handle, imageView);
+	vkDestroySwapchainKHR(handle, this->swapchain, nullptr);
+
+	for (FrameSync &frame : this->frames) {
+		vkDestroySemaphore(handle, frame.imageAvailable, nullptr);
+		vkDestroySemaphore(handle, frame.renderFinished, nullptr);
+		vkDestroyFence(handle, frame.inFlight, nullptr);
+	}
+}
+
+void VKSwapchain::createSwapchain(VkExtent2D requestExtent, VkSwapchainKHR oldSwapchain) {
+	VkDevice handle = this->device->getHandle();
+	const VKHelper::SwapChainSupportDetails details =
+		VKHelper::querySwapChainSupport(this->device->getPhysicalDevice(0)->getHandle(), this->surface);
+
+	if (details.formats.empty() || details.presentModes.empty())
+		throw cxxexcept::RuntimeException("Surface does not support any format or present mode");
+
+	this->surfaceFormat = VKHelper::selectSurfaceFormat(details.formats, config.requestFormats, config.colorSpace);
+
+	/*	Mailbox and immediate does not block the acquire on vertical blank.	*/
+	const std::vector<VkPresentModeKHR> requestPresentModes =
+		config.lowLatency ? std::vector<VkPresentModeKHR>{VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR}
+						  : std::vector<VkPresentModeKHR>{VK_PRESENT_MODE_FIFO_KHR};
+	this->presentMode = VKHelper::chooseSwapPresentMode(details.presentModes, requestPresentModes);
+	this->extent = VKHelper::chooseSwapExtent(details.capabilities, requestExtent);
+
+	/*	One more image than frames in flight, to always have an image to acquire.	*/
+	uint32_t imageCount = std::max(details.capabilities.minImageCount + 1, config.nrFramesInFlight + 1);
+	if (details.capabilities.maxImageCount > 0)
+		imageCount = std::min(imageCount, details.capabilities.maxImageCount);
+
+	VkSwapchainCreateInfoKHR createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	createInfo.surface = this->surface;
+	createInfo.minImageCount = imageCount;
+	createInfo.imageFormat = this->surfaceFormat.format;
+	createInfo.imageColorSpace = this->surfaceFormat.colorSpace;
+	createInfo.imageExtent = this->extent;
+	createInfo.imageArrayLayers = 1;
+	createInfo.imageUsage = config.imageUsage;
+	createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	createInfo.preTransform = details.capabilities.currentTransform;
+	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	createInfo.presentMode = this->presentMode;
+	createInfo.clipped = VK_TRUE;
+	createInfo.oldSwapchain = oldSwapchain;
+
+	VKS_VALIDATE(vkCreateSwapchainKHR(handle, &createInfo, nullptr, &this->swapchain));
+
+	/*	*/
+	uint32_t nrImages = 0;
+	VKS_VALIDATE(vkGetSwapchainImagesKHR(handle, this->swapchain, &nrImages, nullptr));
+	this->images.resize(nrImages);
+	VKS_VALIDATE(vkGetSwapchainImagesKHR(handle, this->swapchain, &nrImages, this->images.data()));
+
+	this->imageViews.resize(nrImages);
+	for (uint32_t i = 0; i < nrImages; i++)
+		this->imageViews[i] = VKHelper::createImageView(handle, this->images[i], VK_IMAGE_VIEW_TYPE_2D,
+														this->surfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+	this->imagesInFlight.assign(nrImages, VK_NULL_HANDLE);
+}
+
+void VKSwapchain::recreate(VkExtent2D newExtent) {
+
+	/*	Keep the old swapchain alive until the frames that used it have retired.	*/
+	RetiredSwapchain old;
+	old.swapchain = this->swapchain;
+	old.imageViews = std::move(this->imageViews);
+	old.retireFrame = this->frameCounter;
+	old.presentFences = std::move(this->presentFences);
+	this->presentFences.clear();
+
+	this->createSwapchain(newExtent, old.swapchain);
+	this->retired.push_back(std::move(old));
+}
+
+void VKSwapchain::recyclePresentFences(std::vector<VkFence> &fences, bool wait) {
+	VkDevice handle = this->device->getHandle();
+	const VKDeviceDispatch &dispatch = this->device->getDispatch();
+	if (wait && !fences.empty())
+		VKS_VALIDATE(dispatch.vkWaitForFences(handle, fences.size(), fences.data(), VK_TRUE, UINT64_MAX));
+
+	auto end = std::partition(fences.begin(), fences.end(), [&](VkFence fence) {
+		return !wait && dispatch.vkGetFenceStatus(handle, fence) != VK_SUCCESS;
+	});
+	if (end != fences.end())
+		this->device->getSyncPool().releaseFences(&*end, std::distance(end, fences.end()));
+	fences.erase(end, fences.end());
+}
+
+void VKSwapchain::releaseRetired(bool force) {
+	VkDevice handle = this->device->getHandle();
+
+	bool queueIdle = false;
+	for (auto it = this->retired.begin(); it != this->retired.end();) {
+		bool completed;
+		if (this->usePresentFences) {
+			/*	Each present signaled a fence once the presentation engine no longer uses its image.	*/
+			this->recyclePresentFences(it->presentFences, force);
+			completed = it->presentFences.empty();
+		} else {
+			/*	A frame slot is reused after its fence has been waited on, thus after N frames the
+				rendering of all frames in flight at the retirement has completed. The presents have
+				no signal of their own, thus the present queue is waited idle.	*/
+			completed = force || this->frameCounter >= it->retireFrame + this->frames.size();
+			if (completed && !queueIdle) {
+				std::unique_lock<std::mutex> guard = this->device->lockQueue(this->presentQueue);
+				VKS_VALIDATE(this->device->getDispatch().vkQueueWaitIdle(this->presentQueue));
+				queueIdle = true;
+			}
+		}
+
+		if (completed) {
+			for (VkImageView imageView : it->imageViews)
+				VKHelper::destroyImageView(handle, imageView);
+			vkDestroySwapchainKHR(handle, it->swapchain, nullptr);
+			it = this->retired.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+void VKSwapchain::acquireNextFrame(Frame &frame) {
+	VkDevice handle = this->device->getHandle();
+	FrameSync &sync = this->frames[this->currentFrame];
+
+	/*	Only block if the CPU is N frames ahead.	*/
+	VKS_VALIDATE(vkWaitForFences(handle, 1, &sync.inFlight, VK_TRUE, UINT64_MAX));
+	this->releaseRetired(false);
+	this->recyclePresentFences(this->presentFences, false);
+	/*	Before the fence is reset, so objects last used in this frame are destroyed now.	*/
+	this->device->getDeletionQueue().collect();
+
+	uint32_t imageIndex;
+	const VKDeviceDispatch &dispatch = this->device->getDispatch();
+	VkResult result = dispatch.vkAcquireNextImageKHR(handle, this->swapchain, UINT64_MAX, sync.imageAvailable,
+													 VK_NULL_HANDLE, &imageIndex);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+		this->recreate(this->extent);
+		result = dispatch.vkAcquireNextImageKHR(handle, this->swapchain, UINT64_MAX, sync.imageAvailable,
+												VK_NULL_HANDLE, &imageIndex);
+	}
+	if (result != VK_SUBOPTIMAL_KHR)
+		VKS_VALIDATE(result);
+
+	/*	The image may still be used by an older frame, if more frames than images.	*/
+	if (this->imagesInFlight[imageIndex] != VK_NULL_HANDLE && this->imagesInFlight[imageIndex] != sync.inFlight)
+		VKS_VALIDATE(vkWaitForFences(handle, 1, &this->imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX));
+	this->imagesInFlight[imageIndex] = sync.inFlight;
+
+	VKS_VALIDATE(vkResetFences(handle, 1, &sync.inFlight));
+	sync.submitted = false;
+
+	frame.frameIndex = this->currentFrame;
+	frame.imageIndex = imageIndex;
+	frame.image = this->images[imageIndex];
+	frame.imageView = this->imageViews[imageIndex];
+	frame.imageAvailable = sync.imageAvailable;
+	frame.renderFinished = sync.renderFinished;
+	frame.inFlight = sync.inFlight;
+}
+
+bool VKSwapchain::present(const Frame &frame) {
+
+	VkPresentInfoKHR presentInfo = {};
+	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores = &frame.renderFinished;
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &this->swapchain;
+	presentInfo.pImageIndices = &frame.imageIndex;
+
+	VkFence presentFence = VK_NULL_HANDLE;
+	VkSwapchainPresentFenceInfoEXT presentFenceInfo = {};
+	if (this->usePresentFences) {
+		presentFence = this->device->getSyncPool().acquireFence();
+		presentFenceInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT;
+		presentFenceInfo.swapchainCount = 1;
+		presentFenceInfo.pFences = &presentFence;
+		presentInfo.pNext = &presentFenceInfo;
+	}
+
+	VkResult result;
+	{
+		std::unique_lock<std::mutex> guard = this->device->lockQueue(this->presentQueue);
+		result = this->device->getDispatch().vkQueuePresentKHR(this->presentQueue, &presentInfo);
+	}
+	/*	The fence is signaled for any present that was queued, including out of date ones.	*/
+	if (presentFence != VK_NULL_HANDLE) {
+		if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR)
+			this->presentFences.push_back(presentFence);
+	}
+	/*	Presenting waits on renderFinished, thus the frame's submission has been made.	*/
+	this->frames[frame.frameIndex].submitted = true;
+
+	this->currentFrame = (this->currentFrame + 1) % this->frames.size();
+	this->frameCounter++;
+
+	/*	Present-to-present latency.	*/
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (this->latency.nrPresents > 0) {
+		const double elapsed = std::chrono::duration<double, std::milli>(now - this->lastPresent).count();
+		const uint64_t nrIntervals = this->latency.nrPresents;
+		this->latency.lastMs = elapsed;
+		this->latency.minMs = nrIntervals == 1 ? elapsed : std::min(this->latency.minMs, elapsed);
+		this->latency.maxMs = std::max(this->latency.maxMs, elapsed);
+		this->latency.averageMs += (elapsed - this->latency.averageMs) / static_cast<double>(nrIntervals);
+	}
+	this->latency.nrPresents++;
+	this->lastPresent = now;
+
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+		this->recreate(this->extent);
+		return false;
+	}
+	VKS_VALIDATE(result);
+	return true;
+}
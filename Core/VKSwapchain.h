@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_SWAPCHAIN_H_
+#define _FVK_VK_SWAPCHAIN_H_ 1
+#include "VKDevice.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Swapchain with N frames in flight.
+ * Each frame in flight has its own acquire/render semaphores and fence, thus the
+ * CPU is only blocked when it is N frames ahead of the GPU, never on the queue.
+ */
+class FVK_DECL_EXTERN VKSwapchain {
+  public:
+	struct SwapchainConfig {
+		uint32_t nrFramesInFlight = 2;
+		/*	Prefer mailbox, then immediate when available, otherwise FIFO.	*/
+		bool lowLatency = true;
+		std::vector<VkSurfaceFormatKHR> requestFormats = {{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+														  {VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}};
+		VkColorSpaceKHR colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+		VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	};
+
+	/**
+	 * @brief Frame data returned by acquireNextFrame.
+	 * The rendering submission should wait on imageAvailable, signal renderFinished
+	 * and signal the inFlight fence.
+	 */
+	struct Frame {
+		uint32_t frameIndex;
+		uint32_t imageIndex;
+		VkImage image;
+		VkImageView imageView;
+		VkSemaphore imageAvailable;
+		VkSemaphore renderFinished;
+		VkFence inFlight;
+	};
+
+	/**
+	 * @brief Present-to-present latency statistics in milliseconds.
+	 */
+	struct LatencyStatistics {
+		uint64_t nrPresents = 0;
+		double lastMs = 0.0;
+		double minMs = 0.0;
+		double maxMs = 0.0;
+		double averageMs = 0.0;
+	};
+
+	/**
+	 * @brief Construct a new VKSwapchain object
+	 * Presents on the first device queue whose family supports the surface, the default present
+	 * queue is tried first. Throws if no queue of the device can present to the surface.
+	 *
+	 * @param device
+	 * @param surface
+	 * @param extent
+	 * @param config
+	 */
+	VKSwapchain(const std::shared_ptr<VKDevice> &device, VkSurfaceKHR surface, VkExtent2D extent,
+				const SwapchainConfig &config = {});
+	VKSwapchain(const VKSwapchain &) = delete;
+	VKSwapchain(VKSwapchain &&) = delete;
+	~VKSwapchain();
+
+	/**
+	 * @brief Acquire the next frame.
+	 * Blocks only if the frame that is reused is still in flight. The swapchain
+	 * is recreated if it is out of date.
+	 *
+	 * @param frame
+	 */
+	void acquireNextFrame(Frame &frame);
+
+	/**
+	 * @brief Present the frame, waiting on the renderFinished semaphore.
+	 *
+	 * @param frame
+	 * @return true if presented, false if the swapchain was recreated.
+	 */
+	bool present(const Frame &frame);
+
+	/**
+	 * @brief Recreate the swapchain with a new size.
+	 * The old swapchain is passed as oldSwapchain and released once its presents have completed.
+	 * With VK_EXT_swapchain_maintenance1 enabled on the device, and its swapchainMaintenance1
+	 * feature, every present signals a fence and the old swapchain is released without blocking.
+	 * Otherwise presents have no completion signal, the old swapchain is released after the
+	 * fences of all frames in flight at the time were waited on, and the present queue is idle.
+	 *
+	 * @param extent
+	 */
+	void recreate(VkExtent2D extent);
+
+	VkSwapchainKHR getHandle() const noexcept { return this->swapchain; }
+	VkQueue getPresentQueue() const noexcept { return this->presentQueue; }
+	VkFormat getFormat() const noexcept { return this->surfaceFormat.format; }
+	VkExtent2D getExtent() const noexcept { return this->extent; }
+	VkPresentModeKHR getPresentMode() const noexcept { return this->presentMode; }
+	uint32_t getNrImages() const noexcept { return this->images.size(); }
+	uint32_t getNrFramesInFlight() const noexcept { return this->frames.size(); }
+	const LatencyStatistics &getLatencyStatistics() const noexcept { return this->latency; }
+
+  private:
+	struct FrameSync {
+		VkSemaphore imageAvailable;
+		VkSemaphore renderFinished;
+		VkFence inFlight;
+		/*	False between acquireNextFrame resetting the fence and the frame being presented.	*/
+		bool submitted;
+	};
+
+	struct RetiredSwapchain {
+		VkSwapchainKHR swapchain;
+		std::vector<VkImageView> imageViews;
+		uint64_t retireFrame;
+		/*	Fences of the presents still pending at the retirement, from the device sync pool.	*/
+		std::vector<VkFence> presentFences;
+	};
+
+	void createSwapchain(VkExtent2D extent, VkSwapchainKHR oldSwapchain);
+	void releaseRetired(bool force);
+	/*	Return the signaled present fences to the sync pool, or wait for all of them.	*/
+	void recyclePresentFences(std::vector<VkFence> &fences, bool wait);
+
+	std::shared_ptr<VKDevice> device;
+	VkSurfaceKHR surface;
+	SwapchainConfig config;
+	VkQueue presentQueue;
+
+	VkSwapchainKHR swapchain;
+	VkSurfaceFormatKHR surfaceFormat;
+	VkPresentModeKHR presentMode;
+	VkExtent2D extent;
+	std::vector<VkImage> images;
+	std::vector<VkImageView> imageViews;
+	std::vector<VkFence> imagesInFlight;
+	/*	True if presents signal a fence, VK_EXT_swapchain_maintenance1.	*/
+	bool usePresentFences;
+	std::vector<VkFence> presentFences;
+
+	std::vector<FrameSync> frames;
+	std::vector<RetiredSwapchain> retired;
+	uint32_t currentFrame;
+	uint64_t frameCounter;
+
+	LatencyStatistics latency;
+	std::chrono::steady_clock::time_point lastPresent;
+};
+
+#endif
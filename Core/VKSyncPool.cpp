@@ -0,0 +1,193 @@
+#include "VKSyncPool.h"
+
+VKSyncPool::VKSyncPool(VkDevice device, const VKDeviceDispatch &dispatch, bool timelineSemaphore,
+					   VKArrayView<VkQueue> queues, const VKQueueLocks *queueLocks)
+	: device(device), dispatch(dispatch), queueLocks(queueLocks), statistics{} {
+
+	/*	The table resolves the KHR entry points when the device is older than 1.2.	*/
+	if (!timelineSemaphore || dispatch.vkGetSemaphoreCounterValue == nullptr || dispatch.vkWaitSemaphores == nullptr)
+		return;
+	if (queues.size() > MaxTimelines)
+		throw cxxexcept::RuntimeException("At most {} queues can have a timeline, got {}", MaxTimelines,
+										  queues.size());
+
+	VkSemaphoreTypeCreateInfo typeInfo = {};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	this->timelines.reserve(queues.size());
+	for (VkQueue queue : queues) {
+		VkSemaphore semaphore;
+		VKS_VALIDATE(dispatch.vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+		this->timelines.push_back({queue, semaphore, 0});
+	}
+}
+
+VKSyncPool::~VKSyncPool() {
+	for (VkFence fence : this->freeFences)
+		this->dispatch.vkDestroyFence(this->device, fence, nullptr);
+	for (VkFence fence : this->releasedFences)
+		this->dispatch.vkDestroyFence(this->device, fence, nullptr);
+	for (VkSemaphore semaphore : this->freeSemaphores)
+		this->dispatch.vkDestroySemaphore(this->device, semaphore, nullptr);
+	for (const Timeline &timeline : this->timelines)
+		this->dispatch.vkDestroySemaphore(this->device, timeline.semaphore, nullptr);
+}
+
+VkFence VKSyncPool::acquireFence() {
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->statistics.nrFencesAcquired++;
+
+	/*	Reset all released fences at once.	*/
+	if (this->freeFences.empty() && !this->releasedFences.empty()) {
+		VKS_VALIDATE(
+			this->dispatch.vkResetFences(this->device, this->releasedFences.size(), this->releasedFences.data()));
+		this->statistics.nrFenceResets++;
+		this->freeFences.swap(this->releasedFences);
+	}
+
+	if (!this->freeFences.empty()) {
+		VkFence fence = this->freeFences.back();
+		this->freeFences.pop_back();
+		return fence;
+	}
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	VkFence fence;
+	VKS_VALIDATE(this->dispatch.vkCreateFence(this->device, &fenceInfo, nullptr, &fence));
+	this->statistics.nrFencesCreated++;
+	return fence;
+}
+
+void VKSyncPool::releaseFences(const VkFence *fences, uint32_t nrFences) {
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->releasedFences.insert(this->releasedFences.end(), fences, fences + nrFences);
+}
+
+VkSemaphore VKSyncPool::acquireSemaphore() {
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->statistics.nrSemaphoresAcquired++;
+
+	if (!this->freeSemaphores.empty()) {
+		VkSemaphore semaphore = this->freeSemaphores.back();
+		this->freeSemaphores.pop_back();
+		return semaphore;
+	}
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	VkSemaphore semaphore;
+	VKS_VALIDATE(this->dispatch.vkCreateSemaphore(this->device, &semaphoreInfo, nullptr, &semaphore));
+	this->statistics.nrSemaphoresCreated++;
+	return semaphore;
+}
+
+void VKSyncPool::releaseSemaphore(VkSemaphore semaphore) {
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->freeSemaphores.push_back(semaphore);
+}
+
+const VKSyncPool::Timeline &VKSyncPool::getTimeline(uint32_t timeline) const {
+	if (!this->isTimelineSupported())
+		throw cxxexcept::RuntimeException("Timeline semaphore not supported");
+	if (timeline >= this->timelines.size())
+		throw cxxexcept::RuntimeException("Timeline {} out of range, the pool has {}", timeline,
+										  this->timelines.size());
+	return this->timelines[timeline];
+}
+
+VkSemaphore VKSyncPool::getTimelineSemaphore(VkQueue queue) const noexcept {
+	for (const Timeline &timeline : this->timelines) {
+		if (timeline.queue == queue)
+			return timeline.semaphore;
+	}
+	return VK_NULL_HANDLE;
+}
+
+uint64_t VKSyncPool::getCompletedTimelineValue(uint32_t timeline) const {
+	uint64_t value;
+	VKS_VALIDATE(
+		this->dispatch.vkGetSemaphoreCounterValue(this->device, this->getTimeline(timeline).semaphore, &value));
+	return value;
+}
+
+bool VKSyncPool::waitTimeline(VKArrayView<TimelinePoint> points, bool waitAll, uint64_t timeout) const {
+	VKSmallVector<VkSemaphore, MaxTimelines> semaphores;
+	VKSmallVector<uint64_t, MaxTimelines> values;
+	for (const TimelinePoint &point : points) {
+		semaphores.push_back(this->getTimeline(point.timeline).semaphore);
+		values.push_back(point.value);
+	}
+	if (semaphores.empty())
+		return true;
+
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.flags = waitAll ? 0 : VK_SEMAPHORE_WAIT_ANY_BIT;
+	waitInfo.semaphoreCount = semaphores.size();
+	waitInfo.pSemaphores = semaphores.data();
+	waitInfo.pValues = values.data();
+
+	const VkResult result = this->dispatch.vkWaitSemaphores(this->device, &waitInfo, timeout);
+	if (result == VK_TIMEOUT)
+		return false;
+	VKS_VALIDATE(result);
+	return true;
+}
+
+VKSyncPool::TimelinePoint VKSyncPool::submitTimeline(VkQueue queue, VKArrayView<VkCommandBuffer> cmds,
+													 VKArrayView<VkSemaphore> waitSemaphores,
+													 VKArrayView<VkPipelineStageFlags> waitStages) {
+	if (!this->isTimelineSupported())
+		throw cxxexcept::RuntimeException("Timeline semaphore not supported");
+	if (waitSemaphores.size() != waitStages.size())
+		throw cxxexcept::RuntimeException("Number of wait semaphores {} does not match the number of wait stages {}",
+										  waitSemaphores.size(), waitStages.size());
+
+	uint32_t index = 0;
+	while (index < this->timelines.size() && this->timelines[index].queue != queue)
+		index++;
+	if (index == this->timelines.size())
+		throw cxxexcept::RuntimeException("Queue {} has no timeline", static_cast<const void *>(queue));
+	Timeline &timeline = this->timelines[index];
+
+	/*	Held from reserving the value to the submit, so the queue signals its timeline in increasing order.
+		Without queue locks the pool lock serializes all timeline submits instead.	*/
+	std::unique_lock<std::mutex> guard =
+		this->queueLocks != nullptr ? this->queueLocks->lock(queue) : std::unique_lock<std::mutex>(this->lock);
+	const uint64_t signalValue = ++timeline.value;
+	/*	Values are ignored for binary semaphores.	*/
+	const VKSmallVector<uint64_t, 8> waitValues(waitSemaphores.size());
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = waitValues.size();
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = waitSemaphores.size();
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.commandBufferCount = cmds.size();
+	submitInfo.pCommandBuffers = cmds.data();
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &timeline.semaphore;
+
+	VKS_VALIDATE(this->dispatch.vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+	return {index, signalValue};
+}
+
+VKSyncPool::Statistics VKSyncPool::getStatistics() const {
+	std::unique_lock<std::mutex> guard(this->lock);
+	return this->statistics;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_SYNC_POOL_H_
+#define _FVK_VK_SYNC_POOL_H_ 1
+#include "VKContainers.h"
+#include "VKDispatch.h"
+#include "VKThreadSafety.h"
+#include "VKUtil.h"
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Pool of fences and binary semaphores that are recycled instead of destroyed.
+ * Released fences are reset in bulk with a single vkResetFences when the free list runs out.
+ * If timeline semaphores are enabled on the device, each queue of the pool gets a timeline that
+ * can be used in place of most fences. A timeline is only signaled by its own queue, since
+ * queues may complete out of order and a timeline value must never decrease.
+ *
+ * Thread safe.
+ */
+class FVK_DECL_EXTERN VKSyncPool {
+  public:
+	/*	Max number of queues with a timeline, the device creates one queue per family.	*/
+	static constexpr uint32_t MaxTimelines = 4;
+
+	/**
+	 * @brief A value on the timeline of one of the queues, returned by submitTimeline.
+	 * A default constructed point is reached immediately.
+	 */
+	struct TimelinePoint {
+		/*	Index of the queue timeline.	*/
+		uint32_t timeline = 0;
+		uint64_t value = 0;
+	};
+
+	struct Statistics {
+		uint64_t nrFencesCreated;
+		uint64_t nrSemaphoresCreated;
+		uint64_t nrFencesAcquired;
+		uint64_t nrSemaphoresAcquired;
+		/*	Number of vkResetFences calls.	*/
+		uint64_t nrFenceResets;
+	};
+
+	/**
+	 * @brief Construct a new VKSyncPool object
+	 *
+	 * @param device
+	 * @param dispatch device function table, must outlive the pool.
+	 * @param timelineSemaphore true if the timelineSemaphore feature is enabled on the device.
+	 * @param queues queues submitTimeline can be used with, each gets its own timeline.
+	 * @param queueLocks optional per-queue locks taken around submission.
+	 */
+	VKSyncPool(VkDevice device, const VKDeviceDispatch &dispatch, bool timelineSemaphore,
+			   VKArrayView<VkQueue> queues = {}, const VKQueueLocks *queueLocks = nullptr);
+	VKSyncPool(const VKSyncPool &) = delete;
+	VKSyncPool(VKSyncPool &&) = delete;
+	~VKSyncPool();
+
+	/**
+	 * @brief Get an unsignaled fence.
+	 *
+	 * @return VkFence
+	 */
+	VkFence acquireFence();
+
+	/**
+	 * @brief Return fences to the pool. The fences must either be signaled or never submitted.
+	 *
+	 * @param fences
+	 * @param nrFences
+	 */
+	void releaseFences(const VkFence *fences, uint32_t nrFences);
+	void releaseFence(VkFence fence) { this->releaseFences(&fence, 1); }
+
+	/**
+	 * @brief Get an unsignaled binary semaphore.
+	 *
+	 * @return VkSemaphore
+	 */
+	VkSemaphore acquireSemaphore();
+
+	/**
+	 * @brief Return a binary semaphore to the pool. The submission waiting on the semaphore
+	 * must have completed.
+	 *
+	 * @param semaphore
+	 */
+	void releaseSemaphore(VkSemaphore semaphore);
+
+	bool isTimelineSupported() const noexcept { return !this->timelines.empty(); }
+	uint32_t getNrTimelines() const noexcept { return this->timelines.size(); }
+
+	/**
+	 * @brief Get the timeline semaphore of the queue, for waiting on a TimelinePoint from another
+	 * submission. VK_NULL_HANDLE if not supported or the queue is not one of the pool.
+	 *
+	 * @param queue
+	 * @return VkSemaphore
+	 */
+	VkSemaphore getTimelineSemaphore(VkQueue queue) const noexcept;
+
+	/**
+	 * @brief Get the timeline semaphore by its index, see TimelinePoint::timeline.
+	 *
+	 * @param timeline
+	 * @return VkSemaphore
+	 */
+	VkSemaphore getTimelineSemaphore(uint32_t timeline) const { return this->getTimeline(timeline).semaphore; }
+
+	/**
+	 * @brief Get the last value the device has signaled on the timeline.
+	 *
+	 * @param timeline index of the queue timeline.
+	 * @return uint64_t
+	 */
+	uint64_t getCompletedTimelineValue(uint32_t timeline) const;
+
+	/**
+	 * @brief Wait until the timelines have reached the values.
+	 *
+	 * @param points
+	 * @param waitAll wait for all of the points, otherwise any of them.
+	 * @param timeout in nanoseconds.
+	 * @return true if reached, false on timeout.
+	 */
+	bool waitTimeline(VKArrayView<TimelinePoint> points, bool waitAll = true, uint64_t timeout = UINT64_MAX) const;
+
+	/**
+	 * @brief Submit command buffers that signal the next value of the queue's timeline on
+	 * completion. Values are only reserved here, so every reserved value is signaled in order.
+	 *
+	 * @param queue one of the queues the pool was created with.
+	 * @param cmds
+	 * @param waitSemaphores binary semaphores to wait on.
+	 * @param waitStages
+	 * @return TimelinePoint reached once the submission completes.
+	 */
+	TimelinePoint submitTimeline(VkQueue queue, VKArrayView<VkCommandBuffer> cmds,
+								 VKArrayView<VkSemaphore> waitSemaphores = {},
+								 VKArrayView<VkPipelineStageFlags> waitStages = {});
+
+	Statistics getStatistics() const;
+
+  private:
+	struct Timeline {
+		VkQueue queue;
+		VkSemaphore semaphore;
+		/*	Last reserved value, only accessed while submitting to the queue.	*/
+		uint64_t value;
+	};
+
+	const Timeline &getTimeline(uint32_t timeline) const;
+
+	VkDevice device;
+	const VKDeviceDispatch &dispatch;
+	const VKQueueLocks *queueLocks;
+	/*	Created with the pool and never resized, thus read without locking.	*/
+	std::vector<Timeline> timelines;
+
+	std::vector<VkFence> freeFences;
+	std::vector<VkFence> releasedFences;
+	std::vector<VkSemaphore> freeSemaphores;
+	Statistics statistics;
+	mutable std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "VKThreadPool.h"
+#include <algorithm>
+#include <exception>
+
+VKThreadPool::VKThreadPool(unsigned int nrThreads) : nrQueued(0), nrPending(0), nextWorker(0), quit(false) {
+	if (nrThreads == 0)
+		nrThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	this->workers.resize(nrThreads);
+	for (unsigned int i = 0; i < nrThreads; i++)
+		this->workers[i] = std::make_unique<Worker>();
+	for (unsigned int i = 0; i < nrThreads; i++)
+		this->workers[i]->thread = std::thread(&VKThreadPool::run, this, i);
+}
+
+VKThreadPool::~VKThreadPool() {
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->quit = true;
+	}
+	this->taskCondition.notify_all();
+	for (auto &worker : this->workers)
+		worker->thread.join();
+}
+
+void VKThreadPool::submit(Task task) {
+	unsigned int workerIndex;
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		workerIndex = this->nextWorker;
+		this->nextWorker = (this->nextWorker + 1) % this->workers.size();
+		this->nrPending++;
+	}
+
+	{
+		Worker &worker = *this->workers[workerIndex];
+		std::unique_lock<std::mutex> guard(worker.lock);
+		worker.tasks.push_back(std::move(task));
+	}
+
+	/*	Only announce the task once it can be popped.	*/
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->nrQueued++;
+	}
+	this->taskCondition.notify_one();
+}
+
+void VKThreadPool::wait() {
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->idleCondition.wait(guard, [this] { return this->nrPending == 0; });
+}
+
+void VKThreadPool::parallelFor(unsigned int count, const IndexTask &task) {
+	struct {
+		std::mutex lock;
+		std::condition_variable condition;
+		unsigned int remaining;
+		std::exception_ptr exception;
+	} state;
+	state.remaining = count;
+
+	for (unsigned int i = 0; i < count; i++) {
+		this->submit([&state, &task, i](unsigned int workerIndex) {
+			std::exception_ptr exception;
+			try {
+				task(i, workerIndex);
+			} catch (...) {
+				exception = std::current_exception();
+			}
+
+			std::unique_lock<std::mutex> guard(state.lock);
+			if (exception && !state.exception)
+				state.exception = exception;
+			if (--state.remaining == 0)
+				state.condition.notify_all();
+		});
+	}
+
+	std::unique_lock<std::mutex> guard(state.lock);
+	state.condition.wait(guard, [&state] { return state.remaining == 0; });
+	if (state.exception)
+		std::rethrow_exception(state.exception);
+}
+
+bool VKThreadPool::popTask(unsigned int workerIndex, Task &task) {
+	/*	Own queue first, newest task since it is most likely still in cache.	*/
+	{
+		Worker &worker = *this->workers[workerIndex];
+		std::unique_lock<std::mutex> guard(worker.lock);
+		if (!worker.tasks.empty()) {
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			return true;
+		}
+	}
+
+	/*	Steal the oldest task from the other workers.	*/
+	for (unsigned int i = 1; i < this->workers.size(); i++) {
+		Worker &victim = *this->workers[(workerIndex + i) % this->workers.size()];
+		std::unique_lock<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void VKThreadPool::run(unsigned int workerIndex) {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->taskCondition.wait(guard, [this] { return this->quit || this->nrQueued > 0; });
+			if (this->quit && this->nrQueued == 0)
+				return;
+		}
+
+		Task task;
+		if (!this->popTask(workerIndex, task)) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->nrQueued--;
+		}
+
+		task(workerIndex);
+
+		std::unique_lock<std::mutex> guard(this->lock);
+		if (--this->nrPending == 0)
+			this->idleCondition.notify_all();
+	}
+}
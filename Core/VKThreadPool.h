@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_THREAD_POOL_H_
+#define _FVK_VK_THREAD_POOL_H_ 1
+#include "VKUtil.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool. Each worker has its own task queue, tasks are pushed in
+ * round-robin order and an idle worker steals from the other queues. The worker index is passed
+ * to the task, allowing per-thread resources such as command pools.
+ */
+class FVK_DECL_EXTERN VKThreadPool {
+  public:
+	using Task = std::function<void(unsigned int workerIndex)>;
+	using IndexTask = std::function<void(unsigned int index, unsigned int workerIndex)>;
+
+	/**
+	 * @brief Construct a new VKThreadPool object
+	 *
+	 * @param nrThreads number of workers, 0 uses the number of hardware threads.
+	 */
+	VKThreadPool(unsigned int nrThreads = 0);
+	VKThreadPool(const VKThreadPool &) = delete;
+	VKThreadPool(VKThreadPool &&) = delete;
+	~VKThreadPool();
+
+	/**
+	 * @brief Queue a task for execution on any of the workers, the task must not throw.
+	 *
+	 * @param task
+	 */
+	void submit(Task task);
+
+	/**
+	 * @brief Wait until all submitted tasks have finished.
+	 */
+	void wait();
+
+	/**
+	 * @brief Run task for each index in [0, count) and wait for them to finish.
+	 * The first exception thrown by a task is rethrown on the calling thread.
+	 *
+	 * @param count
+	 * @param task
+	 */
+	void parallelFor(unsigned int count, const IndexTask &task);
+
+	unsigned int getNrThreads() const noexcept { return this->workers.size(); }
+
+  private:
+	struct Worker {
+		std::mutex lock;
+		std::deque<Task> tasks;
+		std::thread thread;
+	};
+
+	bool popTask(unsigned int workerIndex, Task &task);
+	void run(unsigned int workerIndex);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::mutex lock;
+	std::condition_variable taskCondition;
+	std::condition_variable idleCondition;
+	size_t nrQueued;
+	size_t nrPending;
+	unsigned int nextWorker;
+	bool quit;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "VKThreadSafety.h"
+#include <thread>
+#include <unordered_map>
+
+void VKQueueLocks::addQueue(VkQueue queue) {
+	if (queue == VK_NULL_HANDLE)
+		return;
+	for (const std::pair<VkQueue, std::unique_ptr<std::mutex>> &entry : this->queues) {
+		if (entry.first == queue)
+			return;
+	}
+	this->queues.emplace_back(queue, std::make_unique<std::mutex>());
+}
+
+std::unique_lock<std::mutex> VKQueueLocks::lock(VkQueue queue) const {
+	/*	Only a handful of queues, a linear search beats hashing.	*/
+	for (const std::pair<VkQueue, std::unique_ptr<std::mutex>> &entry : this->queues) {
+		if (entry.first == queue)
+			return std::unique_lock<std::mutex>(*entry.second);
+	}
+	throw cxxexcept::RuntimeException("Queue {} is not a queue of the device", static_cast<const void *>(queue));
+}
+
+namespace {
+	struct ExternalSyncOwner {
+		std::thread::id thread;
+		unsigned int depth;
+	};
+
+	std::mutex ownerLock;
+	std::unordered_map<uint64_t, ExternalSyncOwner> owners;
+} // namespace
+
+VKExternalSyncScope::VKExternalSyncScope(uint64_t handle, const char *name) : handle(handle) {
+	const std::thread::id current = std::this_thread::get_id();
+	std::lock_guard<std::mutex> guard(ownerLock);
+	ExternalSyncOwner &owner = owners[handle];
+	if (owner.depth > 0 && owner.thread != current)
+		throw cxxexcept::RuntimeException(
+			"Concurrent use of externally synchronized handle '{}' ({:#x}) from multiple threads", name, handle);
+	owner.thread = current;
+	owner.depth++;
+}
+
+VKExternalSyncScope::~VKExternalSyncScope() {
+	std::lock_guard<std::mutex> guard(ownerLock);
+	std::unordered_map<uint64_t, ExternalSyncOwner>::iterator it = owners.find(this->handle);
+	if (it != owners.end() && --it->second.depth == 0)
+		owners.erase(it);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_THREAD_SAFETY_H_
+#define _FVK_VK_THREAD_SAFETY_H_ 1
+#include "VKUtil.h"
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed table of one mutex per device queue. The table is built once when the device
+ * is created and never modified afterwards, so looking up a lock requires no synchronization.
+ * A mutex rather than a spinlock, since the lock is held across blocking calls such as
+ * vkQueueWaitIdle and vkQueuePresentKHR.
+ */
+class FVK_DECL_EXTERN VKQueueLocks {
+  public:
+	VKQueueLocks() = default;
+	VKQueueLocks(const VKQueueLocks &) = delete;
+	VKQueueLocks(VKQueueLocks &&) = delete;
+
+	/**
+	 * @brief Add a queue, must only be called before the table is shared between threads.
+	 * Queues that were already added are ignored.
+	 *
+	 * @param queue
+	 */
+	void addQueue(VkQueue queue);
+
+	/**
+	 * @brief Lock the queue for the duration of the returned lock.
+	 *
+	 * @param queue
+	 * @return std::unique_lock<std::mutex>
+	 */
+	std::unique_lock<std::mutex> lock(VkQueue queue) const;
+
+  private:
+	std::vector<std::pair<VkQueue, std::unique_ptr<std::mutex>>> queues;
+};
+
+/**
+ * @brief Debug detection of concurrent use of externally synchronized handles, such as command
+ * pools. The scope registers the calling thread as the owner of the handle, and throws if another
+ * thread already owns it. Nested scopes on the same thread are allowed.
+ * Use through FVK_EXTERNAL_SYNC_SCOPE, which is compiled out in release builds.
+ */
+class FVK_DECL_EXTERN VKExternalSyncScope {
+  public:
+	VKExternalSyncScope(uint64_t handle, const char *name);
+	VKExternalSyncScope(const VKExternalSyncScope &) = delete;
+	VKExternalSyncScope(VKExternalSyncScope &&) = delete;
+	~VKExternalSyncScope();
+
+	template <typename T> static uint64_t getKey(T handle) noexcept { return (uint64_t)handle; }
+
+  private:
+	uint64_t handle;
+};
+
+#define FVK_SYNC_CONCAT_IMPL(a, b) a##b
+#define FVK_SYNC_CONCAT(a, b) FVK_SYNC_CONCAT_IMPL(a, b)
+
+#ifdef _DEBUG
+#define FVK_EXTERNAL_SYNC_SCOPE(handle)                                                                                \
+	VKExternalSyncScope FVK_SYNC_CONCAT(_externalSyncScope, __LINE__)(VKExternalSyncScope::getKey(handle), #handle)
+#else
+#define FVK_EXTERNAL_SYNC_SCOPE(handle) ((void)(handle))
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+#include "VKTransientResourcePool.h"
+#include <algorithm>
+#include <numeric>
+
+static constexpr VkImageUsageFlags attachmentUsage =
+	VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+	VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+VKTransientResourcePool::VKTransientResourcePool(const std::shared_ptr<VKDevice> &device,
+												 VkMemoryPropertyFlags properties)
+	: device(device), properties(properties), compiled(false) {}
+
+VKTransientResourcePool::~VKTransientResourcePool() { this->reset(); }
+
+VKTransientResourcePool::ResourceHandle VKTransientResourcePool::addImage(const VkImageCreateInfo &createInfo,
+																		  bool transient) {
+	if (this->compiled)
+		throw cxxexcept::RuntimeException("Transient resource pool is already compiled");
+
+	Resource resource = {};
+	resource.imageCreateInfo = createInfo;
+	resource.isImage = true;
+	resource.linear = createInfo.tiling == VK_IMAGE_TILING_LINEAR;
+	resource.firstPass = UINT32_MAX;
+	resource.lastPass = 0;
+
+	/*	Transient attachment is only valid in combination with attachment usages.	*/
+	if (transient && (createInfo.usage & ~attachmentUsage) == 0) {
+		resource.imageCreateInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		resource.lazy = true;
+	}
+
+	this->resources.push_back(resource);
+	return this->resources.size() - 1;
+}
+
+VKTransientResourcePool::ResourceHandle VKTransientResourcePool::addBuffer(const VkBufferCreateInfo &createInfo) {
+	if (this->compiled)
+		throw cxxexcept::RuntimeException("Transient resource pool is already compiled");
+
+	Resource resource = {};
+	resource.bufferCreateInfo = createInfo;
+	resource.isImage = false;
+	resource.linear = true;
+	resource.firstPass = UINT32_MAX;
+	resource.lastPass = 0;
+
+	this->resources.push_back(resource);
+	return this->resources.size() - 1;
+}
+
+void VKTransientResourcePool::use(ResourceHandle resource, uint32_t pass) {
+	Resource &res = this->resources[resource];
+	res.firstPass = std::min(res.firstPass, pass);
+	res.lastPass = std::max(res.lastPass, pass);
+}
+
+bool VKTransientResourcePool::findOffset(const MemoryBlock &block, const Resource &resource,
+										 VkDeviceSize &offset) const {
+	const VkDeviceSize alignment = resource.memRequirements.alignment;
+	const VkDeviceSize size = resource.memRequirements.size;
+
+	/*	Resources alive at the same time as the resource.	*/
+	std::vector<const Resource *> overlapping;
+	for (const uint32_t index : block.resources) {
+		const Resource &other = this->resources[index];
+		if (other.firstPass <= resource.lastPass && resource.firstPass <= other.lastPass)
+			overlapping.push_back(&other);
+	}
+
+	/*	Candidates are the start of the block and the end of each overlapping resource.	*/
+	std::vector<VkDeviceSize> candidates = {0};
+	for (const Resource *other : overlapping) {
+		const VkDeviceSize end = other->offset + other->memRequirements.size;
+		candidates.push_back((end + alignment - 1) / alignment * alignment);
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	for (const VkDeviceSize candidate : candidates) {
+		if (candidate + size > block.size)
+			break;
+
+		const bool intersects = std::any_of(overlapping.begin(), overlapping.end(), [&](const Resource *other) {
+			return candidate < other->offset + other->memRequirements.size && other->offset < candidate + size;
+		});
+		if (!intersects) {
+			offset = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+void VKTransientResourcePool::compile(const VKCallSite &callSite) {
+	if (this->compiled)
+		throw cxxexcept::RuntimeException("Transient resource pool is already compiled");
+
+	/*	Do not leak what was created before a failure, the pool can be compiled again.	*/
+	try {
+		this->compileResources(callSite);
+	} catch (...) {
+		this->releaseObjects();
+		this->report = {};
+		throw;
+	}
+	this->compiled = true;
+}
+
+void VKTransientResourcePool::compileResources(const VKCallSite &callSite) {
+	VkDevice handle = this->device->getHandle();
+	const VKDeviceDispatch &table = this->device->getDispatch();
+	this->report = {};
+
+	/*	Create the resources in order to get the memory requirements.	*/
+	for (Resource &resource : this->resources) {
+		/*	Unused resources are considered alive for the whole frame.	*/
+		if (resource.firstPass > resource.lastPass) {
+			resource.firstPass = 0;
+			resource.lastPass = UINT32_MAX;
+		}
+
+		if (resource.isImage) {
+			VKS_VALIDATE(table.vkCreateImage(handle, &resource.imageCreateInfo, nullptr, &resource.image));
+			table.vkGetImageMemoryRequirements(handle, resource.image, &resource.memRequirements);
+			VKResourceTracker::recordCreate(VK_OBJECT_TYPE_IMAGE, (uint64_t)resource.image,
+											resource.memRequirements.size, callSite);
+		} else {
+			VKS_VALIDATE(table.vkCreateBuffer(handle, &resource.bufferCreateInfo, nullptr, &resource.buffer));
+			table.vkGetBufferMemoryRequirements(handle, resource.buffer, &resource.memRequirements);
+			VKResourceTracker::recordCreate(VK_OBJECT_TYPE_BUFFER, (uint64_t)resource.buffer,
+											resource.memRequirements.size, callSite);
+		}
+
+		/*	Lazy memory is only used if the device exposes it.	*/
+		if (resource.lazy &&
+			!this->device->findMemoryType(resource.memRequirements.memoryTypeBits,
+										  this->properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+			resource.lazy = false;
+
+		this->report.requestedBytes += resource.memRequirements.size;
+		this->report.nrResources++;
+		if (resource.lazy)
+			this->report.nrLazyResources++;
+	}
+
+	/*	Place the largest resources first.	*/
+	std::vector<uint32_t> order(this->resources.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+		return this->resources[a].memRequirements.size > this->resources[b].memRequirements.size;
+	});
+
+	for (const uint32_t index : order) {
+		Resource &resource = this->resources[index];
+		const VkMemoryPropertyFlags memoryProperties =
+			this->properties | (resource.lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0);
+
+		/*	Images and buffers are kept in separate blocks, and linear tiling images apart from optimal
+			tiling images, so linear and non-linear resources never share a bufferImageGranularity page.	*/
+		bool placed = false;
+		for (uint32_t b = 0; b < this->blocks.size() && !placed; b++) {
+			MemoryBlock &block = this->blocks[b];
+			if (block.isImage != resource.isImage || block.linear != resource.linear || block.lazy != resource.lazy ||
+				(resource.memRequirements.memoryTypeBits & (1u << block.memoryTypeIndex)) == 0)
+				continue;
+
+			VkDeviceSize offset;
+			if (this->findOffset(block, resource, offset)) {
+				resource.block = b;
+				resource.offset = offset;
+				block.resources.push_back(index);
+				placed = true;
+			}
+		}
+
+		/*	New block, sized after the largest resource since placed in decreasing size.	*/
+		if (!placed) {
+			const std::optional<uint32_t> typeIndex =
+				this->device->findMemoryType(resource.memRequirements.memoryTypeBits, memoryProperties);
+			if (!typeIndex)
+				throw cxxexcept::RuntimeException("Could not find valid memory index");
+
+			MemoryBlock block = {};
+			block.memory = VK_NULL_HANDLE;
+			block.size = resource.memRequirements.size;
+			block.memoryTypeIndex = typeIndex.value();
+			block.isImage = resource.isImage;
+			block.linear = resource.linear;
+			block.lazy = resource.lazy;
+			block.resources.push_back(index);
+
+			resource.block = this->blocks.size();
+			resource.offset = 0;
+			this->blocks.push_back(block);
+		}
+	}
+
+	/*	Allocate the blocks and bind the resources.	*/
+	for (MemoryBlock &block : this->blocks) {
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = block.size;
+		allocInfo.memoryTypeIndex = block.memoryTypeIndex;
+		VKS_VALIDATE(table.vkAllocateMemory(handle, &allocInfo, nullptr, &block.memory));
+		VKResourceTracker::recordAllocation((uint64_t)block.memory, allocInfo.allocationSize, allocInfo.memoryTypeIndex,
+											this->device->getPhysicalDevice(0)->getMemoryProperties(), callSite);
+
+		for (const uint32_t index : block.resources) {
+			const Resource &resource = this->resources[index];
+			if (resource.isImage)
+				VKS_VALIDATE(table.vkBindImageMemory(handle, resource.image, block.memory, resource.offset));
+			else
+				VKS_VALIDATE(table.vkBindBufferMemory(handle, resource.buffer, block.memory, resource.offset));
+		}
+
+		this->report.allocatedBytes += block.size;
+		this->report.nrBlocks++;
+	}
+	this->report.savedBytes = this->report.requestedBytes - this->report.allocatedBytes;
+}
+
+void VKTransientResourcePool::releaseObjects() {
+	VkDevice handle = this->device->getHandle();
+	const VKDeviceDispatch &table = this->device->getDispatch();
+
+	for (Resource &resource : this->resources) {
+		if (resource.isImage && resource.image != VK_NULL_HANDLE) {
+			VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_IMAGE, (uint64_t)resource.image);
+			table.vkDestroyImage(handle, resource.image, nullptr);
+		}
+		if (!resource.isImage && resource.buffer != VK_NULL_HANDLE) {
+			VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_BUFFER, (uint64_t)resource.buffer);
+			table.vkDestroyBuffer(handle, resource.buffer, nullptr);
+		}
+		resource.image = VK_NULL_HANDLE;
+		resource.buffer = VK_NULL_HANDLE;
+	}
+	for (MemoryBlock &block : this->blocks) {
+		if (block.memory != VK_NULL_HANDLE) {
+			VKResourceTracker::recordDestroy(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)block.memory);
+			table.vkFreeMemory(handle, block.memory, nullptr);
+		}
+	}
+	this->blocks.clear();
+}
+
+void VKTransientResourcePool::reset() {
+	this->releaseObjects();
+	this->resources.clear();
+	this->report = {};
+	this->compiled = false;
+}
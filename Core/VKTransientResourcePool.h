@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_TRANSIENT_RESOURCE_POOL_H_
+#define _FVK_VK_TRANSIENT_RESOURCE_POOL_H_ 1
+#include "VKDevice.h"
+#include "VKResourceTracker.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Pool for intermediate images and buffers that only live within a frame.
+ * Each resource declares the passes it is used in. Resources whose pass lifetimes
+ * do not overlap are aliased into the same memory block. Transient attachments use
+ * lazily allocated memory when the device exposes it.
+ *
+ * The content of an aliased resource is undefined at the first pass it is used in,
+ * images must be transitioned from VK_IMAGE_LAYOUT_UNDEFINED.
+ */
+class FVK_DECL_EXTERN VKTransientResourcePool {
+  public:
+	using ResourceHandle = uint32_t;
+
+	/**
+	 * @brief Memory usage of the compiled pool.
+	 */
+	struct MemoryReport {
+		/*	Total size if every resource had its own allocation.	*/
+		VkDeviceSize requestedBytes = 0;
+		/*	Total size of the memory blocks.	*/
+		VkDeviceSize allocatedBytes = 0;
+		VkDeviceSize savedBytes = 0;
+		uint32_t nrResources = 0;
+		uint32_t nrBlocks = 0;
+		uint32_t nrLazyResources = 0;
+	};
+
+	VKTransientResourcePool(const std::shared_ptr<VKDevice> &device,
+							VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	VKTransientResourcePool(const VKTransientResourcePool &) = delete;
+	VKTransientResourcePool(VKTransientResourcePool &&) = delete;
+	~VKTransientResourcePool();
+
+	/**
+	 * @brief Add an image.
+	 * Images with only attachment usages gets VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+	 * when transient is true.
+	 *
+	 * @param createInfo
+	 * @param transient
+	 * @return ResourceHandle
+	 */
+	ResourceHandle addImage(const VkImageCreateInfo &createInfo, bool transient = false);
+
+	/**
+	 * @brief Add a buffer.
+	 *
+	 * @param createInfo
+	 * @return ResourceHandle
+	 */
+	ResourceHandle addBuffer(const VkBufferCreateInfo &createInfo);
+
+	/**
+	 * @brief Mark the resource as used in the pass, extends its lifetime.
+	 *
+	 * @param resource
+	 * @param pass
+	 */
+	void use(ResourceHandle resource, uint32_t pass);
+
+	/**
+	 * @brief Create all resources, compute the aliasing and bind the memory.
+	 *
+	 * @param callSite recorded by VKResourceTracker for the resources and blocks, defaults to the caller.
+	 */
+	void compile(const VKCallSite &callSite = VKCallSite::current());
+
+	/**
+	 * @brief Destroy all resources and memory blocks.
+	 */
+	void reset();
+
+	VkImage getImage(ResourceHandle resource) const { return this->resources[resource].image; }
+	VkBuffer getBuffer(ResourceHandle resource) const { return this->resources[resource].buffer; }
+
+	const MemoryReport &getMemoryReport() const noexcept { return this->report; }
+
+  private:
+	struct Resource {
+		VkImageCreateInfo imageCreateInfo;
+		VkBufferCreateInfo bufferCreateInfo;
+		bool isImage;
+		/*	Buffers and linear tiling images, kept apart from optimal tiling images.	*/
+		bool linear;
+		bool lazy;
+		uint32_t firstPass;
+		uint32_t lastPass;
+		VkImage image;
+		VkBuffer buffer;
+		VkMemoryRequirements memRequirements;
+		uint32_t block;
+		VkDeviceSize offset;
+	};
+
+	struct MemoryBlock {
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		uint32_t memoryTypeIndex;
+		bool isImage;
+		bool linear;
+		bool lazy;
+		std::vector<uint32_t> resources;
+	};
+
+	bool findOffset(const MemoryBlock &block, const Resource &resource, VkDeviceSize &offset) const;
+	void compileResources(const VKCallSite &callSite);
+	/*	Destroy the created resources and memory blocks, keeping the resource descriptions.	*/
+	void releaseObjects();
+
+	std::shared_ptr<VKDevice> device;
+	VkMemoryPropertyFlags properties;
+	std::vector<Resource> resources;
+	std::vector<MemoryBlock> blocks;
+	MemoryReport report;
+	bool compiled;
+};
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021 Valdemar Lindberg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FVK_VK_UNIQUE_HANDLE_H_
+#define _FVK_VK_UNIQUE_HANDLE_H_ 1
+#include "VKDevice.h"
+
+/**
+ * @brief Move-only owner of a device object, optionally together with the memory bound to it.
+ * On destruction the object is handed to the deletion queue of the device, and destroyed once
+ * the submission it was last used in has retired; without any recorded use it is destroyed
+ * directly. Must not outlive the device.
+ *
+ * The object type is a template argument, since non-dispatchable handles are all uint64_t on
+ * 32-bit platforms.
+ *
+ * @tparam Type
+ * @tparam T Vulkan handle type.
+ */
+template <VkObjectType Type, typename T> class VKUniqueHandle {
+  public:
+	VKUniqueHandle() noexcept : device(nullptr), handle(VK_NULL_HANDLE), memory(VK_NULL_HANDLE), lastUse() {}
+	VKUniqueHandle(VKDevice &device, T handle, VkDeviceMemory memory = VK_NULL_HANDLE) noexcept
+		: device(&device), handle(handle), memory(memory), lastUse() {}
+	VKUniqueHandle(const VKUniqueHandle &) = delete;
+	VKUniqueHandle(VKUniqueHandle &&other) noexcept
+		: device(other.device), handle(other.handle), memory(other.memory), lastUse(other.lastUse) {
+		other.handle = VK_NULL_HANDLE;
+		other.memory = VK_NULL_HANDLE;
+	}
+	~VKUniqueHandle() { this->reset(); }
+
+	VKUniqueHandle &operator=(const VKUniqueHandle &) = delete;
+	VKUniqueHandle &operator=(VKUniqueHandle &&other) {
+		if (this != &other) {
+			this->reset();
+			this->device = other.device;
+			this->handle = other.handle;
+			this->memory = other.memory;
+			this->lastUse = other.lastUse;
+			other.handle = VK_NULL_HANDLE;
+			other.memory = VK_NULL_HANDLE;
+		}
+		return *this;
+	}
+
+	T get() const noexcept { return this->handle; }
+	VkDeviceMemory getMemory() const noexcept { return this->memory; }
+	explicit operator bool() const noexcept { return this->handle != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief Record a submission using the object, the latest value of each queue timeline is kept.
+	 *
+	 * @param timelinePoint returned by VKSyncPool::submitTimeline.
+	 */
+	void setLastUseTimeline(const VKSyncPool::TimelinePoint &timelinePoint) noexcept {
+		this->lastUse.addTimeline(timelinePoint);
+	}
+
+	/**
+	 * @brief Record a submission using the object, such as a frame's inFlight fence.
+	 *
+	 * @param fence
+	 */
+	void setLastUseFence(VkFence fence) noexcept { this->lastUse.fence = fence; }
+
+	const VKDeletionQueue::RetirePoint &getLastUse() const noexcept { return this->lastUse; }
+
+	/**
+	 * @brief Give up ownership without destroying the object.
+	 *
+	 * @return T
+	 */
+	T release() noexcept {
+		T released = this->handle;
+		this->handle = VK_NULL_HANDLE;
+		this->memory = VK_NULL_HANDLE;
+		this->lastUse = {};
+		return released;
+	}
+
+	/**
+	 * @brief Queue the object for destruction after its last use.
+	 */
+	void reset() {
+		if (this->handle != VK_NULL_HANDLE)
+			this->device->getDeletionQueue().destroy(Type, (uint64_t)this->handle, this->memory, this->lastUse);
+		this->handle = VK_NULL_HANDLE;
+		this->memory = VK_NULL_HANDLE;
+		this->lastUse = {};
+	}
+
+  private:
+	VKDevice *device;
+	T handle;
+	VkDeviceMemory memory;
+	VKDeletionQueue::RetirePoint lastUse;
+};
+
+using VKUniqueMemory = VKUniqueHandle<VK_OBJECT_TYPE_DEVICE_MEMORY, VkDeviceMemory>;
+using VKUniqueBuffer = VKUniqueHandle<VK_OBJECT_TYPE_BUFFER, VkBuffer>;
+using VKUniqueBufferView = VKUniqueHandle<VK_OBJECT_TYPE_BUFFER_VIEW, VkBufferView>;
+using VKUniqueImage = VKUniqueHandle<VK_OBJECT_TYPE_IMAGE, VkImage>;
+using VKUniqueImageView = VKUniqueHandle<VK_OBJECT_TYPE_IMAGE_VIEW, VkImageView>;
+using VKUniqueSampler = VKUniqueHandle<VK_OBJECT_TYPE_SAMPLER, VkSampler>;
+using VKUniqueShaderModule = VKUniqueHandle<VK_OBJECT_TYPE_SHADER_MODULE, VkShaderModule>;
+using VKUniquePipeline = VKUniqueHandle<VK_OBJECT_TYPE_PIPELINE, VkPipeline>;
+using VKUniquePipelineLayout = VKUniqueHandle<VK_OBJECT_TYPE_PIPELINE_LAYOUT, VkPipelineLayout>;
+using VKUniquePipelineCache = VKUniqueHandle<VK_OBJECT_TYPE_PIPELINE_CACHE, VkPipelineCache>;
+using VKUniqueDescriptorSetLayout = VKUniqueHandle<VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, VkDescriptorSetLayout>;
+using VKUniqueDescriptorPool = VKUniqueHandle<VK_OBJECT_TYPE_DESCRIPTOR_POOL, VkDescriptorPool>;
+using VKUniqueRenderPass = VKUniqueHandle<VK_OBJECT_TYPE_RENDER_PASS, VkRenderPass>;
+using VKUniqueFramebuffer = VKUniqueHandle<VK_OBJECT_TYPE_FRAMEBUFFER, VkFramebuffer>;
+using VKUniqueQueryPool = VKUniqueHandle<VK_OBJECT_TYPE_QUERY_POOL, VkQueryPool>;
+using VKUniqueCommandPool = VKUniqueHandle<VK_OBJECT_TYPE_COMMAND_POOL, VkCommandPool>;
+
+#endif
@@ -1,12 +1,16 @@
 #ifndef _FVK_VULKAN_PHYSICAL_DEVICE_H_
 #define _FVK_VULKAN_PHYSICAL_DEVICE_H_ 1
 #include "VKHelper.h"
+#include "VKStructureChain.h"
 #include "VulkanCore.h"
 #include <stdexcept>
 
 /**
- * @brief
+ * @brief Physical device and its cached properties.
  *
+ * All queries are const and immutable after construction, thus safe to call from any
+ * number of threads without locking. The Features2/Properties2 queries go directly to
+ * the driver, which has no external synchronization requirement on the physical device.
  */
 class FVK_DECL_EXTERN PhysicalDevice {
   public:
@@ -17,22 +21,20 @@ class FVK_DECL_EXTERN PhysicalDevice {
 
 	const VkPhysicalDeviceFeatures &getFeatures() const noexcept { return features; }
 
-	VkPhysicalDeviceProperties getProperties() noexcept { return properties; }
 	const VkPhysicalDeviceProperties &getProperties() const noexcept { return properties; }
 
-	VkPhysicalDeviceMemoryProperties getMemoryProperties() noexcept { return memProperties; }
 	const VkPhysicalDeviceMemoryProperties &getMemoryProperties() const noexcept { return memProperties; }
 
 	const VkPhysicalDeviceLimits &getDeviceLimits() const noexcept { return this->properties.limits; }
 
-	inline const VkPhysicalDeviceDriverProperties getDeviceDriverProperties() {
-		VkPhysicalDeviceDriverProperties devceProp;
+	inline VkPhysicalDeviceDriverProperties getDeviceDriverProperties() const noexcept {
+		VkPhysicalDeviceDriverProperties devceProp{};
 		getProperties(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES, devceProp);
 		return devceProp;
 	}
 
-	inline const VkPhysicalDeviceSubgroupProperties getDeviceSubGroupProperties() {
-		VkPhysicalDeviceSubgroupProperties devceProp;
+	inline VkPhysicalDeviceSubgroupProperties getDeviceSubGroupProperties() const noexcept {
+		VkPhysicalDeviceSubgroupProperties devceProp{};
 		getProperties(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES, devceProp);
 		return devceProp;
 	}
@@ -147,7 +149,7 @@ class FVK_DECL_EXTERN PhysicalDevice {
 	 * @param type
 	 * @param requestFeature
 	 */
-	template <typename T> void checkFeature(VkStructureType type, T &requestFeature) noexcept {
+	template <typename T> void checkFeature(VkStructureType type, T &requestFeature) const noexcept {
 
 		VkPhysicalDeviceFeatures2 feature = {};
 		feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
@@ -164,7 +166,7 @@ class FVK_DECL_EXTERN PhysicalDevice {
 	 * @param type
 	 * @param requestProperties
 	 */
-	template <typename T> void getProperties(VkStructureType type, T &requestProperties) noexcept {
+	template <typename T> void getProperties(VkStructureType type, T &requestProperties) const noexcept {
 		VkPhysicalDeviceProperties2 properties{};
 		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
 		properties.pNext = &requestProperties;
@@ -173,6 +175,29 @@ class FVK_DECL_EXTERN PhysicalDevice {
 		vkGetPhysicalDeviceProperties2(getHandle(), &properties);
 	}
 
+	/**
+	 * @brief Fill every structure in the chain with a single vkGetPhysicalDeviceFeatures2 call.
+	 * The same chain can be passed to VKDevice to enable what was queried.
+	 *
+	 * @tparam Ts
+	 * @param features
+	 */
+	template <typename... Ts>
+	void getFeatures(VKStructureChain<VkPhysicalDeviceFeatures2, Ts...> &features) const noexcept {
+		vkGetPhysicalDeviceFeatures2(this->getHandle(), &features.root());
+	}
+
+	/**
+	 * @brief Fill every structure in the chain with a single vkGetPhysicalDeviceProperties2 call.
+	 *
+	 * @tparam Ts
+	 * @param properties
+	 */
+	template <typename... Ts>
+	void getProperties(VKStructureChain<VkPhysicalDeviceProperties2, Ts...> &properties) const noexcept {
+		vkGetPhysicalDeviceProperties2(this->getHandle(), &properties.root());
+	}
+
 	const char *getDeviceName() const noexcept;
 
 	VulkanCore &getInstance() const noexcept { return this->vkCore; }
@@ -12,7 +12,7 @@
 #include <getopt.h>
 #include <stdexcept>
 
-VulkanCore::VulkanCore() : inst(nullptr) {
+VulkanCore::VulkanCore() : inst(nullptr), apiVersion(VK_API_VERSION_1_0), dispatch() {
 
 	/*  Check for supported extensions.*/
 	this->instanceExtensions = getSupportedExtensions();
@@ -27,11 +27,36 @@ VulkanCore::VulkanCore(const std::unordered_map<const char *, bool> &requested_i
 	Initialize(requested_instance_extensions, requested_instance_layers, pNext);
 }
 
-VulkanCore::VulkanCore(VkInstance instance) : VulkanCore() { this->inst = instance; }
+VulkanCore::VulkanCore(VkInstance instance, uint32_t apiVersion) : VulkanCore() {
+	this->inst = instance;
+	this->apiVersion = apiVersion;
+	this->dispatch.load(instance, vkGetInstanceProcAddr);
+}
 
 void VulkanCore::Initialize(const std::unordered_map<const char *, bool> &requested_instance_extensions,
 							const std::unordered_map<const char *, bool> &requested_instance_layers, void *pNext) {
 
+	/*  Get Latest Vulkan version. */
+	uint32_t version;
+	VKS_VALIDATE(vkEnumerateInstanceVersion(&version));
+
+	/*	Primary Vulkan instance Object. */ // TODO add support to override by user.
+	VkApplicationInfo ai = {};
+	ai.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	ai.pNext = VK_NULL_HANDLE;
+	ai.pApplicationName = "Vulkan Sample";
+	ai.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+	ai.pEngineName = "Vulkan Sample Engine";
+	ai.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+	ai.apiVersion = version;
+
+	initInstance(requested_instance_extensions, requested_instance_layers, ai, pNext);
+}
+
+void VulkanCore::initInstance(const std::unordered_map<const char *, bool> &requested_instance_extensions,
+							  const std::unordered_map<const char *, bool> &requested_instance_layers,
+							  const VkApplicationInfo &applicationInfo, const void *pNext) {
+
 	std::vector<const char *> usedInstanceExtensionNames = {
 		/*	*/
 		//		VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME,
@@ -63,20 +88,6 @@ void VulkanCore::Initialize(const std::unordered_map<const char *, bool> &reques
 		}
 	}
 
-	/*  Get Latest Vulkan version. */
-	uint32_t version;
-	VKS_VALIDATE(vkEnumerateInstanceVersion(&version));
-
-	/*	Primary Vulkan instance Object. */ // TODO add support to override by user.
-	VkApplicationInfo ai = {};
-	ai.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-	ai.pNext = VK_NULL_HANDLE;
-	ai.pApplicationName = "Vulkan Sample";
-	ai.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-	ai.pEngineName = "Vulkan Sample Engine";
-	ai.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	ai.apiVersion = version;
-
 	// VkDebugReportCallbackCreateInfoEXT callbackCreateInfoExt{};
 	// callbackCreateInfoExt.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT; // sType
 	// callbackCreateInfoExt.pNext = NULL;													   // pNext
@@ -100,7 +111,7 @@ void VulkanCore::Initialize(const std::unordered_map<const char *, bool> &reques
 	ici.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	ici.pNext = pNext;
 	ici.flags = 0;
-	ici.pApplicationInfo = &ai;
+	ici.pApplicationInfo = &applicationInfo;
 	/*	*/
 	ici.enabledLayerCount = useValidationLayers.size();
 	ici.ppEnabledLayerNames = useValidationLayers.data();
@@ -110,14 +121,16 @@ void VulkanCore::Initialize(const std::unordered_map<const char *, bool> &reques
 
 	/*	Create Vulkan instance.	*/
 	VKS_VALIDATE(vkCreateInstance(&ici, VK_NULL_HANDLE, &this->inst));
+	this->apiVersion = applicationInfo.apiVersion != 0 ? applicationInfo.apiVersion : VK_API_VERSION_1_0;
+	this->dispatch.load(this->inst, vkGetInstanceProcAddr);
 
 	/*	Get number of physical devices. */
 	uint32_t nrPhysicalDevices;
-	VKS_VALIDATE(vkEnumeratePhysicalDevices(this->inst, &nrPhysicalDevices, VK_NULL_HANDLE));
+	VKS_VALIDATE(this->dispatch.vkEnumeratePhysicalDevices(this->inst, &nrPhysicalDevices, VK_NULL_HANDLE));
 
 	/*  Get all physical devices.    */
 	physicalDevices.resize(nrPhysicalDevices);
-	VKS_VALIDATE(vkEnumeratePhysicalDevices(this->inst, &nrPhysicalDevices, &this->physicalDevices[0]));
+	VKS_VALIDATE(this->dispatch.vkEnumeratePhysicalDevices(this->inst, &nrPhysicalDevices, &this->physicalDevices[0]));
 
 	this->getDeviceGroupProperties();
 
@@ -137,7 +150,7 @@ std::shared_ptr<PhysicalDevice> VulkanCore::createPhysicalDevice(unsigned int in
 
 VulkanCore::~VulkanCore() {
 	if (this->inst != nullptr)
-		vkDestroyInstance(this->inst, nullptr);
+		this->dispatch.vkDestroyInstance(this->inst, nullptr);
 	this->inst = VK_NULL_HANDLE;
 }
 
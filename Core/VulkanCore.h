@@ -21,6 +21,8 @@
  */
 #ifndef _FVK_VULKAN_CORE_H_
 #define _FVK_VULKAN_CORE_H_ 1
+#include "VKDispatch.h"
+#include "VKStructureChain.h"
 #include "VKUtil.h"
 #include <algorithm>
 #include <cstring>
@@ -46,13 +48,46 @@ class FVK_DECL_EXTERN VulkanCore {
 				   {{"VK_LAYER_KHRONOS_validation", true}},
 			   void *pNext = nullptr);
 
+	/**
+	 * @brief Create instance with application information and a pNext chain, such as
+	 * VkValidationFeaturesEXT or the root of a VKStructureChain.
+	 *
+	 * @tparam T structure with sType and pNext.
+	 * @param vulkanVersion requested API version, 0 for the latest supported.
+	 * @param type sType of creationNext.
+	 * @param creationNext
+	 */
 	template <typename T>
 	VulkanCore(const std::vector<std::string> &requested_instance_extensions,
 			   const std::vector<std::string> &requested_layers, const std::string &Name, uint32_t version,
 			   const std::string &engine, unsigned int engineVersion, uint32_t vulkanVersion, VkStructureType type,
-			   T &creationNext) noexcept
-		: VulkanCore() {}
-	VulkanCore(VkInstance instance);
+			   T &creationNext)
+		: VulkanCore() {
+		std::unordered_map<const char *, bool> extensions;
+		for (const std::string &extension : requested_instance_extensions)
+			extensions[extension.c_str()] = true;
+		std::unordered_map<const char *, bool> layers;
+		for (const std::string &layer : requested_layers)
+			layers[layer.c_str()] = true;
+
+		VkApplicationInfo applicationInfo = {};
+		applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+		applicationInfo.pApplicationName = Name.c_str();
+		applicationInfo.applicationVersion = version;
+		applicationInfo.pEngineName = engine.c_str();
+		applicationInfo.engineVersion = engineVersion;
+		applicationInfo.apiVersion = vulkanVersion == 0 ? getVersion() : vulkanVersion;
+
+		creationNext.sType = type;
+		this->initInstance(extensions, layers, applicationInfo, &creationNext);
+	}
+	/**
+	 * @brief Wrap an existing instance.
+	 *
+	 * @param instance
+	 * @param apiVersion the apiVersion the instance was created with.
+	 */
+	VulkanCore(VkInstance instance, uint32_t apiVersion = VK_API_VERSION_1_0);
 	VulkanCore(const VulkanCore &other) = delete;
 	VulkanCore(VulkanCore &&other) = delete;
 	virtual ~VulkanCore();
@@ -94,6 +129,21 @@ class FVK_DECL_EXTERN VulkanCore {
 	 */
 	virtual VkInstance getHandle() const noexcept { return this->inst; }
 
+	/**
+	 * @brief Get the instance function table, including the enabled debug utils functions.
+	 *
+	 * @return const VKInstanceDispatch&
+	 */
+	const VKInstanceDispatch &getDispatch() const noexcept { return this->dispatch; }
+
+	/**
+	 * @brief Get the API version the instance was created with. Core functions of a newer version,
+	 * such as vkGetPhysicalDeviceProperties2, may only be used if this version allows it.
+	 *
+	 * @return uint32_t
+	 */
+	uint32_t getApiVersion() const noexcept { return this->apiVersion; }
+
 	/**
 	 * @brief Get the Device Group Properties object
 	 *
@@ -148,10 +198,16 @@ class FVK_DECL_EXTERN VulkanCore {
 	}
 
   protected:
+	void initInstance(const std::unordered_map<const char *, bool> &requested_instance_extensions,
+					  const std::unordered_map<const char *, bool> &requested_instance_layers,
+					  const VkApplicationInfo &applicationInfo, const void *pNext);
+
 	/*	*/
 	std::vector<VkExtensionProperties> instanceExtensions;
 	std::vector<VkLayerProperties> instanceLayers;
 	VkInstance inst;
+	uint32_t apiVersion;
+	VKInstanceDispatch dispatch;
 	VkDebugUtilsMessengerEXT debugMessenger;
 	VkDebugReportCallbackEXT debugReport;
 
@@ -0,0 +1,236 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2021 Valdemar Lindberg
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# Script mode, invoked by ADD_EMBEDDED_SHADERS.
+#	cmake -DSPIRV=<file.spv> -DREFLECTION=<file.json> -DSYMBOL=<name> -DOUTPUT=<file.h> -P EmbedSPIRV.cmake
+# The reflection is generated from the spirv-cross --reflect output and requires CMake 3.19.
+
+IF(NOT SPIRV OR NOT SYMBOL OR NOT OUTPUT)
+	MESSAGE(FATAL_ERROR "SPIRV, SYMBOL and OUTPUT must be defined")
+ENDIF()
+
+# SPIR-V words are stored little-endian.
+FILE(READ ${SPIRV} SPIRV_HEX HEX)
+STRING(LENGTH "${SPIRV_HEX}" SPIRV_HEX_LENGTH)
+MATH(EXPR SPIRV_REMAINDER "${SPIRV_HEX_LENGTH} % 8")
+IF(SPIRV_HEX_LENGTH EQUAL 0 OR NOT SPIRV_REMAINDER EQUAL 0)
+	MESSAGE(FATAL_ERROR "${SPIRV} is not a valid SPIR-V binary")
+ENDIF()
+STRING(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " SPIRV_WORDS "${SPIRV_HEX}")
+STRING(REGEX REPLACE "((0x........, ){8})" "\\1\n\t" SPIRV_WORDS "${SPIRV_WORDS}")
+MATH(EXPR SPIRV_NR_WORDS "${SPIRV_HEX_LENGTH} / 8")
+
+SET(SHADER_STAGE "VK_SHADER_STAGE_ALL")
+SET(WORKGROUP_SIZE "1, 1, 1")
+SET(BINDINGS "")
+SET(NR_BINDINGS 0)
+SET(PUSH_CONSTANTS "")
+SET(NR_PUSH_CONSTANTS 0)
+
+# Size in bytes of a reflected type, structs are resolved recursively.
+FUNCTION(REFLECT_TYPE_SIZE json type result)
+	SET(SCALAR_SIZE 4)
+	IF(type MATCHES "^(double|dvec|dmat|int64|uint64|i64vec|u64vec)")
+		SET(SCALAR_SIZE 8)
+	ELSEIF(type MATCHES "^(half|float16|int16|uint16|f16vec|i16vec|u16vec)")
+		SET(SCALAR_SIZE 2)
+	ENDIF()
+
+	IF(type MATCHES "^(float|double|int|uint|bool|half|float16_t|int16_t|uint16_t|int64_t|uint64_t)$")
+		SET(${result} ${SCALAR_SIZE} PARENT_SCOPE)
+	ELSEIF(type MATCHES "vec([234])$")
+		MATH(EXPR SIZE "${SCALAR_SIZE} * ${CMAKE_MATCH_1}")
+		SET(${result} ${SIZE} PARENT_SCOPE)
+	ELSEIF(type MATCHES "mat([234])(x([234]))?$")
+		# Only used without a matrix_stride decoration, column major std430 where a vec3 column is aligned as a vec4.
+		SET(NR_COLUMNS ${CMAKE_MATCH_1})
+		SET(NR_ROWS ${CMAKE_MATCH_1})
+		IF(CMAKE_MATCH_3)
+			SET(NR_ROWS ${CMAKE_MATCH_3})
+		ENDIF()
+		IF(NR_ROWS EQUAL 3)
+			SET(NR_ROWS 4)
+		ENDIF()
+		MATH(EXPR SIZE "${SCALAR_SIZE} * ${NR_ROWS} * ${NR_COLUMNS}")
+		SET(${result} ${SIZE} PARENT_SCOPE)
+	ELSE()
+		STRING(JSON NR_MEMBERS ERROR_VARIABLE JSON_ERROR LENGTH "${json}" types ${type} members)
+		SET(STRUCT_SIZE 0)
+		IF(NOT JSON_ERROR AND NR_MEMBERS GREATER 0)
+			MATH(EXPR LAST_MEMBER "${NR_MEMBERS} - 1")
+			FOREACH(I RANGE ${LAST_MEMBER})
+				REFLECT_MEMBER_END("${json}" "types;${type};members;${I}" MEMBER_END)
+				IF(MEMBER_END GREATER STRUCT_SIZE)
+					SET(STRUCT_SIZE ${MEMBER_END})
+				ENDIF()
+			ENDFOREACH()
+		ENDIF()
+		SET(${result} ${STRUCT_SIZE} PARENT_SCOPE)
+	ENDIF()
+ENDFUNCTION()
+
+# Offset of a block member, from the Offset decoration.
+FUNCTION(REFLECT_MEMBER_OFFSET json path result)
+	STRING(JSON MEMBER_OFFSET ERROR_VARIABLE JSON_ERROR GET "${json}" ${path} offset)
+	IF(JSON_ERROR)
+		SET(MEMBER_OFFSET 0)
+	ENDIF()
+	SET(${result} ${MEMBER_OFFSET} PARENT_SCOPE)
+ENDFUNCTION()
+
+# End offset of a block member, from the ArrayStride and MatrixStride decorations when present.
+FUNCTION(REFLECT_MEMBER_END json path result)
+	STRING(JSON MEMBER_TYPE GET "${json}" ${path} type)
+	REFLECT_MEMBER_OFFSET("${json}" "${path}" MEMBER_OFFSET)
+	STRING(JSON ARRAY_SIZE ERROR_VARIABLE JSON_ERROR GET "${json}" ${path} array 0)
+	STRING(JSON ARRAY_STRIDE ERROR_VARIABLE STRIDE_ERROR GET "${json}" ${path} array_stride)
+	STRING(JSON MATRIX_STRIDE ERROR_VARIABLE MATRIX_ERROR GET "${json}" ${path} matrix_stride)
+	IF(NOT JSON_ERROR AND NOT STRIDE_ERROR)
+		MATH(EXPR MEMBER_END "${MEMBER_OFFSET} + ${ARRAY_SIZE} * ${ARRAY_STRIDE}")
+	ELSEIF(NOT MATRIX_ERROR AND MEMBER_TYPE MATCHES "mat([234])(x([234]))?$")
+		# The stride is between columns, or between rows with the RowMajor decoration.
+		SET(NR_VECTORS ${CMAKE_MATCH_1})
+		STRING(JSON ROW_MAJOR ERROR_VARIABLE JSON_ERROR GET "${json}" ${path} row_major)
+		IF(NOT JSON_ERROR AND ROW_MAJOR AND CMAKE_MATCH_3)
+			SET(NR_VECTORS ${CMAKE_MATCH_3})
+		ENDIF()
+		MATH(EXPR MEMBER_END "${MEMBER_OFFSET} + ${NR_VECTORS} * ${MATRIX_STRIDE}")
+	ELSE()
+		REFLECT_TYPE_SIZE("${json}" ${MEMBER_TYPE} MEMBER_SIZE)
+		MATH(EXPR MEMBER_END "${MEMBER_OFFSET} + ${MEMBER_SIZE}")
+	ENDIF()
+	SET(${result} ${MEMBER_END} PARENT_SCOPE)
+ENDFUNCTION()
+
+IF(REFLECTION AND EXISTS ${REFLECTION})
+	IF(CMAKE_VERSION VERSION_LESS 3.19)
+		MESSAGE(WARNING "Shader reflection requires CMake 3.19")
+	ELSE()
+		FILE(READ ${REFLECTION} REFLECTION_JSON)
+
+		# Shader stage and workgroup size of the first entry point.
+		STRING(JSON ENTRY_MODE ERROR_VARIABLE JSON_ERROR GET "${REFLECTION_JSON}" entryPoints 0 mode)
+		IF(NOT JSON_ERROR)
+			SET(STAGE_comp "VK_SHADER_STAGE_COMPUTE_BIT")
+			SET(STAGE_vert "VK_SHADER_STAGE_VERTEX_BIT")
+			SET(STAGE_frag "VK_SHADER_STAGE_FRAGMENT_BIT")
+			SET(STAGE_geom "VK_SHADER_STAGE_GEOMETRY_BIT")
+			SET(STAGE_tesc "VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT")
+			SET(STAGE_tese "VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT")
+			IF(DEFINED STAGE_${ENTRY_MODE})
+				SET(SHADER_STAGE ${STAGE_${ENTRY_MODE}})
+			ENDIF()
+		ENDIF()
+		STRING(JSON WORKGROUP_X ERROR_VARIABLE JSON_ERROR GET "${REFLECTION_JSON}" entryPoints 0 workgroup_size 0)
+		IF(NOT JSON_ERROR)
+			STRING(JSON WORKGROUP_Y GET "${REFLECTION_JSON}" entryPoints 0 workgroup_size 1)
+			STRING(JSON WORKGROUP_Z GET "${REFLECTION_JSON}" entryPoints 0 workgroup_size 2)
+			SET(WORKGROUP_SIZE "${WORKGROUP_X}, ${WORKGROUP_Y}, ${WORKGROUP_Z}")
+		ENDIF()
+
+		# Descriptor bindings.
+		SET(RESOURCE_ubos "VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER")
+		SET(RESOURCE_ssbos "VK_DESCRIPTOR_TYPE_STORAGE_BUFFER")
+		SET(RESOURCE_textures "VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER")
+		SET(RESOURCE_separate_images "VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE")
+		SET(RESOURCE_separate_samplers "VK_DESCRIPTOR_TYPE_SAMPLER")
+		SET(RESOURCE_images "VK_DESCRIPTOR_TYPE_STORAGE_IMAGE")
+		SET(RESOURCE_subpass_inputs "VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT")
+		SET(RESOURCE_acceleration_structures "VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR")
+		FOREACH(RESOURCE ubos ssbos textures separate_images separate_samplers images subpass_inputs
+				acceleration_structures)
+			STRING(JSON NR_RESOURCES ERROR_VARIABLE JSON_ERROR LENGTH "${REFLECTION_JSON}" ${RESOURCE})
+			IF(JSON_ERROR OR NR_RESOURCES EQUAL 0)
+				CONTINUE()
+			ENDIF()
+			MATH(EXPR LAST_RESOURCE "${NR_RESOURCES} - 1")
+			FOREACH(I RANGE ${LAST_RESOURCE})
+				STRING(JSON RESOURCE_SET GET "${REFLECTION_JSON}" ${RESOURCE} ${I} set)
+				STRING(JSON RESOURCE_BINDING GET "${REFLECTION_JSON}" ${RESOURCE} ${I} binding)
+				STRING(JSON RESOURCE_TYPE GET "${REFLECTION_JSON}" ${RESOURCE} ${I} type)
+				STRING(JSON RESOURCE_COUNT ERROR_VARIABLE JSON_ERROR GET "${REFLECTION_JSON}" ${RESOURCE} ${I} array 0)
+				IF(JSON_ERROR OR RESOURCE_COUNT EQUAL 0)
+					SET(RESOURCE_COUNT 1)
+				ENDIF()
+
+				SET(DESCRIPTOR_TYPE ${RESOURCE_${RESOURCE}})
+				IF(RESOURCE_TYPE MATCHES "^(samplerBuffer|textureBuffer)$")
+					SET(DESCRIPTOR_TYPE "VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER")
+				ELSEIF(RESOURCE_TYPE STREQUAL "imageBuffer")
+					SET(DESCRIPTOR_TYPE "VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER")
+				ENDIF()
+
+				STRING(APPEND BINDINGS
+					"\t{${RESOURCE_SET}, {${RESOURCE_BINDING}, ${DESCRIPTOR_TYPE}, ${RESOURCE_COUNT}, ${SHADER_STAGE}, nullptr}},\n")
+				MATH(EXPR NR_BINDINGS "${NR_BINDINGS} + 1")
+			ENDFOREACH()
+		ENDFOREACH()
+
+		# Push constant range, from the first to the last member offset of the block.
+		STRING(JSON NR_PUSH ERROR_VARIABLE JSON_ERROR LENGTH "${REFLECTION_JSON}" push_constants)
+		IF(NOT JSON_ERROR AND NR_PUSH GREATER 0)
+			STRING(JSON PUSH_TYPE GET "${REFLECTION_JSON}" push_constants 0 type)
+			STRING(JSON NR_MEMBERS ERROR_VARIABLE JSON_ERROR LENGTH "${REFLECTION_JSON}" types ${PUSH_TYPE} members)
+			IF(NOT JSON_ERROR AND NR_MEMBERS GREATER 0)
+				SET(PUSH_BEGIN -1)
+				SET(PUSH_END 0)
+				MATH(EXPR LAST_MEMBER "${NR_MEMBERS} - 1")
+				FOREACH(I RANGE ${LAST_MEMBER})
+					REFLECT_MEMBER_OFFSET("${REFLECTION_JSON}" "types;${PUSH_TYPE};members;${I}" MEMBER_OFFSET)
+					REFLECT_MEMBER_END("${REFLECTION_JSON}" "types;${PUSH_TYPE};members;${I}" MEMBER_END)
+					IF(PUSH_BEGIN LESS 0 OR MEMBER_OFFSET LESS PUSH_BEGIN)
+						SET(PUSH_BEGIN ${MEMBER_OFFSET})
+					ENDIF()
+					IF(MEMBER_END GREATER PUSH_END)
+						SET(PUSH_END ${MEMBER_END})
+					ENDIF()
+				ENDFOREACH()
+				# Offset and size of a range must be multiples of 4.
+				MATH(EXPR PUSH_BEGIN "${PUSH_BEGIN} / 4 * 4")
+				MATH(EXPR PUSH_SIZE "(${PUSH_END} - ${PUSH_BEGIN} + 3) / 4 * 4")
+				SET(PUSH_CONSTANTS "\t{${SHADER_STAGE}, ${PUSH_BEGIN}, ${PUSH_SIZE}},\n")
+				SET(NR_PUSH_CONSTANTS 1)
+			ENDIF()
+		ENDIF()
+	ENDIF()
+ENDIF()
+
+FILE(WRITE ${OUTPUT} "/*	Generated by EmbedSPIRV.cmake, do not edit.	*/
+#ifndef _FVK_EMBEDDED_SHADER_${SYMBOL}_H_
+#define _FVK_EMBEDDED_SHADER_${SYMBOL}_H_ 1
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace ${SYMBOL} {
+	/*	Descriptor set layout binding and the set it belongs to.	*/
+	struct DescriptorBinding {
+		uint32_t set;
+		VkDescriptorSetLayoutBinding binding;
+	};
+
+	alignas(4) constexpr uint32_t spirv[${SPIRV_NR_WORDS}] = {
+	${SPIRV_WORDS}};
+	constexpr size_t spirvSize = sizeof(spirv);
+
+	constexpr VkShaderStageFlagBits stage = ${SHADER_STAGE};
+	constexpr std::array<uint32_t, 3> workGroupSize = {${WORKGROUP_SIZE}};
+
+	constexpr std::array<DescriptorBinding, ${NR_BINDINGS}> descriptorBindings = {{
+${BINDINGS}	}};
+
+	constexpr std::array<VkPushConstantRange, ${NR_PUSH_CONSTANTS}> pushConstantRanges = {{
+${PUSH_CONSTANTS}	}};
+} // namespace ${SYMBOL}
+
+#endif
+")
@@ -16,6 +16,9 @@ FIND_PROGRAM(SPIRVDIS spirv-dis)
 FIND_PROGRAM(SPIRVAS spirv-as)
 FIND_PROGRAM(SPIRVREMAP spirv-remap)
 FIND_PROGRAM(SPIRVCROSS spirv-cross)
+FIND_PROGRAM(SPIRVOPT spirv-opt)
+
+SET(SHADER_COMPILER_MODULE_DIR ${CMAKE_CURRENT_LIST_DIR})
 
 
 #TODO add working directory
@@ -60,3 +63,80 @@ FUNCTION(CONVERT_SPIRV_2_GLSL source output)
 		MESSAGE(WARNING "Could not find spirv-cross")
 	ENDIF()
 ENDFUNCTION()
+
+# Compile GLSL/HLSL shaders at build time and embed the SPIR-V as constexpr uint32_t arrays,
+# together with the reflected descriptor bindings, push constants and workgroup size.
+# A header <name>.h is generated in OUTPUT_DIR for each shader, where the name is the file name
+# with all non alpha-numeric characters replaced by '_'. HLSL files are named <name>.<stage>.hlsl.
+#
+# ADD_EMBEDDED_SHADERS(target SOURCES a.comp b.frag.hlsl [OUTPUT_DIR dir] [TARGET_ENV vulkan1.1])
+FUNCTION(ADD_EMBEDDED_SHADERS target)
+	CMAKE_PARSE_ARGUMENTS(EMBED "" "OUTPUT_DIR;TARGET_ENV" "SOURCES" ${ARGN})
+	IF(NOT EMBED_OUTPUT_DIR)
+		SET(EMBED_OUTPUT_DIR "${CMAKE_CURRENT_BINARY_DIR}/shaders")
+	ENDIF()
+	IF(NOT EMBED_TARGET_ENV)
+		SET(EMBED_TARGET_ENV "vulkan1.1")
+	ENDIF()
+
+	IF(NOT GLSLC AND NOT GLSLLANGVALIDATOR)
+		MESSAGE(FATAL_ERROR "Could not find glslc or glslangValidator")
+	ENDIF()
+	IF(NOT SPIRVCROSS)
+		MESSAGE(WARNING "Could not find spirv-cross, shader reflection will not be generated")
+	ENDIF()
+
+	FOREACH(SHADER ${EMBED_SOURCES})
+		GET_FILENAME_COMPONENT(SHADER_PATH ${SHADER} ABSOLUTE)
+		GET_FILENAME_COMPONENT(FILE_NAME ${SHADER} NAME)
+		STRING(MAKE_C_IDENTIFIER ${FILE_NAME} SYMBOL_NAME)
+
+		SET(SPIRV_FILEPATH "${EMBED_OUTPUT_DIR}/${FILE_NAME}.spv")
+		SET(REFLECTION_FILEPATH "${EMBED_OUTPUT_DIR}/${FILE_NAME}.json")
+		SET(HEADER_FILEPATH "${EMBED_OUTPUT_DIR}/${SYMBOL_NAME}.h")
+
+		# HLSL requires the stage to be explicit.
+		SET(LANGUAGE_FLAGS "")
+		IF(FILE_NAME MATCHES "\\.([a-z]+)\\.hlsl$")
+			IF(GLSLC)
+				SET(LANGUAGE_FLAGS -x hlsl -fshader-stage=${CMAKE_MATCH_1})
+			ELSE()
+				SET(LANGUAGE_FLAGS -D -S ${CMAKE_MATCH_1} -e main)
+			ENDIF()
+		ENDIF()
+
+		# glslc runs the spirv-opt performance passes with -O.
+		IF(GLSLC)
+			SET(COMPILE_COMMAND ${GLSLC} ${LANGUAGE_FLAGS} -O --target-env=${EMBED_TARGET_ENV} ${SHADER_PATH} -o ${SPIRV_FILEPATH})
+			SET(OPTIMIZE_COMMAND "")
+		ELSE()
+			SET(COMPILE_COMMAND ${GLSLLANGVALIDATOR} ${LANGUAGE_FLAGS} -V --target-env ${EMBED_TARGET_ENV} ${SHADER_PATH} -o ${SPIRV_FILEPATH})
+			IF(SPIRVOPT)
+				SET(OPTIMIZE_COMMAND COMMAND ${SPIRVOPT} -O ${SPIRV_FILEPATH} -o ${SPIRV_FILEPATH})
+			ENDIF()
+		ENDIF()
+
+		IF(SPIRVCROSS)
+			SET(REFLECT_COMMAND COMMAND ${SPIRVCROSS} ${SPIRV_FILEPATH} --reflect --output ${REFLECTION_FILEPATH})
+		ELSE()
+			SET(REFLECT_COMMAND "")
+			SET(REFLECTION_FILEPATH "")
+		ENDIF()
+
+		ADD_CUSTOM_COMMAND(
+			OUTPUT ${HEADER_FILEPATH}
+			COMMAND ${CMAKE_COMMAND} -E make_directory "${EMBED_OUTPUT_DIR}"
+			COMMAND ${COMPILE_COMMAND}
+			${OPTIMIZE_COMMAND}
+			${REFLECT_COMMAND}
+			COMMAND ${CMAKE_COMMAND} -DSPIRV=${SPIRV_FILEPATH} -DREFLECTION=${REFLECTION_FILEPATH}
+				-DSYMBOL=${SYMBOL_NAME} -DOUTPUT=${HEADER_FILEPATH} -P ${SHADER_COMPILER_MODULE_DIR}/EmbedSPIRV.cmake
+			VERBATIM
+			DEPENDS ${SHADER_PATH} ${SHADER_COMPILER_MODULE_DIR}/EmbedSPIRV.cmake)
+		LIST(APPEND EMBEDDED_HEADER_FILES ${HEADER_FILEPATH})
+	ENDFOREACH(SHADER)
+
+	ADD_CUSTOM_TARGET(${target}_embedded_shaders DEPENDS ${EMBEDDED_HEADER_FILES})
+	ADD_DEPENDENCIES(${target} ${target}_embedded_shaders)
+	TARGET_INCLUDE_DIRECTORIES(${target} PRIVATE ${EMBED_OUTPUT_DIR})
+ENDFUNCTION()
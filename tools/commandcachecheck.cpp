@@ -0,0 +1,73 @@
+#include <VKCommandBufferCache.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+/*	Usage:
+ *	fvkcommandcachecheck	Check that pass keys are computed from the description, not from its address
+ *							or its padding bytes.
+ */
+
+struct PassDescription {
+	uint32_t width;
+	uint32_t height;
+	VkFormat format;
+	uint32_t nrSamples;
+};
+
+/*	Padding after the first member, hash rejects the type as a whole.	*/
+struct PaddedDescription {
+	uint8_t nrSamples;
+	VkDeviceSize size;
+	float scale;
+};
+static_assert(!std::has_unique_object_representations<PaddedDescription>::value, "Expected padding");
+
+static uint64_t hashPadded(const PaddedDescription &description) {
+	return VKCommandBufferCache::hashMembers(description.nrSamples, description.size, description.scale);
+}
+
+int main() {
+	unsigned int nrFailures = 0;
+	const auto check = [&nrFailures](bool result, const char *name) {
+		std::cout << "\t" << name << ": " << (result ? "ok" : "failed") << std::endl;
+		nrFailures += result ? 0 : 1;
+	};
+
+	/*	Equal descriptions at different addresses.	*/
+	const PassDescription description = {1920, 1080, VK_FORMAT_R8G8B8A8_UNORM, 1};
+	const std::unique_ptr<PassDescription> copy = std::make_unique<PassDescription>(description);
+	PassDescription other = description;
+	other.width = 1280;
+
+	check(VKCommandBufferCache::hash(description) == VKCommandBufferCache::hash(*copy), "hash of equal values");
+	check(VKCommandBufferCache::hashBytes(&description, sizeof(description)) ==
+			  VKCommandBufferCache::hashBytes(copy.get(), sizeof(*copy)),
+		  "hashBytes of equal values");
+	check(VKCommandBufferCache::hash(description) ==
+			  VKCommandBufferCache::hashBytes(&description, sizeof(description)),
+		  "hash matches hashBytes");
+	check(VKCommandBufferCache::hash(description) != VKCommandBufferCache::hash(other), "hash of different values");
+	check(VKCommandBufferCache::hash(copy->height, VKCommandBufferCache::hash(copy->width)) ==
+			  VKCommandBufferCache::hash(description.height, VKCommandBufferCache::hash(description.width)),
+		  "chained hash of equal fields");
+
+	/*	Equal padded descriptions with different padding bytes.	*/
+	PaddedDescription padded[2];
+	std::memset(&padded[0], 0x00, sizeof(PaddedDescription));
+	std::memset(&padded[1], 0xff, sizeof(PaddedDescription));
+	for (PaddedDescription &value : padded) {
+		value.nrSamples = 4;
+		value.size = 65536;
+		value.scale = 1.0f;
+	}
+	check(hashPadded(padded[0]) == hashPadded(padded[1]), "hashMembers of equal padded values");
+	padded[1].scale = -0.0f;
+	padded[0].scale = 0.0f;
+	check(hashPadded(padded[0]) == hashPadded(padded[1]), "hashMembers of +0 and -0");
+	padded[1].size = 4096;
+	check(hashPadded(padded[0]) != hashPadded(padded[1]), "hashMembers of different padded values");
+
+	return nrFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,185 @@
+#include <VKComputeKernel.h>
+#include <chrono>
+#include <cstdlib>
+#include <fill_comp.h>
+#include <iostream>
+#include <map>
+
+/*	Usage:
+ *	fvkcomputebench [elements] [dispatches]	Fill a storage buffer with the embedded fill.comp shader and verify
+ *											the result, then measure dispatches/s of single workgroup dispatches,
+ *											direct and indirect, with and without VKComputeRecorder state tracking.
+ */
+
+struct FillPushConstants {
+	uint32_t count;
+	uint32_t value;
+};
+
+int main(int argc, const char **argv) {
+	const uint32_t nrElements = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024 * 1024;
+	const uint32_t nrDispatches = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+	const uint32_t fillValue = 7;
+	using clock = std::chrono::steady_clock;
+
+	try {
+		std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																		std::unordered_map<const char *, bool>{});
+		std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+		std::shared_ptr<VKDevice> device = std::make_shared<VKDevice>(
+			physicalDevices[0], std::unordered_map<const char *, bool>{}, VK_QUEUE_COMPUTE_BIT);
+		VkDevice handle = device->getHandle();
+
+		/*	Descriptor set layouts and the pipeline layout from the reflected shader interface.	*/
+		std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> setBindings;
+		std::map<VkDescriptorType, uint32_t> descriptorCounts;
+		for (const fill_comp::DescriptorBinding &binding : fill_comp::descriptorBindings) {
+			setBindings[binding.set].push_back(binding.binding);
+			descriptorCounts[binding.binding.descriptorType] += binding.binding.descriptorCount;
+		}
+		std::vector<VkDescriptorSetLayout> setLayouts(setBindings.empty() ? 0 : setBindings.rbegin()->first + 1);
+		for (uint32_t set = 0; set < setLayouts.size(); set++)
+			VKHelper::createDescriptorSetLayout(handle, setLayouts[set], setBindings[set]);
+
+		const std::vector<VkPushConstantRange> pushConstantRanges(fill_comp::pushConstantRanges.begin(),
+																  fill_comp::pushConstantRanges.end());
+		VkPipelineLayout layout;
+		VKHelper::createPipelineLayout(handle, layout, setLayouts, pushConstantRanges);
+
+		VkShaderModule shaderModule = VKHelper::createShaderModule(handle, fill_comp::spirv);
+		VkPipelineShaderStageCreateInfo stageInfo = {};
+		stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stageInfo.stage = fill_comp::stage;
+		stageInfo.module = shaderModule;
+		stageInfo.pName = "main";
+		VkPipeline pipeline = VKHelper::createComputePipeline(handle, layout, stageInfo);
+		const uint32_t pushConstantOffset = fill_comp::pushConstantRanges[0].offset;
+		VKComputeKernel kernel(device, pipeline, layout, fill_comp::pushConstantRanges[0].size);
+
+		/*	Host visible storage buffer, read back after the dispatch.	*/
+		const VkDeviceSize size = nrElements * sizeof(uint32_t);
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		VKHelper::createBuffer(handle, size, physicalDevices[0]->getMemoryProperties(),
+							   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+							   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer,
+							   memory);
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto &count : descriptorCounts)
+			poolSizes.push_back({count.first, count.second});
+		VkDescriptorPool descPool = VKHelper::createDescPool(handle, poolSizes, setLayouts.size());
+
+		std::vector<VkDescriptorSet> sets(setLayouts.size());
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descPool;
+		allocInfo.descriptorSetCount = setLayouts.size();
+		allocInfo.pSetLayouts = setLayouts.data();
+		VKS_VALIDATE(vkAllocateDescriptorSets(handle, &allocInfo, sets.data()));
+
+		VkDescriptorBufferInfo bufferInfo = {buffer, 0, size};
+		VkWriteDescriptorSet write = {};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = sets[fill_comp::descriptorBindings[0].set];
+		write.dstBinding = fill_comp::descriptorBindings[0].binding.binding;
+		write.descriptorCount = 1;
+		write.descriptorType = fill_comp::descriptorBindings[0].binding.descriptorType;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(handle, 1, &write, 0, nullptr);
+
+		std::cout << "Device: " << physicalDevices[0]->getDeviceName() << ", push constants " << pushConstantOffset
+				  << ".." << pushConstantOffset + kernel.getPushConstantSize() << std::endl;
+
+		VkCommandPool commandPool = device->createCommandPool(device->getDefaultComputeQueueIndex());
+		VkCommandBuffer cmd = device->beginSingleTimeCommand(commandPool);
+		VKComputeRecorder recorder(cmd, &device->getDispatch());
+		recorder.bind(kernel);
+		recorder.bindDescriptorSets(kernel, 0, sets.data(), sets.size());
+		const FillPushConstants pushConstants = {nrElements, fillValue};
+		recorder.pushConstants(kernel, &pushConstants, sizeof(pushConstants), pushConstantOffset);
+		recorder.dispatch((nrElements + fill_comp::workGroupSize[0] - 1) / fill_comp::workGroupSize[0]);
+		device->endSingleTimeCommands(device->getDefaultCompute(), cmd, commandPool);
+
+		void *data;
+		VKS_VALIDATE(vkMapMemory(handle, memory, 0, size, 0, &data));
+		uint32_t nrMismatches = 0;
+		for (uint32_t i = 0; i < nrElements; i++)
+			nrMismatches += static_cast<const uint32_t *>(data)[i] != fillValue + i;
+		vkUnmapMemory(handle, memory);
+		std::cout << "\tfill: " << (nrMismatches == 0 ? "ok" : "failed") << ", " << nrMismatches << " mismatches"
+				  << std::endl;
+
+		/*	Indirect arguments of a single workgroup, as written by a previous dispatch.	*/
+		VkBuffer indirectBuffer;
+		VkDeviceMemory indirectMemory;
+		VKHelper::createBuffer(handle, sizeof(VkDispatchIndirectCommand), physicalDevices[0]->getMemoryProperties(),
+							   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+							   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+							   indirectBuffer, indirectMemory);
+		VKS_VALIDATE(vkMapMemory(handle, indirectMemory, 0, sizeof(VkDispatchIndirectCommand), 0, &data));
+		*static_cast<VkDispatchIndirectCommand *>(data) = {1, 1, 1};
+		vkUnmapMemory(handle, indirectMemory);
+
+		/*	Every dispatch binds the same state, the recorder skips all but the first bind.	*/
+		const FillPushConstants groupPushConstants = {fill_comp::workGroupSize[0], fillValue};
+		const VKDeviceDispatch &table = device->getDispatch();
+		VKComputeBatch batch(device);
+		for (const bool indirect : {false, true}) {
+			for (const bool tracking : {true, false}) {
+				VKComputeRecorder &batchRecorder = batch.begin();
+				VkCommandBuffer batchCmd = batchRecorder.getCommandBuffer();
+
+				const clock::time_point start = clock::now();
+				for (uint32_t i = 0; i < nrDispatches; i++) {
+					if (tracking) {
+						batchRecorder.bind(kernel);
+						batchRecorder.bindDescriptorSets(kernel, 0, sets.data(), sets.size());
+						batchRecorder.pushConstants(kernel, &groupPushConstants, sizeof(groupPushConstants),
+													pushConstantOffset);
+						if (indirect)
+							batchRecorder.dispatchIndirect(indirectBuffer);
+						else
+							batchRecorder.dispatch(1);
+					} else {
+						table.vkCmdBindPipeline(batchCmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+						table.vkCmdBindDescriptorSets(batchCmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, sets.size(),
+													  sets.data(), 0, nullptr);
+						table.vkCmdPushConstants(batchCmd, layout, fill_comp::stage, pushConstantOffset,
+												 sizeof(groupPushConstants), &groupPushConstants);
+						if (indirect)
+							table.vkCmdDispatchIndirect(batchCmd, indirectBuffer, 0);
+						else
+							table.vkCmdDispatch(batchCmd, 1, 1, 1);
+					}
+				}
+				const double recordSeconds = std::chrono::duration<double>(clock::now() - start).count();
+				batch.submit();
+				batch.wait();
+				const double totalSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+				std::cout << "	" << (indirect ? "indirect" : "direct") << ", tracking "
+						  << (tracking ? "on" : "off") << ": " << nrDispatches / recordSeconds / 1e6
+						  << " M dispatches/s recorded, " << nrDispatches / totalSeconds / 1e6
+						  << " M dispatches/s recorded and executed" << std::endl;
+			}
+		}
+
+		VKHelper::destroyBuffer(handle, indirectBuffer, indirectMemory);
+		vkDestroyCommandPool(handle, commandPool, nullptr);
+		VKHelper::destroyDescPool(handle, descPool);
+		VKHelper::destroyBuffer(handle, buffer, memory);
+		VKHelper::destroyPipeline(handle, pipeline);
+		VKHelper::destroyShaderModule(handle, shaderModule);
+		VKHelper::destroyPipelineLayout(handle, layout);
+		for (VkDescriptorSetLayout setLayout : setLayouts)
+			VKHelper::destroyDescriptorSetLayout(handle, setLayout);
+
+		if (nrMismatches > 0)
+			return EXIT_FAILURE;
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include <VKConvert.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+/*	Usage:
+ *	fvkconvertbench [megabytes]		Report the throughput of each host conversion per instruction set.
+ */
+
+static double measure(const std::function<void()> &convert, size_t nrBytes) {
+	using clock = std::chrono::steady_clock;
+	const unsigned int nrIterations = 20;
+
+	/*	Warm up, touching the destination pages.	*/
+	convert();
+	const clock::time_point start = clock::now();
+	for (unsigned int i = 0; i < nrIterations; i++)
+		convert();
+	const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+	return (static_cast<double>(nrBytes) * nrIterations) / seconds / 1e9;
+}
+
+int main(int argc, const char **argv) {
+	const size_t size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64) * 1024 * 1024;
+
+	std::vector<float> floats(size / sizeof(float), 1.5f);
+	std::vector<uint16_t> halfs(floats.size());
+	std::vector<uint8_t> rgb((size / 3) * 3, 0x7F);
+	std::vector<uint8_t> rgba(rgb.size() / 3 * 4);
+	std::vector<uint16_t> indices16(size / sizeof(uint16_t), 7);
+	std::vector<uint32_t> indices32(indices16.size());
+	const uint32_t width = 4096, height = static_cast<uint32_t>(size / (width * 4));
+	std::vector<uint8_t> pitched(static_cast<size_t>(width * 4 + 256) * height);
+	std::vector<uint8_t> packed(static_cast<size_t>(width * 4) * height);
+
+	const VKConvert::ISA bestISA = VKConvert::getBestSupportedISA();
+	std::cout << "Source GB/s per conversion, " << size / (1024 * 1024) << " MB" << std::endl;
+
+	for (const VKConvert::ISA isa : {VKConvert::ISA::Scalar, bestISA}) {
+		VKConvert::setISA(isa);
+		std::cout << VKConvert::getISAName(VKConvert::getISA()) << std::endl;
+		std::cout << "\tfloat32 -> float16: "
+				  << measure([&] { VKConvert::float32ToFloat16(floats.data(), halfs.data(), floats.size()); },
+							 floats.size() * sizeof(float))
+				  << std::endl;
+		std::cout << "\tRGB -> RGBA:        "
+				  << measure([&] { VKConvert::rgbToRGBA(rgb.data(), rgba.data(), rgb.size() / 3); }, rgb.size())
+				  << std::endl;
+		std::cout << "\tuint16 -> uint32:   "
+				  << measure([&] { VKConvert::widenIndices(indices16.data(), indices32.data(), indices16.size()); },
+							 indices16.size() * sizeof(uint16_t))
+				  << std::endl;
+		std::cout << "\trow repack:         "
+				  << measure(
+						 [&] {
+							 VKConvert::repackRows(pitched.data(), width * 4 + 256, packed.data(), width * 4,
+												   width * 4, height);
+						 },
+						 packed.size())
+				  << std::endl;
+		if (isa == bestISA)
+			break;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include <VKDevice.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+/*	Usage:
+ *	fvkdispatchbench [calls]	Compare loader exports with the device dispatch table, in calls/s.
+ */
+
+int main(int argc, const char **argv) {
+	const unsigned int nrCalls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	using clock = std::chrono::steady_clock;
+
+	try {
+		std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																		std::unordered_map<const char *, bool>{});
+		std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+		std::shared_ptr<VKDevice> device = std::make_shared<VKDevice>(
+			physicalDevices[0], std::unordered_map<const char *, bool>{}, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+
+		VkQueue queue = device->getDefaultGraphicQueue();
+		VkCommandPool commandPool = device->createCommandPool(device->getDefaultGraphicQueueIndex());
+		VkCommandBuffer cmd = device->allocateCommandBuffer(commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+		std::cout << "Device: " << physicalDevices[0]->getDeviceName() << std::endl;
+
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		const VKDeviceDispatch *tables[] = {&VKDeviceDispatch::getGlobal(), &device->getDispatch()};
+		const char *names[] = {"loader", "dispatch table"};
+
+		for (unsigned int t = 0; t < 2; t++) {
+			const VKDeviceDispatch &table = *tables[t];
+
+			/*	Recording, vkCmdPipelineBarrier.	*/
+			VKS_VALIDATE(table.vkResetCommandPool(device->getHandle(), commandPool, 0));
+			VKS_VALIDATE(table.vkBeginCommandBuffer(cmd, &beginInfo));
+			clock::time_point start = clock::now();
+			for (unsigned int i = 0; i < nrCalls; i++)
+				table.vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+										   &memoryBarrier, 0, nullptr, 0, nullptr);
+			const double recordSeconds = std::chrono::duration<double>(clock::now() - start).count();
+			VKS_VALIDATE(table.vkEndCommandBuffer(cmd));
+
+			/*	Submission, empty vkQueueSubmit.	*/
+			const unsigned int nrSubmits = std::max(1u, nrCalls / 100);
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			start = clock::now();
+			for (unsigned int i = 0; i < nrSubmits; i++)
+				VKS_VALIDATE(table.vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+			const double submitSeconds = std::chrono::duration<double>(clock::now() - start).count();
+			VKS_VALIDATE(table.vkQueueWaitIdle(queue));
+
+			std::cout << "\t" << names[t] << ": " << nrCalls / recordSeconds / 1e6 << " M barriers/s, "
+					  << nrSubmits / submitSeconds / 1e3 << " K submits/s" << std::endl;
+		}
+
+		vkDestroyCommandPool(device->getHandle(), commandPool, nullptr);
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#include <VKExternalMemory.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/*	Usage:
+ *	fvkexternalbench [frame MB] [iterations]	Hand a shared buffer back and forth between a producer and
+ *												a consumer process with a shared timeline semaphore, and
+ *												compare the handoff latency with a host memcpy of the frame.
+ *												The consumer first verifies a pattern written by the producer.
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+/*	A dedicated import requires the same buffer create parameters as the exported buffer.	*/
+static const VkBufferUsageFlags sharedUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+static const uint32_t pattern = 0xA5C3F00Du;
+
+static std::shared_ptr<VKDevice> createDevice() {
+	std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																	std::unordered_map<const char *, bool>{});
+	std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+	return std::make_shared<VKDevice>(physicalDevices[0],
+									  std::unordered_map<const char *, bool>{
+										  {VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, true},
+										  {VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME, true}},
+									  VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+}
+
+static void signalValue(VkDevice device, VkSemaphore semaphore, uint64_t value) {
+	VkSemaphoreSignalInfo signalInfo = {};
+	signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+	signalInfo.semaphore = semaphore;
+	signalInfo.value = value;
+	VKS_VALIDATE(vkSignalSemaphore(device, &signalInfo));
+}
+
+static void waitValue(VkDevice device, VkSemaphore semaphore, uint64_t value) {
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+	VKS_VALIDATE(vkWaitSemaphores(device, &waitInfo, UINT64_MAX));
+}
+
+/*	Buffer barrier handing the buffer to or from the external queue family.	*/
+static VkBufferMemoryBarrier externalBarrier(VkBuffer buffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily,
+											 VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+	barrier.buffer = buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+	return barrier;
+}
+
+/*	Copy the shared buffer back to the host and check the producer pattern.	*/
+static bool verifyPattern(VKDevice &device, VkBuffer buffer, VkDeviceSize size) {
+	VkBuffer readback;
+	VkDeviceMemory readbackMemory;
+	VKHelper::createBuffer(device.getHandle(), size, device.getPhysicalDevice(0)->getMemoryProperties(),
+						   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+						   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readback,
+						   readbackMemory);
+
+	VkCommandPool commandPool = device.createCommandPool(device.getDefaultGraphicQueueIndex());
+	VkCommandBuffer cmd = device.beginSingleTimeCommand(commandPool);
+	const VkBufferMemoryBarrier acquire = externalBarrier(
+		buffer, VK_QUEUE_FAMILY_EXTERNAL, device.getDefaultGraphicQueueIndex(), 0, VK_ACCESS_TRANSFER_READ_BIT);
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1,
+						 &acquire, 0, nullptr);
+	const VkBufferCopy region = {0, 0, size};
+	vkCmdCopyBuffer(cmd, buffer, readback, 1, &region);
+	VkMemoryBarrier hostBarrier = {};
+	hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0,
+						 nullptr, 0, nullptr);
+	device.endSingleTimeCommands(device.getDefaultGraphicQueue(), cmd, commandPool);
+	vkDestroyCommandPool(device.getHandle(), commandPool, nullptr);
+
+	void *data;
+	VKS_VALIDATE(vkMapMemory(device.getHandle(), readbackMemory, 0, size, 0, &data));
+	const uint32_t *words = static_cast<const uint32_t *>(data);
+	bool valid = true;
+	for (VkDeviceSize i = 0; i < size / sizeof(uint32_t) && valid; i++)
+		valid = words[i] == pattern;
+	vkUnmapMemory(device.getHandle(), readbackMemory);
+	VKHelper::destroyBuffer(device.getHandle(), readback, readbackMemory);
+	return valid;
+}
+
+/*	Consumer: import the buffer and semaphore, verify the pattern, acknowledge each handoff.	*/
+static int consumer(int socket, VkDeviceSize size, unsigned int nrIterations) {
+	std::shared_ptr<VKDevice> device = createDevice();
+
+	const int memoryFd = VKExternalMemory::receiveFileDescriptor(socket);
+	const int semaphoreFd = VKExternalMemory::receiveFileDescriptor(socket);
+
+	VkBuffer buffer;
+	VkDeviceMemory memory;
+	VKExternalMemory::importBuffer(*device, memoryFd, size, sharedUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+								   VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT, buffer, memory);
+	VkSemaphore semaphore = VKExternalMemory::importSemaphore(*device, semaphoreFd, true);
+
+	/*	The first handoff carries the pattern, acknowledged even if invalid so the producer does not block.	*/
+	waitValue(device->getHandle(), semaphore, 1);
+	const bool valid = verifyPattern(*device, buffer, size);
+	std::cout << "	shared memory pattern: " << (valid ? "ok" : "failed") << std::endl;
+	signalValue(device->getHandle(), semaphore, 2);
+
+	for (unsigned int i = 1; i <= nrIterations; i++) {
+		waitValue(device->getHandle(), semaphore, 2 * i + 1);
+		signalValue(device->getHandle(), semaphore, 2 * i + 2);
+	}
+
+	vkDestroySemaphore(device->getHandle(), semaphore, nullptr);
+	VKHelper::destroyBuffer(device->getHandle(), buffer, memory);
+	return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*	Producer: export the buffer and semaphore, time the round trips.	*/
+static int producer(int socket, VkDeviceSize size, unsigned int nrIterations) {
+	std::shared_ptr<VKDevice> device = createDevice();
+
+	VkBuffer buffer;
+	VkDeviceMemory memory;
+	VKExternalMemory::createExportableBuffer(*device, size, sharedUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+											 VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT, buffer, memory);
+	VkSemaphore semaphore = VKExternalMemory::createExportableSemaphore(*device, true);
+
+	const int memoryFd = VKExternalMemory::exportMemory(*device, memory, VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT);
+	const int semaphoreFd = VKExternalMemory::exportSemaphore(*device, semaphore);
+	VKExternalMemory::sendFileDescriptor(socket, memoryFd);
+	VKExternalMemory::sendFileDescriptor(socket, semaphoreFd);
+	close(memoryFd);
+	close(semaphoreFd);
+
+	/*	Write the pattern and release the buffer to the consumer, not part of the timing.	*/
+	VkCommandPool commandPool = device->createCommandPool(device->getDefaultGraphicQueueIndex());
+	VkCommandBuffer cmd = device->beginSingleTimeCommand(commandPool);
+	vkCmdFillBuffer(cmd, buffer, 0, VK_WHOLE_SIZE, pattern);
+	const VkBufferMemoryBarrier release = externalBarrier(buffer, device->getDefaultGraphicQueueIndex(),
+														  VK_QUEUE_FAMILY_EXTERNAL, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+						 &release, 0, nullptr);
+	device->endSingleTimeCommands(device->getDefaultGraphicQueue(), cmd, commandPool);
+	vkDestroyCommandPool(device->getHandle(), commandPool, nullptr);
+	signalValue(device->getHandle(), semaphore, 1);
+	waitValue(device->getHandle(), semaphore, 2);
+
+	const clock_type::time_point start = clock_type::now();
+	for (unsigned int i = 1; i <= nrIterations; i++) {
+		signalValue(device->getHandle(), semaphore, 2 * i + 1);
+		waitValue(device->getHandle(), semaphore, 2 * i + 2);
+	}
+	const double handoff =
+		std::chrono::duration<double, std::micro>(clock_type::now() - start).count() / (2.0 * nrIterations);
+
+	/*	Host path, a copy of the frame.	*/
+	std::vector<uint8_t> src(size, 1), dst(size);
+	std::memcpy(dst.data(), src.data(), size);
+	const clock_type::time_point copyStart = clock_type::now();
+	for (unsigned int i = 0; i < nrIterations; i++)
+		std::memcpy(dst.data(), src.data(), size);
+	const double copy =
+		std::chrono::duration<double, std::micro>(clock_type::now() - copyStart).count() / nrIterations;
+
+	std::cout << "Frame size: " << size / (1024 * 1024) << " MB" << std::endl;
+	std::cout << "\tshared memory handoff: " << handoff << " us" << std::endl;
+	std::cout << "\thost memcpy:           " << copy << " us" << std::endl;
+
+	vkDestroySemaphore(device->getHandle(), semaphore, nullptr);
+	VKHelper::destroyBuffer(device->getHandle(), buffer, memory);
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, const char **argv) {
+	const VkDeviceSize size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32) * 1024 * 1024;
+	const unsigned int nrIterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+		std::cerr << "Failed to create socket pair" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const pid_t pid = fork();
+	try {
+		if (pid == 0) {
+			close(sockets[0]);
+			return consumer(sockets[1], size, nrIterations);
+		}
+		close(sockets[1]);
+		const int result = producer(sockets[0], size, nrIterations);
+		int status = 0;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+			return EXIT_FAILURE;
+		return result;
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
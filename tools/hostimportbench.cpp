@@ -0,0 +1,72 @@
+#include <VKHostImport.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/*	Usage:
+ *	fvkhostimportbench [MB] [iterations]	Compare uploading from imported host memory with the staging path.
+ */
+
+int main(int argc, const char **argv) {
+	const VkDeviceSize size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64) * 1024 * 1024;
+	const unsigned int nrIterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+	using clock = std::chrono::steady_clock;
+
+	try {
+		std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																		std::unordered_map<const char *, bool>{});
+		std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+		const bool hostImport = physicalDevices[0]->isExtensionSupported(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+		std::shared_ptr<VKDevice> device = std::make_shared<VKDevice>(
+			physicalDevices[0],
+			std::unordered_map<const char *, bool>{{VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME, hostImport}},
+			VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+
+		VkCommandPool commandPool = device->createCommandPool(device->getDefaultTransferQueueIndex());
+
+		const VkDeviceSize alignment = std::max<VkDeviceSize>(VKHostImport::getImportAlignment(*device), 64);
+		const VkDeviceSize alignedSize = (size + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+		void *data = _aligned_malloc(alignedSize, alignment);
+#else
+		void *data = std::aligned_alloc(alignment, alignedSize);
+#endif
+		std::memset(data, 0x5A, alignedSize);
+
+		VkBuffer dst;
+		VkDeviceMemory dstMemory;
+		VKHelper::createBuffer(device->getHandle(), alignedSize, physicalDevices[0]->getMemoryProperties(),
+							   VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, dst, dstMemory);
+
+		std::cout << "Device: " << physicalDevices[0]->getDeviceName() << ", " << alignedSize / (1024 * 1024)
+				  << " MB" << std::endl;
+
+		/*	Aligned memory takes the import path if supported, an unaligned pointer forces the staging path.	*/
+		for (const bool aligned : {true, false}) {
+			const uint8_t *src = static_cast<const uint8_t *>(data) + (aligned ? 0 : 1);
+			const VkDeviceSize uploadSize = aligned ? alignedSize : alignedSize - 1;
+			bool imported = false;
+			const clock::time_point start = clock::now();
+			for (unsigned int i = 0; i < nrIterations; i++)
+				imported = VKHostImport::uploadBuffer(*device, device->getDefaultTransfer(), commandPool, src,
+													  uploadSize, dst);
+			const double seconds = std::chrono::duration<double>(clock::now() - start).count() / nrIterations;
+			std::cout << "\t" << (imported ? "host import" : "staging") << ": " << uploadSize / seconds / 1e9
+					  << " GB/s" << std::endl;
+		}
+
+#ifdef _WIN32
+		_aligned_free(data);
+#else
+		std::free(data);
+#endif
+		VKHelper::destroyBuffer(device->getHandle(), dst, dstMemory);
+		vkDestroyCommandPool(device->getHandle(), commandPool, nullptr);
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
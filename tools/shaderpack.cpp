@@ -0,0 +1,115 @@
+#include <VKShaderArchive.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/*	Usage:
+ *	fvkshaderpack -o <archive> <file.spv>...		Pack the SPIR-V files, named by their file name.
+ *	fvkshaderpack --bench <archive> [file.spv]...	Time loading and reading all modules from the archive,
+ *													and optionally from the loose files.
+ */
+
+static std::vector<char> readFile(const std::string &path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		throw cxxexcept::RuntimeException("Failed to open file '{}'", path);
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(data.data(), data.size());
+	return data;
+}
+
+/*	Read every byte of the code, so both paths fault in the whole module.	*/
+static uint64_t checksumBytes(const void *data, size_t size) {
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	uint64_t checksum = 0;
+	for (size_t i = 0; i < size; i++)
+		checksum += bytes[i];
+	return checksum;
+}
+
+static std::string baseName(const std::string &path) {
+	const size_t pos = path.find_last_of("/\\");
+	return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+static int pack(const std::string &output, const std::vector<std::string> &files) {
+	std::vector<std::pair<std::string, std::vector<uint32_t>>> modules;
+	modules.reserve(files.size());
+
+	for (const std::string &path : files) {
+		const std::vector<char> data = readFile(path);
+		if (data.size() % sizeof(uint32_t) != 0) {
+			std::cerr << path << " is not a valid SPIR-V binary" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::vector<uint32_t> code(data.size() / sizeof(uint32_t));
+		std::memcpy(code.data(), data.data(), data.size());
+		modules.emplace_back(baseName(path), std::move(code));
+	}
+
+	VKShaderArchive::pack(output, modules);
+	std::cout << "Packed " << modules.size() << " modules into " << output << std::endl;
+	return EXIT_SUCCESS;
+}
+
+static int bench(const std::string &archivePath, const std::vector<std::string> &files) {
+	const unsigned int nrIterations = 100;
+	using clock = std::chrono::steady_clock;
+
+	/*	Map the archive and look up every module.	*/
+	uint64_t checksum = 0;
+	size_t nrModules = 0;
+	const clock::time_point archiveStart = clock::now();
+	for (unsigned int i = 0; i < nrIterations; i++) {
+		VKShaderArchive archive(archivePath);
+		nrModules = archive.getNrModules();
+		for (uint32_t m = 0; m < archive.getNrModules(); m++) {
+			const VKShaderArchive::Module module = archive.getModule(archive.getModuleName(m));
+			checksum += checksumBytes(module.code, module.codeSize);
+		}
+	}
+	const double archiveMs = std::chrono::duration<double, std::milli>(clock::now() - archiveStart).count();
+	std::cout << "archive: " << nrModules << " modules, " << archiveMs / nrIterations << " ms per load" << std::endl;
+
+	/*	Read each loose file into a heap buffer, as with VKHelper::createShaderModule.	*/
+	if (!files.empty()) {
+		const clock::time_point filesStart = clock::now();
+		for (unsigned int i = 0; i < nrIterations; i++) {
+			for (const std::string &path : files) {
+				const std::vector<char> data = readFile(path);
+				checksum += checksumBytes(data.data(), data.size());
+			}
+		}
+		const double filesMs = std::chrono::duration<double, std::milli>(clock::now() - filesStart).count();
+		std::cout << "files:   " << files.size() << " modules, " << filesMs / nrIterations << " ms per load"
+				  << std::endl;
+	}
+
+	return checksum != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, const char **argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " -o <archive> <file.spv>..." << std::endl;
+		std::cerr << "       " << argv[0] << " --bench <archive> [file.spv]..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string mode = argv[1];
+	const std::vector<std::string> files(argv + 3, argv + argc);
+
+	try {
+		if (mode == "-o")
+			return pack(argv[2], files);
+		else if (mode == "--bench")
+			return bench(argv[2], files);
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cerr << "Unknown option: " << mode << std::endl;
+	return EXIT_FAILURE;
+}
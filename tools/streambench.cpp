@@ -0,0 +1,55 @@
+#include <VKStreamLoader.h>
+#include <VulkanCore.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+/*	Usage:
+ *	fvkstreambench <file> [chunk MB] [chunks in flight]	Stream the file into a device local buffer
+ *															and report the throughput of each stage.
+ */
+
+int main(int argc, const char **argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <file> [chunk MB] [chunks in flight]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	const VkDeviceSize chunkSize = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8) * 1024 * 1024;
+	const unsigned int nrChunks = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+	try {
+		std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																		std::unordered_map<const char *, bool>{});
+		std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+		std::shared_ptr<VKDevice> device = std::make_shared<VKDevice>(
+			physicalDevices[0], std::unordered_map<const char *, bool>{}, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+
+		VKStreamLoader loader(device, chunkSize, nrChunks);
+
+		/*	Size the destination after the file.	*/
+		std::ifstream file(argv[1], std::ios::binary | std::ios::ate);
+		if (!file)
+			throw cxxexcept::RuntimeException("Failed to open file '{}'", argv[1]);
+		const VkDeviceSize size = static_cast<VkDeviceSize>(file.tellg());
+
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		VKHelper::createBuffer(device->getHandle(), size, physicalDevices[0]->getMemoryProperties(),
+							   VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+
+		/*	Consumed on the graphics queue, owned by the transfer queue during the load.	*/
+		const VKStreamLoader::Statistics statistics =
+			loader.loadBuffer(argv[1], buffer, 0, 0, 0, device->getDefaultGraphicQueueIndex());
+		std::cout << "Backend: " << (loader.isIOUringEnabled() ? "io_uring" : "pread thread pool") << std::endl;
+		std::cout << "Loaded " << statistics.nrBytes << " bytes in " << statistics.nrChunks << " chunks" << std::endl;
+		std::cout << "\tread:  " << statistics.getReadThroughput() << " GB/s" << std::endl;
+		std::cout << "\tcopy:  " << statistics.getCopyThroughput() << " GB/s" << std::endl;
+		std::cout << "\ttotal: " << statistics.getTotalThroughput() << " GB/s" << std::endl;
+
+		VKHelper::destroyBuffer(device->getHandle(), buffer, memory);
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#include <VKDevice.h>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+/*	Usage:
+ *	fvksubmitalloccheck [submits]	Check that VKDevice::submitCommands does not allocate, by counting the calls
+ *									of the replaced global operator new. Allocations made by the driver are
+ *									measured with plain vkQueueSubmit calls and subtracted.
+ */
+
+static std::atomic<uint64_t> nrAllocations{0};
+
+void *operator new(std::size_t size) {
+	nrAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+int main(int argc, const char **argv) {
+	const unsigned int nrSubmits = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+	try {
+		std::shared_ptr<VulkanCore> core = std::make_shared<VulkanCore>(std::unordered_map<const char *, bool>{},
+																		std::unordered_map<const char *, bool>{});
+		std::vector<std::shared_ptr<PhysicalDevice>> physicalDevices = core->createPhysicalDevices();
+		std::shared_ptr<VKDevice> device = std::make_shared<VKDevice>(physicalDevices[0],
+																	  std::unordered_map<const char *, bool>{},
+																	  VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+		VkDevice handle = device->getHandle();
+		VkQueue queue = device->getDefaultGraphicQueue();
+
+		/*	Empty command buffer, re-submitted while still pending.	*/
+		VkCommandPool commandPool = device->createCommandPool(device->getDefaultGraphicQueueIndex());
+		VkCommandBuffer cmd = device->allocateCommandBuffer(commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+		VKS_VALIDATE(vkBeginCommandBuffer(cmd, &beginInfo));
+		VKS_VALIDATE(vkEndCommandBuffer(cmd));
+		const std::array<VkCommandBuffer, 1> cmds = {cmd};
+
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence;
+		VKS_VALIDATE(vkCreateFence(handle, &fenceInfo, nullptr, &fence));
+
+		/*	Allocations during the submits, waiting for the last one outside of the count.	*/
+		const auto countAllocations = [&](const auto &submit) {
+			submit();
+			VKS_VALIDATE(vkQueueWaitIdle(queue));
+			const uint64_t start = nrAllocations.load();
+			for (unsigned int i = 0; i < nrSubmits; i++)
+				submit();
+			const uint64_t count = nrAllocations.load() - start;
+			VKS_VALIDATE(vkQueueWaitIdle(queue));
+			return count;
+		};
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &cmd;
+		const uint64_t driverAllocations = countAllocations(
+			[&] { VKS_VALIDATE(device->getDispatch().vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE)); });
+
+		unsigned int nrFailures = 0;
+		const auto check = [&](const char *name, uint64_t count) {
+			const bool allocationFree = count <= driverAllocations;
+			std::cout << "\t" << name << ": " << count << " allocations, " << driverAllocations << " by the driver, "
+					  << (allocationFree ? "ok" : "failed") << std::endl;
+			nrFailures += allocationFree ? 0 : 1;
+		};
+
+		check("single command buffer", countAllocations([&] { device->submitCommands(queue, cmd); }));
+		check("initializer list", countAllocations([&] { device->submitCommands(queue, {cmd}, {}, {}); }));
+		check("std::array", countAllocations([&] { device->submitCommands(queue, cmds); }));
+		check("device group", countAllocations([&] { device->submitDeviceGroupCommands(queue, cmds, 0); }));
+
+		/*	With a fence, waited and reset each time.	*/
+		const uint64_t driverFenceAllocations = countAllocations([&] {
+			VKS_VALIDATE(device->getDispatch().vkQueueSubmit(queue, 1, &submitInfo, fence));
+			VKS_VALIDATE(vkWaitForFences(handle, 1, &fence, VK_TRUE, UINT64_MAX));
+			VKS_VALIDATE(vkResetFences(handle, 1, &fence));
+		});
+		const uint64_t fenceAllocations = countAllocations([&] {
+			device->submitCommands(queue, {cmd}, {}, {}, fence);
+			VKS_VALIDATE(vkWaitForFences(handle, 1, &fence, VK_TRUE, UINT64_MAX));
+			VKS_VALIDATE(vkResetFences(handle, 1, &fence));
+		});
+		const bool fenceAllocationFree = fenceAllocations <= driverFenceAllocations;
+		std::cout << "\tfence: " << fenceAllocations << " allocations, " << driverFenceAllocations
+				  << " by the driver, " << (fenceAllocationFree ? "ok" : "failed") << std::endl;
+		nrFailures += fenceAllocationFree ? 0 : 1;
+
+		vkDestroyFence(handle, fence, nullptr);
+		vkDestroyCommandPool(handle, commandPool, nullptr);
+
+		if (nrFailures > 0)
+			return EXIT_FAILURE;
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}